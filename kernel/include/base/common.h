@@ -78,7 +78,9 @@ namespace rayshape
         OPENCL = 2 // opencl(intel_gpu/nvidia,arm,amd,qualcomm) gpu memory
     };
 
-    enum class Precision { AUTO = -1, NORMAL = 0, HIGH = 1, LOW = 2 };
+    // HIGH: 强制fp32; NORMAL: 推理引擎默认; LOW: 设备支持的最快低精度;
+    // BF16/FP16: 指定低精度,设备不支持时回退fp32
+    enum class Precision { AUTO = -1, NORMAL = 0, HIGH = 1, LOW = 2, BF16 = 3, FP16 = 4 };
 
     typedef struct CustomRuntime {
         DeviceType device_type_ = DeviceType::NONE;
@@ -86,8 +88,19 @@ namespace rayshape
         ModelType model_type_ = ModelType::NONE;
         int num_thread_ = -1;
         bool use_gpu_ = false;
+        Precision precision_ = Precision::AUTO; // AUTO由推理引擎按设备选择
     } CustomRuntime;
 
+    // 进程级推理配置,需在创建第一个推理实例前通过SetGlobalRuntime设置
+    typedef struct GlobalRuntime {
+        int intra_op_num_thread_ = -1; // 共享intra-op线程池大小,-1由推理引擎决定
+        int inter_op_num_thread_ = -1; // 共享inter-op线程池大小,-1由推理引擎决定
+        // 所有模型共享进程级线程池;开启后CustomRuntime和SessionConfig中的线程数不再生效.
+        // 默认关闭,每个session按自身配置独占线程池
+        bool share_thread_pool_ = false;
+        int async_num_thread_ = -1; // 无原生异步接口的推理引擎执行ForwardAsync的线程数,-1为CPU核数
+    } GlobalRuntime;
+
     using DimsVector = std::vector<int>;
     using IntVector = std::vector<int>;
     using SizeVector = std::vector<size_t>;
@@ -105,6 +118,14 @@ namespace rayshape
         EDGE_TYPE_NONE = 0x0001 << 2
     } EdgeType;
 
+    // 流水线边写满时的处理策略
+    typedef enum QueueOverflowPolicy {
+        QUEUE_OVERFLOW_BLOCK = 0,       // 阻塞生产者,背压到上游
+        QUEUE_OVERFLOW_DROP_OLDEST = 1, // 丢掉最旧的未消费数据包
+        QUEUE_OVERFLOW_DROP_NEWEST = 2, // 丢掉新写入的数据
+        QUEUE_OVERFLOW_KEEP_LATEST = 3  // 只保留最新的一个未消费数据包,实时流用
+    } QueueOverflowPolicy;
+
     typedef enum NodeColorType {
         NODE_COLOR_WHITE = 0, // not visited
         NODE_COLOR_GRAY = 1,  // visiting
@@ -53,6 +53,10 @@ namespace rayshape
         // thread pool error
         RS_THREAD_POLL_ERROR = 0x6200,
 
+        // inference errcode
+        RS_INFERENCE_TIMEOUT = 0x7000,
+        RS_INFERENCE_BUSY = 0x7001,
+
         RS_UNKNOWN
     };
 
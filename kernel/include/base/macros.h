@@ -79,4 +79,9 @@ template <typename T> constexpr const T &RS_MAX(const T &x, const T &y) noexcept
 #define unlikely
 #endif
 
+// cache line大小,多线程频繁写的变量按此对齐/填充,避免伪共享
+#ifndef RS_CACHE_LINE_SIZE
+#define RS_CACHE_LINE_SIZE 64
+#endif
+
 #endif //_MACROS_H_//#endif // MACROS_H
@@ -47,6 +47,40 @@ namespace rayshape
             ErrorCode SetParallelType(const ParallelType &paralle_type);
 
             ParallelType GetParallelType();
+
+            /**
+             * @brief 设置流水线边的队列深度,优先于图的设置,默认16
+             * @note Init前设置;Init后边上已有数据时,到下次Init才生效
+             */
+            ErrorCode SetQueueMaxSize(int queue_max_size);
+
+            /**
+             * @brief 设置流水线边写满时的策略,优先于图的设置,默认阻塞生产者
+             * @note 同SetQueueMaxSize
+             */
+            ErrorCode SetOverflowPolicy(QueueOverflowPolicy policy);
+
+            /**
+             * @brief 图构建时调用,边没有单独设置的项使用图的设置
+             */
+            ErrorCode SetDefaultQueue(int queue_max_size, QueueOverflowPolicy policy);
+
+            /**
+             * @brief 按溢出策略丢弃的数据包个数
+             */
+            int64_t GetDroppedSize();
+
+            /**
+             * @brief 多副本生产者的写入预留和按序提交,由流水线引擎调用
+             */
+            void BeginReplicaWrite();
+
+            void EndReplicaWrite(int slot, bool publish);
+
+            /**
+             * @brief 设置运行槽位数量,由执行引擎在Init时设置
+             */
+            ErrorCode SetRunSlotSize(int slot_size);
             /**
              * @brief 边的构建
              */
@@ -78,6 +112,15 @@ namespace rayshape
 
             bool RequestTerminate();
 
+            /**
+             * @brief 流水线引擎注册的数据/空位通知,见AbstractEdge::SetEventListener
+             */
+            void SetEventListener(const EdgeEventFunc &on_data, const EdgeEventFunc &on_space);
+
+            bool IsReadable(const Node *node);
+
+            bool IsWritable();
+
             /**
             @brief 给边添加生产消费节点
             */
@@ -91,15 +134,7 @@ namespace rayshape
             template <typename T>
             ErrorCode SetData(T *t) {
                 // 设置类型信息;
-                return abstract_edge_->SetData<T>(t, true);
-            }
-
-            /**
-             * @brief 唤醒写数据
-             */
-            template <typename T>
-            bool NotifyWrite(T *t) {
-                return abstract_edge_->NotifyWrite<T>(t);
+                return abstract_edge_->SetAny<T>(t, true);
             }
 
             /**
@@ -108,13 +143,17 @@ namespace rayshape
              */
             template <typename T>
             T *GetData(const Node *node) {
-                return abstract_edge_->GetData<T>(node);
+                return abstract_edge_->GetAny<T>(node);
             }
 
         private:
             std::string name_; // edge name
             AbstractEdge *abstract_edge_ = nullptr;
             /* brige connect mode */
+
+            int queue_max_size_ = 0; // 0表示跟随图的设置
+            QueueOverflowPolicy overflow_policy_ = QUEUE_OVERFLOW_BLOCK;
+            bool is_policy_set_ = false; // 是否单独设置过溢出策略
         };
 
     } // namespace dag
@@ -6,12 +6,17 @@
 // #include "dag/node.h"
 #include "data_package.h"
 
+#include <atomic>
+
 namespace rayshape
 {
     namespace dag
     {
 
         class Node;
+
+        // 边上数据变化的通知,流水线引擎据此把就绪的节点提交为任务
+        using EdgeEventFunc = std::function<void()>;
         /**
          * @brief 抽象边类,在此基础上扩展fixededge and pipeline_edge
          * @details 边管理生产消费者节点的关系
@@ -29,6 +34,21 @@ namespace rayshape
             // 对边设置最大队列大小,对流水线包有用,// 这个队列接口似乎只对piep
             virtual ErrorCode SetQueueMaxSize(int queue_max_size) = 0;
 
+            // 设置写满时的策略,只对流水线边有用
+            virtual ErrorCode SetOverflowPolicy(QueueOverflowPolicy /*policy*/) {
+                return RS_SUCCESS;
+            }
+
+            // 按溢出策略丢弃的数据包个数
+            virtual int64_t GetDroppedSize() {
+                return 0;
+            }
+
+            // 设置运行槽位数量,多轮同时运行时每个槽位一份数据包,只对固定边有用
+            virtual ErrorCode SetRunSlotSize(int /*slot_size*/) {
+                return RS_SUCCESS;
+            }
+
             /**
              * 边的数据包管理
              */
@@ -74,6 +94,34 @@ namespace rayshape
 
             virtual EdgeUpdateFlag Update(const Node *node) = 0;
 
+            /**
+             * @brief 事件驱动调度用的非阻塞查询和通知,只对流水线边有用
+             * @details on_data在有新数据包可读时调用,on_space在队列腾出空位时调用,
+             * 都在边的锁外调用;只能在没有数据流动时设置
+             */
+            virtual void SetEventListener(const EdgeEventFunc & /*on_data*/,
+                                          const EdgeEventFunc & /*on_space*/) {}
+
+            // 该消费者是否有未消费的数据包,Update不会阻塞
+            virtual bool IsReadable(const Node * /*node*/) {
+                return true;
+            }
+
+            // 队列是否有空位,写入不会阻塞
+            virtual bool IsWritable() {
+                return true;
+            }
+
+            /**
+             * @brief 多副本生产者(见Node::SetReplicaSize)的写入,只对流水线边有用
+             * @details 副本运行期间的写入按副本暂存;派发前BeginReplicaWrite预留一个位置,
+             * 运行结束后引擎按派发顺序调用EndReplicaWrite把暂存的数据包写入队列,下游按输入顺序收到
+             */
+            virtual void BeginReplicaWrite() {}
+
+            // publish为false时丢掉暂存的数据包
+            virtual void EndReplicaWrite(int /*slot*/, bool /*publish*/) {}
+
             // 管理生产和消费者
             std::vector<Node *> GetProducers();
             ErrorCode IncreaseProducers(std::vector<Node *> &producers);
@@ -84,12 +132,16 @@ namespace rayshape
             virtual bool RequestTerminate() = 0;
 
         protected:
-            void IncreaseIndex();
+            /**
+             * @brief 边的数据包索引加1
+             * @return 本次写入的索引,多个slot并发写同一条边时各自拿到唯一的索引
+             */
+            int64_t IncreaseIndex();
 
             bool CheckNode(const Node *node);
 
         protected:
-            int64_t index_ = -1; // 边中的数据包索引
+            std::atomic<int64_t> index_{-1}; // 边中的数据包索引
 
             ParallelType parallel_type_;
             /**
@@ -109,6 +109,9 @@ namespace rayshape
 #endif
             virtual ErrorCode TakeDataPackage(DataPackage *package);
 
+            // 槽位复用前清空数据、写入状态和消费计数
+            void Reset();
+
             void IncreaseConsumersSize();
             void IncreaseConsumersCount();
 
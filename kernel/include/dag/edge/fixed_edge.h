@@ -16,6 +16,8 @@ namespace rayshape
             // no use API in fixed edge.
             virtual ErrorCode SetQueueMaxSize(int queue_max_size) override;
 
+            virtual ErrorCode SetRunSlotSize(int slot_size) override;
+
             /*边的构建*/
             virtual ErrorCode Construct() override;
 
@@ -49,9 +51,14 @@ namespace rayshape
 
             virtual int64_t GetIndex();
 
+        private:
+            // 当前线程运行槽位的数据包
+            DataPackage *&SlotDataPackage();
+
         private:
             // int index;
-            DataPackage *data_packet_; // 数据包内可以是任何数据blob, cv::Mat, std::vector etc.
+            // 每个运行槽位一个数据包,数据包内可以是任何数据blob, cv::Mat, std::vector etc.
+            std::vector<DataPackage *> data_packets_;
         };
 
     } // namespace dag
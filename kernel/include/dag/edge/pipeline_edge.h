@@ -7,7 +7,17 @@ namespace rayshape
 {
     namespace dag
     {
-
+        /**
+         * @brief 流水线边,单生产者多消费者的环形队列
+         * @details 槽位在Construct时预分配并循环复用,生产者写write_seq_,每个消费者推进自己的读序号,
+         * 所有消费者都用完的槽位才会被复用.读写都只做原子操作,环满或环空时才加锁休眠.
+         * 没有消费者的边为图输出边,由GetGraphOutput*读取,写满时扩容而不背压.
+         * 溢出策略不是阻塞时生产者从不等待:DROP_NEWEST丢掉写不下的新数据;DROP_OLDEST/KEEP_LATEST
+         * 由生产者推进落后消费者的读序号,丢掉最旧的未消费数据包,此时消费者的Update也在锁内完成;
+         * 消费者持有一个数据包太久导致环满时,新数据替换最新的未消费数据包.
+         * 多副本节点(Node::SetReplicaSize)作为消费者时每个副本各自持有一个数据包;作为生产者时写入按副本暂存,
+         * 引擎按派发顺序调用EndReplicaWrite换入环中,下游收到的数据包index_仍按输入顺序递增.
+         */
         class PipelineEdge: public AbstractEdge {
         public:
             PipelineEdge(ParallelType paralle_type);
@@ -15,6 +25,10 @@ namespace rayshape
             virtual ~PipelineEdge();
 
             virtual ErrorCode SetQueueMaxSize(int queue_max_size) override;
+
+            virtual ErrorCode SetOverflowPolicy(QueueOverflowPolicy policy) override;
+
+            virtual int64_t GetDroppedSize() override;
             /*边的构建*/
             virtual ErrorCode Construct() override;
 
@@ -22,7 +36,7 @@ namespace rayshape
             virtual Buffer *CreateBuff() override;
             virtual bool NotifyWrite(Buffer *buffer) override;
             virtual Buffer *GetBuff(const Node *node) override;
-            // 需要添加最后一条边获取结果的接口getGraphOutputBuffer，这条边是没有消费者的边 #TODO
+            // 最后一条边获取结果的接口,这条边是没有消费者的边
             virtual Buffer *GetGraphOutputBuffer() override;
 #ifdef ENABLE_3RD_OPENCV
             virtual ErrorCode SetMat(cv::Mat *mat, bool is_external) override;
@@ -30,7 +44,6 @@ namespace rayshape
                                        const cv::Scalar &value) override;
             virtual bool NotifyWrite(cv::Mat *mat) override;
             virtual cv::Mat *GetMat(const Node *node) override; // 从具体的节点中获取Mat
-                                                                //
 
             virtual cv::Mat *GetGraphOutputMat() override;
 #endif
@@ -41,32 +54,157 @@ namespace rayshape
 
             virtual bool RequestTerminate() override;
 
-        private:
-            PipelineDataPackage *GetPipelineDataPacket(const Node *node);
+            virtual void SetEventListener(const EdgeEventFunc &on_data,
+                                          const EdgeEventFunc &on_space) override;
+
+            virtual bool IsReadable(const Node *node) override;
+
+            virtual bool IsWritable() override;
+
+            virtual void BeginReplicaWrite() override;
+
+            virtual void EndReplicaWrite(int slot, bool publish) override;
 
         private:
-            std::mutex mutex_;
-            std::condition_variable cv_;
-            // 边消费者数量,pipeline模式下边消费者数量为一般为1
-            int consumers_size_;
-
-            std::condition_variable queue_cv_;
-            int queue_max_size_;
-            // 数据包
-            // 数据包列表
-            std::list<PipelineDataPackage *> data_packets_;
+            // 消费者的读序号,独占cache line,各消费者推进自己的游标时不会伪共享
+            struct Cursor {
+                std::atomic<int64_t> read_seq_{0}; // 下一个要取的序号,生产者丢弃旧数据时会往前推
+                std::atomic<int64_t> hold_seq_{-1}; // 正在消费的序号,-1表示还没取过
+                char padding_[RS_CACHE_LINE_SIZE - 2 * sizeof(std::atomic<int64_t>)];
+            };
+
+            // 多副本生产者一个副本的暂存区
+            struct ReplicaStage {
+                std::vector<PipelineDataPackage *> written_; // 本次运行写入的数据包
+                std::vector<PipelineDataPackage *> spare_;   // 可复用的数据包
+            };
+
+            // 按队列深度分配槽位,多留一个给消费者正在使用的数据包;
+            // 丢旧数据的策略再多留一倍,消费者持有旧数据包时仍能继续写入
+            void AllocateSlots();
+
+            // 参数修改后重新分配,已有数据时等下次Construct生效
+            void Reconfigure();
+
+            // 是否由生产者推进消费者的读序号
+            bool IsDropOldest() {
+                return overflow_policy_ == QUEUE_OVERFLOW_DROP_OLDEST
+                       || overflow_policy_ == QUEUE_OVERFLOW_KEEP_LATEST;
+            }
+
+            // 每个消费者最多保留的未消费数据包个数
+            int64_t PendingLimit() {
+                return overflow_policy_ == QUEUE_OVERFLOW_KEEP_LATEST ? 1 : queue_max_size_;
+            }
+
+            void ReleaseSlots();
+
+            void ReleaseStages();
+
+            // 图输出边写满时把槽位数翻倍,需持有mutex_
+            void Grow();
+
+            // 节点在consumers_中的下标,即其游标下标,不是消费者返回-1
+            int FindCursor(const Node *node);
+
+            // 消费者的副本持有的序号,副本0用游标里的hold_seq_
+            std::atomic<int64_t> &HoldSeq(int cursor, int slot) {
+                return slot <= 0 ? cursors_[cursor].hold_seq_ : replica_holds_[cursor][slot - 1];
+            }
+
+            // 当前线程是消费者的哪个副本,不是多副本节点时为0
+            int ReplicaSlot(int cursor);
+
+            // 该消费者所有副本都已用完的序号上界
+            int64_t CursorReleased(int cursor);
+
+            // 是否有消费者的副本正持有seq
+            bool IsHeld(int64_t seq);
+
+            // 所有消费者都已用完的序号上界,序号小于它的槽位可以复用
+            int64_t ReleasedSeq();
+
+            bool HasSpace();
+
+            PipelineDataPackage *Slot(int64_t seq) {
+                return slots_[seq % capacity_];
+            }
+
+            /**
+             * @brief 生产者取下一个待写的槽位,环满时按溢出策略阻塞或丢弃
+             * @param[out] dropped 这次写入被丢弃,返回nullptr
+             * @return 终止后环满或被丢弃时返回nullptr
+             */
+            PipelineDataPackage *AcquireSlot(bool *dropped);
+
+            // 取write_seq_对应的槽位并编号,调用前需保证有空位
+            PipelineDataPackage *NextSlot();
+
+            // 多副本生产者在当前副本的暂存区取一个数据包写入
+            PipelineDataPackage *StageWrite();
+
+            // 多副本生产者当前副本的暂存区,生产者不是多副本时返回nullptr
+            ReplicaStage *CurrentStage();
+
+            // 多副本生产者写入BLOCK策略的非输出边时,派发前预留位置
+            bool IsReserving() {
+                return !stages_.empty() && overflow_policy_ == QUEUE_OVERFLOW_BLOCK
+                       && !is_output_edge_;
+            }
+
+            // 丢旧数据的策略下腾出槽位,需持有mutex_,腾不出时返回false
+            bool DropForWrite();
+
             /**
-             * 允许数据包任意位置快速插入和删除元素(不需要重新分配内存),支持双向迭代器.
+             * @brief 发布AcquireSlot取到的槽位,唤醒等待的消费者
+             * @param notify 是否通知流水线引擎,CreateMat的数据包在NotifyWrite时才通知
              */
+            void Publish(bool notify);
+
+            // 消费者取走seq后,seq - 1被释放
+            void AfterConsume(int64_t seq);
 
-            // 每个消费者节点 消费 的数据包最新索引  与下面当前数据包的关系为该索引为其+1
-            std::map<Node *, int> to_consume_index_;
+            // 生产者通知刚写入的数据包,从最新发布的往前找
+            template <typename T>
+            bool NotifyWritten(T *data);
 
-            // 每个消费者 消费 的当前数据包
-            std::map<Node *, PipelineDataPackage *> consuming_dp_;
+        private:
+            int consumers_size_ = 0; // 边消费者数量,pipeline模式下边消费者数量为一般为1
+            int queue_max_size_ = 16;
+            QueueOverflowPolicy overflow_policy_ = QUEUE_OVERFLOW_BLOCK;
+            std::atomic<int64_t> dropped_size_{0};
+            // 被丢弃的CreateMat写到这里,保证生产者拿到的Mat可用
+            PipelineDataPackage *discard_pack_ = nullptr;
+            bool last_dropped_ = false; // 生产者上一次写入被丢弃
+
+            std::vector<PipelineDataPackage *> slots_; // 预分配的环形槽位
+            int64_t capacity_ = 0;
+
+            std::atomic<int64_t> write_seq_{0}; // 已发布的数据包个数,只有生产者写
+            char padding_[RS_CACHE_LINE_SIZE - sizeof(std::atomic<int64_t>)];
+            std::unique_ptr<Cursor[]> cursors_; // 与consumers_一一对应,图输出边只有一个读取游标
+            std::vector<int> replica_sizes_;    // 与cursors_一一对应,消费者的副本数
+            std::vector<std::unique_ptr<std::atomic<int64_t>[]>> replica_holds_; // 副本1起持有的序号
+
+            std::vector<ReplicaStage> stages_; // 生产者的副本暂存区,生产者不是多副本时为空
+            std::atomic<int> reserved_{0};     // 已派发还未提交的副本运行预留的位置
+
+            // 环满/环空时休眠用,等待者计数为0时生产消费都不碰锁
+            std::mutex mutex_;
+            std::condition_variable data_cv_;
+            std::condition_variable space_cv_;
+            std::atomic<int> data_waiters_{0};
+            std::atomic<int> space_waiters_{0};
+            std::atomic<bool> terminated_{false};
+
+            // 没有消费者的边为图输出边,不做背压等待
+            bool is_output_edge_ = false;
+
+            EdgeEventFunc on_data_;  // 新数据包可读
+            EdgeEventFunc on_space_; // 队列腾出空位
         };
 
     } // namespace dag
 } // namespace rayshape
 
-#endif
\ No newline at end of file
+#endif
@@ -13,6 +13,10 @@ namespace rayshape
 {
     namespace dag
     {
+        // 一轮运行的输入回调和完成回调,都在该轮的运行槽位上执行(见RunSlotGuard)
+        using RunFeedFunc = std::function<ErrorCode()>;
+        using RunDoneFunc = std::function<void(ErrorCode)>;
+
         class RS_PUBLIC ExecuteEngine: public NonCopyable {
         public:
             ExecuteEngine() {};
@@ -30,6 +34,40 @@ namespace rayshape
 
             virtual ErrorCode Run() = 0;
 
+            // 等待已提交的运行全部完成,同步执行的引擎默认直接返回
+            virtual bool Synchronize() {
+                return true;
+            }
+
+            // 设置同时运行的最大轮数,Init前调用;不支持多轮并发的引擎仍逐轮执行
+            virtual ErrorCode SetMaxInFlight(int max_in_flight) {
+                if (max_in_flight != 1) {
+                    RS_LOGW("engine runs one invocation at a time, max in flight:%d ignored\n",
+                            max_in_flight);
+                }
+                return RS_SUCCESS;
+            }
+
+            // 提交一轮运行,默认在调用线程上同步执行完再返回
+            virtual std::future<ErrorCode> RunAsync(const RunFeedFunc &feed,
+                                                    const RunDoneFunc &done) {
+                ErrorCode ret = feed ? feed() : RS_SUCCESS;
+                if (ret == RS_SUCCESS) {
+                    ret = Run();
+                }
+                if (done) {
+                    done(ret);
+                }
+                std::promise<ErrorCode> promise;
+                promise.set_value(ret);
+                return promise.get_future();
+            }
+
+            // 等待RunAsync返回的结果,有线程池的引擎在等待期间让调用线程执行池中的任务
+            virtual ErrorCode Wait(std::future<ErrorCode> &future) {
+                return future.get();
+            }
+
         private:
             void *m_engine = nullptr;
         };
@@ -5,6 +5,11 @@
 #include "thread_pool/thread_pool.h"
 /**
  * @brief 流水线DAG执行引擎.参考nnde.ai流水线执行引擎
+ * @details 事件驱动调度: 节点的所有输入边都有数据且所有输出边都有空位时才作为一个任务
+ * 提交到进程内共享的有界线程池,边上写入数据或腾出空位时重新检查相关节点.
+ * 同一节点同时最多只有一个任务,保证每个节点按顺序消费数据包.
+ * 多副本节点(Node::SetReplicaSize)在派发时按顺序取走输入,最多同时有副本数个任务,
+ * 运行结束后按派发顺序提交输出,下游仍按输入顺序收到数据包.
  */
 
 namespace rayshape
@@ -27,15 +32,85 @@ namespace rayshape
             virtual ErrorCode Setup();
             // 注释掉
 
-            bool Synchronize();
+            virtual bool Synchronize() override;
 
-        protected:
-            void CommitThreadPool();
+        private:
+            // 节点的调度状态
+            struct NodeTask {
+                Node *node_ = nullptr;
+                std::vector<Edge *> inputs_;
+                std::vector<Edge *> outputs_;
+                std::atomic<bool> scheduled_{false}; // 已提交或正在运行
+                std::atomic<size_t> launched_{0};    // 没有输入边的节点已启动的次数
+
+                // 多副本节点的状态,副本数为1时不用
+                int replica_size_ = 1;
+                std::mutex replica_mutex_;          // 只保护下面的副本状态,持锁时不碰边和线程池
+                std::vector<int> idle_slots_;       // 空闲的副本
+                std::vector<int> done_slots_;       // 按派发序号取模,运行结束的副本,-1表示未结束
+                std::vector<bool> done_success_;    // 与done_slots_对应,运行是否成功
+                size_t dispatch_ticket_ = 0;        // 下一个派发序号,只在持有scheduled_时修改
+                size_t commit_ticket_ = 0;          // 下一个提交序号
+                std::atomic<bool> committing_{false}; // 有线程正在按序提交
+            };
+
+            /**
+             * @brief 节点是否可以运行: 输入边都可读,输出边都可写;
+             * 没有输入边的节点每次Run启动一次
+             */
+            bool IsReady(NodeTask &task);
+
+            /**
+             * @brief 本轮数据已流完: 没有输入边的节点都已启动,其余节点都没有可读的输入,需持有mutex_
+             * @details 边按溢出策略丢数据时下游的运行次数会少于Run的次数,以此判断同步完成
+             */
+            bool IsDrained();
+
+            /**
+             * @brief 节点就绪且没有在运行时提交到线程池,可以在任意线程上调用
+             * @param  index node index in topo_sort_node_
+             */
+            void TrySchedule(int index);
+
+            /**
+             * @brief 多副本节点的TrySchedule: 有空闲副本且就绪时一直派发
+             * @param  index node index in topo_sort_node_
+             */
+            void DispatchReplicas(int index);
+
+            // 有空闲副本且就绪
+            bool IsReplicaReady(NodeTask &task);
+
+            /**
+             * @brief 在副本slot上按顺序取走输入,预留输出位置并提交到线程池
+             * @return 输入被终止时返回false,副本退回空闲
+             */
+            bool StartReplica(int index, int slot);
+
+            /**
+             * @brief 线程池上执行一次副本,结束后按派发顺序提交已结束的副本
+             */
+            void ProcessReplica(int index, int slot, size_t ticket);
+
+            // 从commit_ticket_起提交连续结束的副本,同一时刻只有一个线程提交
+            void CommitReplicas(int index);
+
+            /**
+             * @brief 线程池上执行一次节点: 更新输入,运行,结束后重新检查该节点
+             * @param  index node index in topo_sort_node_
+             */
+            void Process(int index);
+
+            /**
+             * @brief 停止调度并终止所有边,唤醒阻塞的生产者
+             */
+            void Stop();
 
         private:
-            // 调度引擎持有线程池
-            threadpool::ThreadPool *thread_pool_ = nullptr; // 线程池,聚合关系
+            threadpool::ThreadPool *thread_pool_ = nullptr; // 共享线程池,不持有
             std::vector<NodeWrapper *> topo_sort_node_;     // 拓扑排序后的所有节点
+            std::unique_ptr<NodeTask[]> tasks_;             // 与topo_sort_node_一一对应
+            std::vector<int> source_nodes_;                 // 没有输入边的节点
 
             int all_task_count_ = 0;
 
@@ -49,20 +124,19 @@ namespace rayshape
              *
              * 记录已提交但尚未完全处理完的任务总数，即需要运行的总数
              */
-            size_t run_size_ = 0;
+            std::atomic<size_t> run_size_{0};
 
             /**
-             * @brief 已完成处理的任务数量
-             *
-             * 记录已经完成处理的任务数，用于跟踪流水线进度和同步
+             * @brief 已提交到线程池还未结束的节点任务数,mutex_保护下递减
              */
-            size_t completed_size_ = 0;
+            std::atomic<int> in_flight_{0};
+
+            std::atomic<bool> stop_flag_{false};         // 停止调度
+            std::atomic<ErrorCode> status_{RS_SUCCESS}; // 第一个失败节点的状态
 
             bool is_synchronize_ = false; // 是否同步
-            // 需要有锁配合变量改动
-            // ErrorCode global_status_ = RS_SUCCESS; // 全局任务的状态，改状态时
         };
     } // namespace dag
 } // namespace rayshape
 
-#endif
\ No newline at end of file
+#endif
@@ -7,6 +7,15 @@
 /*
 //noly finish dynamic engine of cgraph.
 针对的是非串行序列和全并行的图的运行场景
+Init时预计算执行计划(节点下标、后继下标、前驱个数),每个节点一个原子的待完成前驱计数,
+前驱完成时无锁递减,减到0的那个线程负责提交该节点,保证每轮每个节点只提交一次.
+每轮运行的状态(前驱计数、完成数、状态)放在独立的运行上下文中,最多max_in_flight轮同时运行,
+每个上下文对应一个运行槽位,节点在该槽位上读写固定边.
+节点结束时第一个就绪的后继在同一个工作线程上接着执行,其余后继提交到该线程自己的队列供空闲线程窃取,
+后继读前驱刚写的数据时命中本核缓存.
+就绪节点按向上秩(从该节点到出口的最长路径,按实测耗时的指数滑动平均加权)排优先级,
+剩余路径最长的先执行,长链不会因为晚就绪而拉长整轮耗时.
+Run和Wait等待时调用线程也从线程池取任务执行,不空等工作线程唤醒.
 */
 
 namespace rayshape
@@ -27,55 +36,98 @@ namespace rayshape
 
             virtual ErrorCode Run();
 
+            virtual bool Synchronize() override;
+
+            virtual ErrorCode SetMaxInFlight(int max_in_flight) override;
+
+            virtual std::future<ErrorCode> RunAsync(const RunFeedFunc &feed,
+                                                    const RunDoneFunc &done) override;
+
+            virtual ErrorCode Wait(std::future<ErrorCode> &future) override;
+
         private:
+            // 独占一个cache line的原子计数,相邻节点的计数被不同线程递减时不会伪共享
+            struct PaddedCounter {
+                std::atomic<int> value_{0};
+                char padding_[RS_CACHE_LINE_SIZE - sizeof(std::atomic<int>)];
+            };
+
+            // 一轮运行的状态,运行结束后放回空闲列表复用
+            struct RunContext {
+                int slot_ = 0;                             // 运行槽位
+                std::unique_ptr<PaddedCounter[]> pending_; // 每个节点本轮还未完成的前驱个数
+                std::atomic<int> completed_task_count_{0}; // 本轮已执行结束的节点个数
+                std::atomic<ErrorCode> status_{RS_SUCCESS}; // 本轮状态,记录第一个错误
+                std::promise<ErrorCode> promise_;
+                RunDoneFunc done_;
+            };
+
             /**
-             * @brief commit a node to execute.
-             * @param  node_wrapper
+             * @brief commit a node to execute, on the current worker's queue if called from a worker.
+             * @param  context run context
+             * @param  index node index in topo_sort_node_
              */
-            void Process(NodeWrapper *node_wrapper);
+            void Process(RunContext *context, int index);
 
             /**
-             * @brief node process after do something; node status refresh, add successors node
-             * wake up main thread
+             * @brief run a node on the current thread, then keep running the first ready successor
+             * @param  context run context
+             * @param  index node index in topo_sort_node_
+             */
+            void Execute(RunContext *context, int index);
+
+            /**
+             * @brief node process after do something; decrease successors pending counter,
+             * commit ready successors except the first, finish the run when all nodes completed
              *
-             * @param  node_wrapper
+             * @param  context run context
+             * @param  index node index in topo_sort_node_
+             * @return int the first ready successor to run on the current thread, -1 if none
              */
-            void AfterNodeRun(NodeWrapper *node_wrapper);
+            int AfterNodeRun(RunContext *context, int index);
 
             /**
-             * node running wait
-             * @param
-             * @return
+             * @brief 用节点耗时的滑动平均更新每个节点的向上秩
+             * @details 按拓扑逆序计算: rank[i] = cost[i] + max(rank[后继]),可与在途的其他轮并发
              */
-            void Wait();
+            void UpdateRanks();
 
             /**
-             * 用于清空节点运行状态 and 全局任务完成数量
-             * @param
-             * @return
+             * @brief 本轮结束: 执行完成回调,归还上下文,设置future结果
+             * @param  context run context
              */
-            void AfterGraphRun();
+            void AfterGraphRun(RunContext *context);
 
             /**
-             * @brief  一个节点有多个前驱节点时,多线程异步任务情况下,防止多次加入执行
-             * @param  node_wrapper
+             * @brief 记录本轮第一个失败节点的状态,之后的节点不再执行
+             * @param  context run context
+             * @param  ret node run status
              */
-            void SubmitTaskSynchronized(NodeWrapper *node_wrapper);
+            void SetRunStatus(RunContext *context, ErrorCode ret);
 
         private:
             // 调度引擎持有线程池
-            threadpool::ThreadPool *thread_pool_ = nullptr;  // 线程池,聚合关系
-            std::vector<NodeWrapper *> topo_sort_node_;      // 拓扑排序后的所有节点
-            std::vector<NodeWrapper *> start_nodes_;         // 没有依赖的起始节点
+            threadpool::ThreadPool *thread_pool_ = nullptr; // 线程池,聚合关系
+            std::vector<NodeWrapper *> topo_sort_node_;     // 拓扑排序后的所有节点
+
+            // 执行计划,Init后只读: 节点i的后继为
+            // successors_[successor_offsets_[i], successor_offsets_[i + 1])
+            std::vector<int> start_nodes_;         // 没有依赖的起始节点
+            std::vector<int> predecessors_size_;   // 每个节点的前驱个数
+            std::vector<int> successors_;          // 所有节点的后继下标
+            std::vector<int> successor_offsets_;   // 每个节点后继在successors_中的起始位置
+            int all_task_count_ = 0;               // 需要执行的所有节点个数
+
+            // 关键路径优先级,单位ns,多轮并发读写,只需原子性不需要顺序
+            std::unique_ptr<std::atomic<int64_t>[]> costs_; // 每个节点耗时的滑动平均
+            std::unique_ptr<std::atomic<int64_t>[]> ranks_; // 每个节点的向上秩,作为调度优先级
 
-            std::atomic<int> completed_task_count_{0}; // 已执行结束的元素个数
-            int all_task_count_ = 0;                   // 需要执行的所有节点个数
+            int max_in_flight_ = 1;                             // 同时运行的最大轮数
+            std::vector<std::unique_ptr<RunContext>> contexts_; // 每个槽位一个运行上下文
+            std::vector<RunContext *> idle_contexts_;           // 空闲的运行上下文
 
             std::mutex main_lock_;
-            std::mutex commit_lock_;
             std::condition_variable cv_;
-            std::mutex status_lock_;
-            ErrorCode global_status_ = RS_SUCCESS; // 全局任务的状态，改状态时
 
             std::vector<EdgeWrapper *> edge_repository_; // 边的仓库
         };
@@ -83,4 +135,4 @@ namespace rayshape
     } // namespace dag
 } // namespace rayshape
 
-#endif
\ No newline at end of file
+#endif
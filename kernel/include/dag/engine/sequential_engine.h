@@ -4,6 +4,9 @@
 #include "dag/engine.h"
 
 /* 串行的DAG执行引擎
+ * Init时把拓扑序固化成扁平的节点数组,并提前解析好每个节点的输入边,
+ * Run在调用线程上按数组顺序执行,不加锁、不使用线程池、不做任何内存分配.
+ * 适合单路小图,节点本身耗时小于线程切换开销的场景.
  */
 
 namespace rayshape
@@ -28,6 +31,12 @@ namespace rayshape
         protected:
             std::vector<NodeWrapper *> topo_sort_node_;
             std::vector<EdgeWrapper *> edge_repository_;
+
+            // 执行计划: 拓扑序的节点数组,节点i的输入边为
+            // run_input_edges_[run_edge_offsets_[i], run_edge_offsets_[i + 1])
+            std::vector<Node *> run_nodes_;
+            std::vector<Edge *> run_input_edges_;
+            std::vector<size_t> run_edge_offsets_;
         };
 
     } // namespace dag
@@ -187,11 +187,64 @@ namespace rayshape
              */
             virtual ErrorCode Deinit() override;
 
+            /**
+             * @brief 依次预热图中所有节点(子图递归),记录每个节点和整图的预热耗时
+             */
+            virtual ErrorCode Warmup() override;
+
+            /**
+             * @brief 设置Init时是否自动预热,开启后Init在预热完成后才置为已初始化
+             */
+            void SetWarmupFlag(bool flag);
+
             /**
              * @brief graph 运行 对node父类进行重载
              */
             virtual ErrorCode Run() override;
 
+            /**
+             * @brief 等待执行引擎中已提交的运行全部完成
+             */
+            bool Synchronize();
+
+            /**
+             * @brief 设置同时运行的最大轮数,Init前调用,默认1
+             * @details 大于1时PARALLEL_TYPE_TASK图的多轮运行可以重叠,此时节点Run必须可重入,
+             * 固定边按运行槽位分别保存数据,每轮的输入输出要在RunAsync的feed/done回调中读写
+             */
+            ErrorCode SetMaxInFlight(int max_in_flight);
+
+            /**
+             * @brief 设置流水线边的默认队列深度,Init前调用,默认16
+             * @details 边上用Edge::SetQueueMaxSize单独设置的优先
+             */
+            ErrorCode SetQueueMaxSize(int queue_max_size);
+
+            /**
+             * @brief 设置流水线边写满时的默认策略,Init前调用,默认阻塞生产者
+             * @details 实时流用QUEUE_OVERFLOW_KEEP_LATEST,过载时只处理最新的帧,时延不随积压增长;
+             * 边上用Edge::SetOverflowPolicy单独设置的优先
+             */
+            ErrorCode SetOverflowPolicy(QueueOverflowPolicy policy);
+
+            /**
+             * @brief 提交一轮运行,已有max_in_flight轮在运行时阻塞到其中一轮完成
+             * @param[in] feed 在本轮槽位上设置图输入,返回非RS_SUCCESS时本轮不运行
+             * @param[in] done 本轮结束后在本轮槽位上读取图输出,参数为本轮运行结果
+             * @return std::future<ErrorCode> 本轮运行结果,done执行完后就绪
+             */
+            std::future<ErrorCode> RunAsync(const RunFeedFunc &feed = nullptr,
+                                            const RunDoneFunc &done = nullptr);
+
+            /**
+             * @brief 等待RunAsync返回的结果
+             * @details PARALLEL_TYPE_TASK图在等待期间由调用线程执行就绪的节点,不空占一个核;
+             * 节点内部提交嵌套图并等待其结果时也应调用它,而不是直接future.get()
+             * @param[in] future RunAsync返回的结果
+             * @return ErrorCode 该轮运行结果
+             */
+            ErrorCode Wait(std::future<ErrorCode> &future);
+
             // 下面的虚方法必须被子类重载
             // 子类应该重载这些方法去定义他们自己的运算符() 执行,即子图的节点运行逻辑
             virtual std::vector<Edge *> Forward(std::vector<Edge *> inputs); // muti input edge
@@ -251,6 +304,10 @@ namespace rayshape
             std::shared_ptr<ExecuteEngine> execute_engine_; // 调度引擎
 
             bool is_forward_api_ok_ = true;
+            bool warmup_flag_ = false; // Init时自动预热
+            int max_in_flight_ = 1;    // 同时运行的最大轮数
+            int queue_max_size_ = 16;  // 流水线边的默认队列深度
+            QueueOverflowPolicy overflow_policy_ = QUEUE_OVERFLOW_BLOCK; // 流水线边写满时的默认策略
             // std::vector<std::shared_ptr<Edge>> shared_edge_repository_;
             // std::vector<std::shared_ptr<Node>> shared_node_repository_;
         };
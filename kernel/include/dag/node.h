@@ -61,9 +61,23 @@ namespace rayshape
             // pipeline all node attribute.
             void SetRunningFlag(bool flag);
 
+            // 记录一次已完成的运行,用于不经过SetRunningFlag的运行(如按序提交的副本运行)
+            void RecordCompletedRun();
+
             size_t GetRunCompletedSize();
 
             bool Synchronize();
+
+            /**
+             * @brief 设置副本数,流水线模式下连续的数据包由多个副本并发处理,输出仍按输入顺序写到下游
+             * @details 只有无状态的节点可以设置:同一个节点对象的Run会在多个线程上同时调用,
+             * 用GetRunSlot()区分副本,每个副本每次运行对每条输出边最多写一次.
+             * 在图Init前设置,顺序和任务模式忽略该设置
+             * @param replica_size 副本数,默认1
+             */
+            ErrorCode SetReplicaSize(int replica_size);
+
+            int GetReplicaSize() const;
             //
 
             // set all kind of status.
@@ -82,6 +96,11 @@ namespace rayshape
             virtual ErrorCode Init(); // 初始化函数
 
             virtual ErrorCode Deinit(); // 释放函数
+            /**
+             * @brief 预热,在Init后处理真实数据前调用,消除首帧的冷启动耗时
+             * @details 默认不做任何事,推理节点重载后用合成输入预热推理引擎
+             */
+            virtual ErrorCode Warmup();
 
             virtual EdgeUpdateFlag UpdateInput(); // 更新输入函数
 
@@ -140,6 +159,7 @@ namespace rayshape
             size_t completed_size_ = 0;
             size_t run_size_ = 0;
             bool is_running_ = false;
+            int replica_size_ = 1; // 流水线模式下同时处理数据包的副本数
 
             // Graph *graph_ = nullptr; // node 得知道在哪个图里
 
@@ -34,6 +34,25 @@ namespace rayshape
             std::vector<NodeWrapper *> consumers_; // 该条边的消费者
         };
 
+        /**
+         * @brief 当前线程正在执行的运行槽位
+         * @details 同一张图可以同时有多轮运行(见Graph::SetMaxInFlight),每轮占用一个槽位,
+         * 固定边按槽位分别保存数据包,节点在哪个槽位上运行就读写哪个槽位的数据.未设置时为0
+         */
+        RS_PUBLIC int GetRunSlot();
+
+        /**
+         * @brief 在作用域内把当前线程的运行槽位设为slot,析构时恢复
+         */
+        class RS_PUBLIC RunSlotGuard: public NonCopyable {
+        public:
+            explicit RunSlotGuard(int slot);
+            ~RunSlotGuard();
+
+        private:
+            int last_slot_;
+        };
+
         std::vector<NodeWrapper *> CheckUnuseNode(std::vector<NodeWrapper *> &node_repository);
 
         std::vector<NodeWrapper *> FindStartNodes(std::vector<NodeWrapper *> &node_repository);
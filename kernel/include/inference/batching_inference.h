@@ -0,0 +1,167 @@
+/**
+ * @file batching_inference.h
+ * @brief 动态batch推理模块
+ * @details 多个线程并发调用Forward时,把单帧请求按最大batch或最大排队时延攒成一个batch,
+ * 合并输入后只执行一次内部推理,再把输出按batch维拆回各调用方.
+ * @copyright .
+ *
+ * @author Liuxuan
+ * @email liuxuan@rayshape.com
+ * @date 2025-05-16
+ * @version 1.0.0
+ */
+
+#ifndef BATCHING_INFERENCE_H
+#define BATCHING_INFERENCE_H
+
+#include "inference/inference.h"
+#include "utils/json_utils.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rayshape
+{
+    namespace inference
+    {
+        /**
+         * @brief 动态batch策略,对应NetworkConfig中的BatchConfig
+         * @details json格式:
+         * "BatchConfig": {"MaxBatchSize": 8, "MaxQueueDelayUs": 2000}
+         */
+        typedef struct BatchPolicy {
+            int max_batch_size_ = 8;         // 一次推理最多合并的请求数
+            int max_queue_delay_us_ = 2000;  // 首个请求最长等待时间,超时后不满batch也执行
+        } BatchPolicy;
+
+        /**
+         * @brief 动态batch运行统计
+         */
+        typedef struct BatchStatistics {
+            uint64_t batch_count_ = 0;     // 内部Forward次数
+            uint64_t request_count_ = 0;   // 调用方Forward次数
+            int max_batch_size_ = 0;       // 实际出现过的最大batch
+            double avg_batch_size_ = 0;    // 平均batch
+            double avg_queue_delay_us_ = 0; // 请求平均排队时延
+            double max_queue_delay_us_ = 0; // 请求最大排队时延
+            std::vector<uint64_t> batch_size_hist_; // 下标为batch大小,值为出现次数
+        } BatchStatistics;
+
+        /**
+         * @brief 从package json中解析NetworkConfig/BatchConfig
+         * @param[in] json_handle package json
+         * @param[out] policy batch策略,未声明BatchConfig时保持默认值
+         * @return ErrorCode RS_SUCCESS if parse success, otherwise error code
+         */
+        RS_PUBLIC ErrorCode ParseBatchPolicy(const utils::RSJsonHandle json_handle,
+                                             BatchPolicy &policy);
+
+        /**
+         * @brief 动态batch推理,包装任意后端的Inference
+         * @details 输入输出blob按调用线程区分,batch维(第0维)为1;
+         * 同一线程按InputBlobGet->写入->Forward->OutputBlobGet的顺序使用,Forward阻塞到本次batch完成.
+         * 内部模型batch维是动态的则按实际请求数Reshape,否则按模型固定batch补零执行.
+         * 目前只支持CPU内存的blob.
+         */
+        class RS_PUBLIC BatchingInference: public Inference {
+        public:
+            BatchingInference(InferenceType type);
+            /**
+             * @brief wrap an created but not initialized inference, such as ShapeBucketInference
+             * @param[in] inference inner inference
+             */
+            BatchingInference(std::shared_ptr<Inference> inference);
+            ~BatchingInference() override;
+
+            ErrorCode Init(const Model *model, const CustomRuntime *runtime) override;
+            void DeInit() override;
+
+            /**
+             * @brief batch维由内部管理,不支持调用方Reshape
+             * @return ErrorCode RS_NOT_IMPLEMENT
+             */
+            ErrorCode Reshape(const char **name_arr, const Dims *dims_arr,
+                              size_t dims_size) override;
+            ErrorCode Forward() override;
+
+            ErrorCode InputBlobsGet(const Blob ***blob_arr, size_t *blob_size) override;
+            ErrorCode OutputBlobsGet(const Blob ***blob_arr, size_t *blob_size) override;
+            ErrorCode InputBlobGet(const char *input_name, Blob **blob) override;
+            ErrorCode OutputBlobGet(const char *output_name, const Blob **blob) override;
+
+            /**
+             * @brief 获取运行统计
+             * @param[out] stats batch大小和排队时延统计
+             * @return ErrorCode RS_SUCCESS if get success, otherwise error code
+             */
+            ErrorCode StatisticsGet(BatchStatistics *stats);
+
+        protected:
+            /**
+             * @brief 在调用线程取本线程的slot排入batch队列,worker完成该batch后FinishForward
+             * @details 不能用默认实现在线程池中Forward,池线程取到的是它自己的空slot
+             */
+            ErrorCode StartForward() override;
+
+        private:
+            // 每个调用线程一份输入输出
+            typedef struct BatchSlot {
+                std::vector<Blob *> inputs_;
+                std::vector<Blob *> outputs_;
+                bool done_ = true;
+                bool async_ = false; // 由StartForward排队,完成时需FinishForward
+                ErrorCode ret_ = RS_SUCCESS;
+                std::chrono::steady_clock::time_point enqueue_time_;
+            } BatchSlot;
+
+            ErrorCode InitBatchMode();
+            ErrorCode SlotGet(BatchSlot **slot);
+            ErrorCode EnqueueSlot(BatchSlot *slot, bool async);
+            void StopWorker();
+            void ClearSlots();
+            void WorkerLoop();
+            ErrorCode RunBatch(const std::vector<BatchSlot *> &batch);
+            ErrorCode PackInputs(const std::vector<BatchSlot *> &batch, int run_batch);
+            ErrorCode ScatterOutputs(const std::vector<BatchSlot *> &batch, int run_batch);
+            void UpdateStatistics(const std::vector<BatchSlot *> &batch,
+                                  std::chrono::steady_clock::time_point start_time);
+
+        private:
+            std::shared_ptr<Inference> inference_ = nullptr;
+            BatchPolicy policy_;
+
+            bool dynamic_batch_ = false; // 内部模型batch维可Reshape
+            int inner_batch_ = 0;        // 内部模型当前batch
+            // batch维为1的输入输出描述(buffer为空),用于创建调用线程的blob,
+            // 避免与worker中Reshape后的内部blob竞争
+            std::vector<Blob> input_templates_;
+            std::vector<Blob> output_templates_;
+
+            std::mutex mutex_;
+            std::condition_variable queue_cond_; // 唤醒worker
+            std::condition_variable done_cond_;  // 唤醒等待结果的调用方
+            std::deque<BatchSlot *> queue_;
+            std::map<std::thread::id, BatchSlot *> slots_;
+            std::thread worker_;
+            bool stop_ = true;
+
+            BatchStatistics stats_;
+            double total_queue_delay_us_ = 0;
+        };
+
+        /**
+         * @brief Create a batching Inference wrapping the backend of type
+         * @param[in] InferenceType type backend type
+         * @return std::shared_ptr<Inference>
+         */
+        extern RS_PUBLIC std::shared_ptr<Inference> CreateBatchingInference(InferenceType type);
+
+    } // namespace inference
+} // namespace rayshape
+
+#endif // BATCHING_INFERENCE_H
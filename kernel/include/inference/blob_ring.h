@@ -0,0 +1,115 @@
+/**
+ * @file blob_ring.h
+ * @brief 推理输入输出的多槽位环形blob
+ * @details 为一个推理实例准备K组输入输出内存,每次推理取一组空闲槽位绑定到推理实例(BindInput/BindOutput),
+ * 输出buffer交给下游DataPackage后,直到所有持有者释放才回收槽位,流水线各级可重叠执行且无需拷贝.
+ * @copyright .
+ *
+ * @author Liuxuan
+ * @email liuxuan@rayshape.com
+ * @date 2025-05-16
+ * @version 1.0.0
+ */
+
+#ifndef BLOB_RING_H
+#define BLOB_RING_H
+
+#include "inference/inference.h"
+
+namespace rayshape
+{
+    namespace inference
+    {
+        /**
+         * @brief 多槽位环形blob
+         * @details 使用顺序: Acquire取槽位 -> InputBlobGet写入输入 -> Forward ->
+         * OutputBufferShare把输出交给下游 -> Release归还生产者的引用.
+         * 槽位内存在最后一个共享buffer析构后才会被复用,所有槽位都被占用时Acquire阻塞,形成背压.
+         * 推理实例需支持BindInput/BindOutput,输出尺寸在Init时必须已确定.
+         */
+        class RS_PUBLIC BlobRing {
+        public:
+            BlobRing();
+            ~BlobRing();
+
+            /**
+             * @brief create depth slots shaped like the current inference blobs
+             * @param[in] inference initialized inference, must outlive the ring or DeInit first
+             * @param[in] depth slot num, must > 0
+             * @return ErrorCode RS_SUCCESS if init success, otherwise error code
+             */
+            ErrorCode Init(Inference *inference, int depth);
+
+            /**
+             * @brief release slots, buffers still shared downstream stay valid until destroyed
+             * @return void
+             */
+            void DeInit();
+
+            /**
+             * @brief acquire an idle slot and bind its memory to the inference
+             * @param[out] slot slot index
+             * @param[in] timeout_ms wait time in milliseconds, < 0 wait forever, 0 no wait
+             * @return ErrorCode RS_SUCCESS if acquired, RS_INFERENCE_TIMEOUT if no idle slot
+             */
+            ErrorCode Acquire(int *slot, int timeout_ms = -1);
+
+            /**
+             * @brief release the producer reference taken by Acquire
+             * @param[in] slot slot index
+             * @return ErrorCode RS_SUCCESS if released, RS_INVALID_PARAM if the slot is not
+             * acquired or already released
+             */
+            ErrorCode Release(int slot);
+
+            /**
+             * @brief get input blob of slot, write model input here
+             * @param[in] slot slot index
+             * @param[in] index input index, same order as Inference::InputBlobsGet
+             * @param[out] blob slot input blob
+             * @return ErrorCode RS_SUCCESS if get success, otherwise error code
+             */
+            ErrorCode InputBlobGet(int slot, size_t index, Blob **blob);
+
+            /**
+             * @brief get output blob of slot, valid after Forward
+             * @param[in] slot slot index
+             * @param[in] index output index, same order as Inference::OutputBlobsGet
+             * @param[out] blob slot output blob
+             * @return ErrorCode RS_SUCCESS if get success, otherwise error code
+             */
+            ErrorCode OutputBlobGet(int slot, size_t index, const Blob **blob);
+
+            /**
+             * @brief share output memory of slot without copy
+             * @details 返回的buffer由持有者delete(如DataPackage::SetBuff(buffer, false)随数据包销毁),
+             * 析构时归还对槽位的引用
+             * @param[in] slot slot index
+             * @param[in] index output index
+             * @return Buffer* buffer view, nullptr if failed
+             */
+            Buffer *OutputBufferShare(int slot, size_t index);
+
+            /**
+             * @brief get slot num
+             * @return int
+             */
+            int Depth();
+
+            /**
+             * @brief get idle slot num
+             * @return int
+             */
+            int IdleSize();
+
+        private:
+            struct RingState;
+
+            Inference *inference_ = nullptr;
+            std::shared_ptr<RingState> state_ = nullptr; // 共享buffer持有,保证槽位内存晚于其释放
+        };
+
+    } // namespace inference
+} // namespace rayshape
+
+#endif // BLOB_RING_H
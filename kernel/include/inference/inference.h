@@ -23,6 +23,11 @@ namespace rayshape
     namespace inference
     {
 
+        /**
+         * @brief ForwardAsync完成回调,参数为本次推理的结果
+         */
+        using ForwardCallback = std::function<void(ErrorCode)>;
+
         /**
          * @brief 推理的基类
          * @details 初始化第三方的推理引擎(OpenVINO,TensorRT, NCNN, ONNXRUNTIME,
@@ -60,6 +65,81 @@ namespace rayshape
              */
             virtual ErrorCode Forward() = 0;
 
+            /**
+             * @brief run synthetic inputs to trigger lazy compilation and memory first-touch
+             * @details 每个尺寸先Reshape再以全零输入执行iterations次Forward,记录首次(冷启动)与后续平均耗时;
+             * 结束后恢复原输入尺寸,应在Init后,处理真实数据前调用
+             * @param[in] iterations forward times per shape, must > 0
+             * @param[in] shapes input name -> dims per warmup shape, empty to use WarmupShapesGet
+             * @return ErrorCode RS_SUCCESS if warmup success, otherwise error code
+             */
+            ErrorCode Warmup(int iterations = 3,
+                             const std::vector<std::map<std::string, Dims>> &shapes = {});
+
+            /**
+             * @brief get shapes declared by model config for warmup
+             * @details 默认为空,表示只预热当前尺寸;动态尺寸模型返回声明的最大/最小尺寸或分桶尺寸
+             * @param[out] shapes input name -> dims per shape, inputs not listed keep current dims
+             * @return ErrorCode RS_SUCCESS if get success, otherwise error code
+             */
+            virtual ErrorCode WarmupShapesGet(std::vector<std::map<std::string, Dims>> &shapes);
+
+            /**
+             * @brief get input index by name, resolve once and use index afterwards
+             * @param[in] input_name input blob name
+             * @param[out] index input index, same order as InputBlobsGet
+             * @return ErrorCode RS_SUCCESS if found, otherwise error code
+             */
+            ErrorCode InputIndexGet(const char *input_name, size_t *index);
+
+            /**
+             * @brief get output index by name, resolve once and use index afterwards
+             * @param[in] output_name output blob name
+             * @param[out] index output index, same order as OutputBlobsGet
+             * @return ErrorCode RS_SUCCESS if found, otherwise error code
+             */
+            ErrorCode OutputIndexGet(const char *output_name, size_t *index);
+
+            /**
+             * @brief bind caller memory as input, forward reads it directly without copy
+             * @details buffer须为host内存且不小于当前输入尺寸,绑定期间调用方负责其生命周期;
+             * Reshape后输入尺寸变大或blob重建时绑定失效,需重新绑定
+             * @param[in] index input index from InputIndexGet
+             * @param[in] buffer caller buffer
+             * @return ErrorCode RS_SUCCESS if bind success, RS_NOT_IMPLEMENT if backend not support
+             */
+            virtual ErrorCode BindInput(size_t index, Buffer *buffer);
+
+            /**
+             * @brief bind caller memory as output, forward writes it directly without copy
+             * @details 约束同BindInput,输出尺寸依赖于数据时推理引擎仍可能先写入内部内存再拷贝
+             * @param[in] index output index from OutputIndexGet
+             * @param[in] buffer caller buffer
+             * @return ErrorCode RS_SUCCESS if bind success, RS_NOT_IMPLEMENT if backend not support
+             */
+            virtual ErrorCode BindOutput(size_t index, Buffer *buffer);
+
+            /**
+             * @brief start forward asynchronously, callback is called on completion
+             * @details 同一实例同时只能有一个未完成的异步推理;完成前不能修改输入blob或读取输出blob,
+             * 回调在推理引擎线程中执行,回调返回后Wait才返回.实例析构前须Wait
+             * @param[in] callback called with forward result, can be nullptr
+             * @return ErrorCode RS_SUCCESS if started, RS_INFERENCE_BUSY if previous one not finished
+             */
+            ErrorCode ForwardAsync(ForwardCallback callback);
+
+            /**
+             * @brief start forward asynchronously
+             * @return std::future<ErrorCode> forward result
+             */
+            std::future<ErrorCode> ForwardAsync();
+
+            /**
+             * @brief wait for the pending ForwardAsync
+             * @return ErrorCode result of last ForwardAsync, RS_SUCCESS if none
+             */
+            ErrorCode Wait();
+
             /**
              * @brief inference engine reshape for dynamic model
              * @param[in] name_arr need reshape model input name array
@@ -102,11 +182,40 @@ namespace rayshape
              */
             virtual ErrorCode OutputBlobGet(const char *output_name, const Blob **blob) = 0;
 
+            /**
+             * @brief create a new execution context sharing the compiled model of this one
+             * @details 新实例拥有独立的输入输出blob和推理请求,可与本实例在不同线程并发Forward,
+             * 权重和编译结果不重复占用内存.须在Init成功后调用
+             * @return std::shared_ptr<Inference> nullptr if backend does not support sharing
+             */
+            virtual std::shared_ptr<Inference> Clone();
+
+        protected:
+            /**
+             * @brief begin async forward, must call FinishForward exactly once when done
+             * @details 默认在进程级线程池中执行Forward,有原生异步接口的推理引擎重写
+             * @return ErrorCode RS_SUCCESS if started, otherwise error code
+             */
+            virtual ErrorCode StartForward();
+
+            /**
+             * @brief notify async forward finished
+             * @param[in] ret forward result
+             */
+            void FinishForward(ErrorCode ret);
+
         protected:
             /**
              * @brief inference engine type
              */
             InferenceType type_;
+
+        private:
+            std::mutex async_mutex_;
+            std::condition_variable async_cond_;
+            bool async_pending_ = false;
+            ErrorCode async_ret_ = RS_SUCCESS;
+            ForwardCallback async_callback_ = nullptr;
         };
 
         /**
@@ -136,7 +245,8 @@ namespace rayshape
          *
          * @return std::map<base::InferenceType, std::shared_ptr<InferenceCreator>>&
          */
-        std::map<InferenceType, std::shared_ptr<InferenceCreator>> &GetGlobalInferenceCreatorMap();
+        extern RS_PUBLIC std::map<InferenceType, std::shared_ptr<InferenceCreator>> &
+        GetGlobalInferenceCreatorMap();
 
         /**
          * @brief 推理框架的创建类的注册类模板
@@ -158,6 +268,34 @@ namespace rayshape
 
         extern RS_PUBLIC std::shared_ptr<Inference> CreateInference(InferenceType type);
 
+        /**
+         * @brief get package json config string of model
+         * @param[in] model loaded model
+         * @return const std::string* nullptr if model type has no config
+         */
+        const std::string *GetModelConfig(const Model *model);
+
+        /**
+         * @brief set process-wide inference runtime, must be called before the first Init
+         * @param[in] runtime global runtime parameters
+         * @return ErrorCode RS_SUCCESS if set success, RS_INVALID_PARAM if process-wide
+         * resources have already been created from the previous runtime
+         */
+        extern RS_PUBLIC ErrorCode SetGlobalRuntime(const GlobalRuntime *runtime);
+
+        /**
+         * @brief get process-wide inference runtime
+         * @return GlobalRuntime
+         */
+        extern RS_PUBLIC GlobalRuntime GetGlobalRuntime();
+
+        /**
+         * @brief get process-wide inference runtime to create process-wide resources
+         * @details 调用后GlobalRuntime即已生效,之后的SetGlobalRuntime返回错误
+         * @return GlobalRuntime
+         */
+        GlobalRuntime ApplyGlobalRuntime();
+
     } // namespace inference
 } // namespace rayshape
 
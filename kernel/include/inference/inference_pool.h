@@ -0,0 +1,92 @@
+/**
+ * @file inference_pool.h
+ * @brief 共享同一份编译模型的推理实例池
+ * @details 模型只加载编译一次,池中每个实例通过Inference::Clone创建,
+ * 拥有独立的推理请求(OpenVINO infer request, ORT io binding, MNN session)和输入输出blob,
+ * 多个线程各自Acquire一个实例即可并发Forward.
+ * @copyright .
+ *
+ * @author Liuxuan
+ * @email liuxuan@rayshape.com
+ * @date 2025-05-16
+ * @version 1.0.0
+ */
+
+#ifndef INFERENCE_POOL_H
+#define INFERENCE_POOL_H
+
+#include "inference/inference.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace rayshape
+{
+    namespace inference
+    {
+        /**
+         * @brief 推理实例池
+         * @details 后端不支持Clone(如TensorRT)时退化为每个实例单独Init,功能不变但权重会重复占用内存
+         */
+        class RS_PUBLIC InferencePool {
+        public:
+            InferencePool(InferenceType type);
+            ~InferencePool();
+
+            /**
+             * @brief load model once and create pool_size execution contexts
+             * @param[in] model model information
+             * @param[in] runtime inference runtime parameters
+             * @param[in] pool_size execution context num, must > 0
+             * @return ErrorCode RS_SUCCESS if init success, otherwise error code
+             */
+            ErrorCode Init(const Model *model, const CustomRuntime *runtime, size_t pool_size);
+
+            /**
+             * @brief free all execution contexts, contexts still acquired are freed when released
+             * @return void
+             */
+            void DeInit();
+
+            /**
+             * @brief acquire an idle execution context
+             * @param[out] inference idle execution context
+             * @param[in] timeout_ms wait time in milliseconds, < 0 wait forever, 0 no wait
+             * @return ErrorCode RS_SUCCESS if acquired, RS_INFERENCE_TIMEOUT if no idle context
+             */
+            ErrorCode Acquire(std::shared_ptr<Inference> &inference, int timeout_ms = -1);
+
+            /**
+             * @brief release execution context back to pool
+             * @param[in] inference execution context from Acquire
+             * @return ErrorCode RS_SUCCESS if released, otherwise error code
+             */
+            ErrorCode Release(const std::shared_ptr<Inference> &inference);
+
+            /**
+             * @brief get execution context num
+             * @return size_t
+             */
+            size_t Size();
+
+            /**
+             * @brief get idle execution context num
+             * @return size_t
+             */
+            size_t IdleSize();
+
+        private:
+            InferenceType type_ = InferenceType::NONE;
+
+            std::mutex mutex_;
+            std::condition_variable cond_;
+            std::vector<std::shared_ptr<Inference>> contexts_;
+            std::deque<std::shared_ptr<Inference>> idle_contexts_;
+        };
+
+    } // namespace inference
+} // namespace rayshape
+
+#endif // INFERENCE_POOL_H
@@ -31,6 +31,22 @@ namespace rayshape
                                                MNN::BackendConfig &backend_config,
                                                MNNForwardType &forward_type);
 
+            // Convert RayShape precision to MNN precision mode, AUTO keeps dst unchanged
+            static ErrorCode ConvertFromPrecision(MNN::BackendConfig::PrecisionMode &dst,
+                                                  const Precision src);
+
+            // Convert precision mode from string(normal/high/low/low_bf16)
+            static ErrorCode ConvertToPrecisionMode(MNN::BackendConfig::PrecisionMode &dst,
+                                                    const std::string &src);
+
+            // Convert memory mode from string(normal/high/low)
+            static ErrorCode ConvertToMemoryMode(MNN::BackendConfig::MemoryMode &dst,
+                                                 const std::string &src);
+
+            // Convert power mode from string(normal/high/low)
+            static ErrorCode ConvertToPowerMode(MNN::BackendConfig::PowerMode &dst,
+                                                const std::string &src);
+
             // Convert data format from string to RayShape data format
             static DataFormat ConvertToDataFormat(const std::string &src);
 
@@ -5,6 +5,8 @@
 #include "mnn_include.h"
 #include "utils/json_utils.h"
 
+#include <list>
+
 using namespace rayshape::utils;
 
 namespace rayshape
@@ -29,25 +31,58 @@ namespace rayshape
             ErrorCode InputBlobGet(const char *input_name, Blob **blob) override;
             ErrorCode OutputBlobGet(const char *output_name, const Blob **blob) override;
 
+            std::shared_ptr<Inference> Clone() override;
+
+            ErrorCode BindInput(size_t index, Buffer *buffer) override;
+            ErrorCode BindOutput(size_t index, Buffer *buffer) override;
+            ErrorCode WarmupShapesGet(std::vector<std::map<std::string, Dims>> &shapes) override;
+
         private:
             // Private methods
             ErrorCode InitWithModel(const std::string &model_buf);
             ErrorCode InitWithJson(const Model *model, const CustomRuntime *runtime,
                                    const RSJsonHandle json_handle);
             ErrorCode ParseInputShapes(const RSJsonHandle json_handle);
+            ErrorCode ParseSessionConfig(const RSJsonHandle json_handle);
+            ErrorCode InitBackendConfig();
             ErrorCode CreateBlobArray();
             ErrorCode Reshape();
             void ClearBlobArray();
 
+            // 按输入尺寸创建并resize一个新session
+            ErrorCode CreateSession(const std::map<std::string, Dims> &input_shapes,
+                                    MNN::Session **session);
+            // 切换到input_shapes对应的session,缓存未命中时新建,超出容量时淘汰最久未用的
+            ErrorCode SwitchSession(const std::map<std::string, Dims> &input_shapes);
+            static std::string ShapeKey(const std::map<std::string, Dims> &input_shapes);
+            // 以调用方内存创建host tensor,与session tensor之间由MNN拷贝(含布局转换)
+            ErrorCode CreateHostTensor(const Blob *blob, Buffer *buffer,
+                                       std::shared_ptr<MNN::Tensor> &host_tensor);
+
         private:
             // Device and runtime configuration
             DeviceType device_type_ = DeviceType::NONE;
             int num_threads_ = 4;
+            Precision precision_ = Precision::AUTO;
+
+            // NetworkConfig/SessionConfig, 空字符串表示使用设备默认值
+            std::string precision_mode_;
+            std::string memory_mode_;
+            std::string power_mode_;
+            std::string cache_file_;
+            int session_cache_size_ = 4;
 
             // MNN components
             std::shared_ptr<MNN::Interpreter> interpreter_ = nullptr;
-            MNN::Session *session_ = nullptr;
+            // Clone的实例共享interpreter_,创建/释放session需互斥,runSession可并发
+            std::shared_ptr<std::mutex> interpreter_mutex_ = nullptr;
+            MNN::Session *session_ = nullptr; // 当前使用的session,属于session_cache_
             MNN::ScheduleConfig schedule_config_;
+            MNN::BackendConfig backend_config_; // schedule_config_.backendConfig指向此处
+
+            // shape key -> session, 头部为最近使用
+            std::list<std::pair<std::string, MNN::Session *>> session_cache_;
+            std::map<std::string, Dims> input_shapes_; // 当前session的输入尺寸
 
             // Input/Output shape configurations
             std::map<std::string, Dims> input_min_shapes_;
@@ -63,6 +98,9 @@ namespace rayshape
             // Input/Output tensors
             std::vector<MNN::Tensor *> input_tensors_;
             std::vector<MNN::Tensor *> output_tensors_;
+            // BindInput/BindOutput绑定的调用方内存,未绑定为nullptr,session切换或blob重建时清空
+            std::vector<std::shared_ptr<MNN::Tensor>> input_host_tensors_;
+            std::vector<std::shared_ptr<MNN::Tensor>> output_host_tensors_;
         };
     } // namespace inference
 } // namespace rayshape
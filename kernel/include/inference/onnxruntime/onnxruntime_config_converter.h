@@ -24,6 +24,12 @@ namespace rayshape
             static ErrorCode ConvertFromDevice(std::string &dst, const DeviceType &src);
             //
             static DataFormat ConvertToDataFormat(const std::string &src);
+
+            // session options: "disable","basic","extended","all"
+            static ErrorCode ConvertToGraphOptLevel(GraphOptimizationLevel &dst,
+                                                   const std::string &src);
+            // session options: "sequential","parallel"
+            static ErrorCode ConvertToExecutionMode(ExecutionMode &dst, const std::string &src);
         };
 
     } // namespace onnxruntime
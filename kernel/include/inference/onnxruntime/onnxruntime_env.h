@@ -0,0 +1,34 @@
+#ifndef _ONNXRUNTIME_ENV_H_
+#define _ONNXRUNTIME_ENV_H_
+
+#include "base/common.h"
+#include "onnxruntime_include.h"
+
+namespace rayshape
+{
+    namespace onnxruntime
+    {
+        /**
+         * @brief 进程级共享的Ort::Env
+         * @details 第一次获取时按ApplyGlobalRuntime()创建,开启共享线程池时
+         * 所有session都要调用DisablePerSessionThreads,避免每个模型各起一组intra-op线程.
+         */
+        class ONNXRuntimeEnv {
+        public:
+            static std::shared_ptr<Ort::Env> Get();
+
+            // Env是否使用了进程级共享线程池
+            static bool IsGlobalThreadPool();
+
+        private:
+            static void Create();
+
+        private:
+            static std::shared_ptr<Ort::Env> env_;
+            static bool global_thread_pool_;
+        };
+
+    } // namespace onnxruntime
+} // namespace rayshape
+
+#endif
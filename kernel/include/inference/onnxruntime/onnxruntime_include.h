@@ -2,5 +2,6 @@
 #define _ONNXRUNTIME_INCLUDE_H_
 
 #include <onnxruntime_cxx_api.h>
+#include <onnxruntime_session_options_config_keys.h>
 
 #endif
\ No newline at end of file
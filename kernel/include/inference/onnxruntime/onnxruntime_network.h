@@ -3,6 +3,7 @@
 
 #include "inference/inference.h"
 #include "onnxruntime_include.h"
+#include "utils/json_utils.h"
 
 namespace rayshape
 {
@@ -26,26 +27,78 @@ namespace rayshape
             ErrorCode InputBlobGet(const char *input_name, Blob **blob) override;
             ErrorCode OutputBlobGet(const char *output_name, const Blob **blob) override;
 
+            std::shared_ptr<Inference> Clone() override;
+
+            ErrorCode BindInput(size_t index, Buffer *buffer) override;
+            ErrorCode BindOutput(size_t index, Buffer *buffer) override;
+            ErrorCode WarmupShapesGet(std::vector<std::map<std::string, Dims>> &shapes) override;
+
+        protected:
+            // session有独占的intra op线程池时基于Session::RunAsync执行,否则用默认实现
+            ErrorCode StartForward() override;
+
         private:
             ErrorCode CreateOrUpdateBlob(Blob **dst, const char *blob_name, size_t idx,
                                          bool is_input);
             ErrorCode CreateBlobArray();
             void ClearBlobArray();
 
-            // ErrorCode Reshape();
+            ErrorCode ParseInputShapes(const utils::RSJsonHandle json_handle);
+            // 解析NetworkConfig/SessionConfig
+            ErrorCode ParseSessionConfig(const utils::RSJsonHandle json_handle);
+            ErrorCode CreateSession(const std::string &onnx_data);
+            // 按precision_设置session选项
+            void PrecisionOptionsSet(Ort::SessionOptions &options);
+            // 基于session_创建io_binding和blob,Clone出的实例共享session_只执行这一步
+            ErrorCode InitContext();
+
+            // 由输入的符号维度(如batch,height)推导输出尺寸,无法推导的维度返回false
+            bool ResolveOutputDims(size_t idx, Dims &dims);
+            // 动态输出无法推导时,以最大输入尺寸试跑一次,按结果预分配输出
+            ErrorCode ProbeOutputShapes();
+            // 把blob内存绑定到io_binding_,形状变化后重新调用
+            ErrorCode BindBlobs();
+            ErrorCode UpdateOutputBlob(size_t idx, const Ort::Value &value);
+            // 构造RunAsync的输入输出,绑定blob内存的输出预分配,其余为空由ort分配
+            ErrorCode PrepareAsyncValues();
+            static void RunAsyncCallback(void *user_data, OrtValue **outputs, size_t num_outputs,
+                                         OrtStatusPtr status_ptr);
 
         private:
             // static std::mutex g_mutex;
             DeviceType device_type_ = DeviceType::NONE;
             int num_threads_ = 4;
+            Precision precision_ = Precision::AUTO;
+
+            // 模型原始shape,动态维度为-1,及对应的符号名
+            std::vector<std::vector<int64_t>> input_model_shapes_;
+            std::vector<std::vector<std::string>> input_symbols_;
+            std::vector<std::vector<int64_t>> output_model_shapes_;
+            std::vector<std::vector<std::string>> output_symbols_;
+            // true: 输出直接绑定blob内存; false: 由ort分配,Forward后拷贝到blob
+            std::vector<bool> output_bind_blob_;
 
-            std::vector<const char *> input_names_;
-            std::vector<const char *> output_names_;
-            std::vector<Ort::Value> input_tensors_;
-            std::vector<Ort::Value> output_tensors_;
+            // session tuning, 对应NetworkConfig/SessionConfig
+            int inter_op_num_threads_ = -1;
+            GraphOptimizationLevel graph_opt_level_ = GraphOptimizationLevel::ORT_ENABLE_ALL;
+            ExecutionMode execution_mode_ = ExecutionMode::ORT_SEQUENTIAL;
+            bool enable_mem_pattern_ = true;
+            bool enable_cpu_mem_arena_ = true;
+            std::string optimized_model_path_; // 为空时不缓存优化后的模型
+            bool model_optimized_ = false; // 模型已离线优化为ORT格式,见ONNXModel::optimized_
 
             std::shared_ptr<Ort::Env> env_;
             std::shared_ptr<Ort::Session> session_;
+            std::shared_ptr<Ort::IoBinding> io_binding_;
+            // RunAsync需要session独占且多于1个线程的intra op线程池,CreateSession时确定
+            bool native_async_ = false;
+
+            // RunAsync完成前ort会访问,需保持有效
+            Ort::RunOptions async_run_options_{nullptr};
+            std::vector<const char *> async_input_names_;
+            std::vector<Ort::Value> async_input_values_;
+            std::vector<const char *> async_output_names_;
+            std::vector<Ort::Value> async_output_values_;
 
             std::map<std::string, Dims> input_min_shapes_;
             std::map<std::string, Dims> input_max_shapes_;
@@ -0,0 +1,43 @@
+/**
+ * @file onnxruntime_precompile.h
+ * @brief ONNX模型离线图优化
+ * @details 打包时按指定优化级别和当前构建的执行后端(CPU,开启时含CUDA)做一次图优化,
+ * 结果以ORT格式写回ONNXModel,运行时ONNXRuntimeNetWork关闭在线图优化直接加载,缩短session创建耗时.
+ * 本头文件不依赖onnxruntime头文件,可供pack_models等工具直接使用.
+ * @copyright .
+ *
+ * @author Liuxuan
+ * @email liuxuan@rayshape.com
+ * @date 2025-05-16
+ * @version 1.0.0
+ */
+
+#ifndef _ONNXRUNTIME_PRECOMPILE_H_
+#define _ONNXRUNTIME_PRECOMPILE_H_
+
+#include "base/common.h"
+#include "base/error.h"
+#include "base/macros.h"
+#include "model/onnx/onnx_model.h"
+
+#include <string>
+
+namespace rayshape
+{
+    namespace onnxruntime
+    {
+        /**
+         * @brief optimize onnx graph offline and replace model->bin_buf_ with ORT format model
+         * @details "all"级别包含与执行后端/CPU相关的变换,只应在与部署环境一致的机器上使用,
+         * 需要跨机器分发时选"extended"
+         * @param[in,out] model onnx model, bin_buf_/optimized_/optimized_level_/optimized_version_ is filled
+         * @param[in] opt_level "basic","extended" or "all"
+         * @param[in] work_path temporary file for onnxruntime to save optimized model, removed after loaded
+         * @return ErrorCode RS_SUCCESS if optimize success, otherwise error code
+         */
+        RS_PUBLIC ErrorCode ONNXModelPrecompile(ONNXModel *model, const std::string &opt_level,
+                                                const std::string &work_path);
+    } // namespace onnxruntime
+} // namespace rayshape
+
+#endif // _ONNXRUNTIME_PRECOMPILE_H_
@@ -0,0 +1,25 @@
+#ifndef _OPENVINO_CORE_H_
+#define _OPENVINO_CORE_H_
+
+#include "openvino_include.h"
+
+namespace rayshape
+{
+    namespace inference
+    {
+        namespace openvino
+        {
+            /**
+             * @brief 进程级共享的ov::Core
+             * @details ov::Core本身线程安全,插件只加载一次,所有OpenVinoNetWork共用.
+             * cache_dir,线程数等属性不要设置在core上,而是在compile_model时按模型传入.
+             */
+            class OpenVINOCore {
+            public:
+                static std::shared_ptr<ov::Core> Get();
+            };
+        } // namespace openvino
+    } // namespace inference
+} // namespace rayshape
+
+#endif
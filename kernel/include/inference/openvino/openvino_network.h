@@ -3,6 +3,7 @@
 
 #include "inference/inference.h"
 #include "openvino_include.h"
+#include "model/openvino/openvino_model.h"
 #include "utils/json_utils.h"
 
 using namespace rayshape::utils;
@@ -32,6 +33,22 @@ namespace rayshape
             ErrorCode InputBlobGet(const char *input_name, Blob **blob) override;
             ErrorCode OutputBlobGet(const char *output_name, const Blob **blob) override;
 
+            std::shared_ptr<Inference> Clone() override;
+
+            ErrorCode BindInput(size_t index, Buffer *buffer) override;
+            ErrorCode BindOutput(size_t index, Buffer *buffer) override;
+            ErrorCode WarmupShapesGet(std::vector<std::map<std::string, Dims>> &shapes) override;
+
+            /**
+             * @brief export compiled model into model->compiled_blob_ with device and version tag
+             * @param[out] model model to store the blob
+             * @return ErrorCode RS_SUCCESS if export success, otherwise error code
+             */
+            ErrorCode CompiledModelExport(OpenVINOModel *model);
+
+        protected:
+            ErrorCode StartForward() override;
+
         private:
             // ErrorCode WriteXmlFile(const std::string &utf8_file_path, const std::string
             // &xml_file_path,std::string bin_data);
@@ -56,17 +73,30 @@ namespace rayshape
 
             ErrorCode Reshape();
 
+            ErrorCode SetInputTensors();
+            // blob改用调用方内存,并设置为infer request的输入/输出tensor
+            ErrorCode BindBlobTensor(Blob *blob, Buffer *buffer);
+
+            // 按precision_设置inference_precision hint,设备不支持时回退f32
+            void InferencePrecisionSet();
+            // 设备名,完整型号及推理精度,用于匹配预编译blob
+            std::string CompiledDeviceGet();
+            // 设备和OpenVINO版本一致时import预编译blob,失败返回false回退在线编译
+            bool ImportCompiledModel(const OpenVINOModel *model);
+
         private:
             // static std::mutex g_mutex;
             DeviceType device_type_ = DeviceType::NONE;
             int num_threads_ = 4;
+            Precision precision_ = Precision::AUTO;
 
             // std::string model_bin_content_;
 
             std::string device_name_ = "CPU";
 
-            std::shared_ptr<ov::Core> core_ = nullptr;
-            std::shared_ptr<ov::Model> model_ = nullptr;
+            std::shared_ptr<ov::Core> core_ = nullptr; // 进程级共享,见OpenVINOCore
+            ov::AnyMap compile_config_;                 // 每次compile_model时传入的属性
+            std::shared_ptr<ov::Model> model_ = nullptr; // Clone的实例间共享,Reshape前复制
 
             ov::CompiledModel compiled_model_;
             ov::InferRequest infer_request_;
@@ -0,0 +1,43 @@
+/**
+ * @file openvino_precompile.h
+ * @brief OpenVINO模型离线预编译
+ * @details 打包时按目标设备编译模型并把export_model的结果写入OpenVINOModel,随.rsm一起分发,
+ * 运行时设备和OpenVINO版本一致则直接import_model,省去首次加载的编译耗时.
+ * 本头文件不依赖OpenVINO头文件,可供pack_models等工具直接使用.
+ * @copyright .
+ *
+ * @author Liuxuan
+ * @email liuxuan@rayshape.com
+ * @date 2025-05-16
+ * @version 1.0.0
+ */
+
+#ifndef OPENVINO_PRECOMPILE_H
+#define OPENVINO_PRECOMPILE_H
+
+#include "base/common.h"
+#include "base/error.h"
+#include "base/macros.h"
+#include "model/openvino/openvino_model.h"
+
+namespace rayshape
+{
+    namespace inference
+    {
+        namespace openvino
+        {
+            /**
+             * @brief compile model for runtime device and store the exported blob into model
+             * @details 编译流程与运行时一致(按cfg_str_中MaxShapes reshape后compile),
+             * 已有的预编译blob会被覆盖
+             * @param[in,out] model openvino model, compiled_blob_/compiled_device_/compiled_version_ is filled
+             * @param[in] runtime target device and thread num
+             * @return ErrorCode RS_SUCCESS if compile and export success, otherwise error code
+             */
+            RS_PUBLIC ErrorCode OpenVINOModelPrecompile(OpenVINOModel *model,
+                                                        const CustomRuntime *runtime);
+        } // namespace openvino
+    } // namespace inference
+} // namespace rayshape
+
+#endif // OPENVINO_PRECOMPILE_H
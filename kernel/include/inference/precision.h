@@ -0,0 +1,56 @@
+/**
+ * @file precision.h
+ * @brief 推理精度配置
+ * @details CustomRuntime::precision_为AUTO时使用package json中的NetworkConfig/Precision:
+ * "NetworkConfig": {"Precision": "bf16"}, 取值auto/normal/high/low/bf16/fp16.
+ * 各推理引擎的映射: OpenVINO为inference_precision hint, ONNXRuntime为mlas bf16 fastmath(arm64),
+ * MNN为BackendConfig::PrecisionMode.
+ * @copyright .
+ *
+ * @author Liuxuan
+ * @email liuxuan@rayshape.com
+ * @date 2025-05-16
+ * @version 1.0.0
+ */
+
+#ifndef PRECISION_H
+#define PRECISION_H
+
+#include "base/common.h"
+#include "base/error.h"
+#include "utils/json_utils.h"
+
+#include <string>
+
+namespace rayshape
+{
+    namespace inference
+    {
+        /**
+         * @brief convert precision from string
+         * @param[out] dst precision
+         * @param[in] src auto/normal/high/low/bf16/fp16, case insensitive
+         * @return ErrorCode RS_SUCCESS if convert success, RS_INVALID_PARAM_VALUE if unknown
+         */
+        RS_PUBLIC ErrorCode ConvertToPrecision(Precision &dst, const std::string &src);
+
+        /**
+         * @brief convert precision to string
+         * @param[in] src precision
+         * @return const char* lowercase name, "unknown" if invalid
+         */
+        RS_PUBLIC const char *PrecisionToString(Precision src);
+
+        /**
+         * @brief parse NetworkConfig/Precision from package json
+         * @param[in] json_handle package json
+         * @param[in,out] precision only replaced when it is AUTO and json declares one
+         * @return ErrorCode RS_SUCCESS if parse success, otherwise error code
+         */
+        RS_PUBLIC ErrorCode ParsePrecision(const utils::RSJsonHandle json_handle,
+                                           Precision &precision);
+
+    } // namespace inference
+} // namespace rayshape
+
+#endif // PRECISION_H
@@ -0,0 +1,164 @@
+/**
+ * @file shape_bucket_inference.h
+ * @brief 动态输入的shape分桶推理模块
+ * @details 在package json的ModelConfig中声明ShapeBuckets,
+ * 输入按最近的桶做pad/letterbox后再Forward,输出再按原始尺寸裁剪回来,
+ * 以避免每个新尺寸都触发后端重新编译.
+ * @copyright .
+ *
+ * @author Liuxuan
+ * @email liuxuan@rayshape.com
+ * @date 2025-05-16
+ * @version 1.0.0
+ */
+
+#ifndef SHAPE_BUCKET_INFERENCE_H
+#define SHAPE_BUCKET_INFERENCE_H
+
+#include "inference/inference.h"
+#include "utils/json_utils.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace rayshape
+{
+    namespace inference
+    {
+        /**
+         * @brief 输入填充到桶尺寸的方式
+         */
+        enum class BucketPadMode {
+            PAD = 0,       // 数据放在左上角,右下补pad_value
+            LETTERBOX = 1, // 数据居中,四周补pad_value
+        };
+
+        /**
+         * @brief shape分桶策略,对应ModelConfig中的ShapeBuckets
+         * @details json格式:
+         * "ShapeBuckets": {
+         *     "PadMode": "letterbox",
+         *     "PadValue": 114,
+         *     "Shapes": [{"name": "images", "dims": [[1,3,320,320], [1,3,640,640]]}]
+         * }
+         */
+        typedef struct ShapeBucketPolicy {
+            BucketPadMode pad_mode_ = BucketPadMode::PAD;
+            int pad_value_ = 0;
+            std::map<std::string, std::vector<Dims>> buckets_; // input name -> buckets
+        } ShapeBucketPolicy;
+
+        /**
+         * @brief 从package json中解析ModelConfig/ShapeBuckets
+         * @param[in] json_handle package json
+         * @param[out] policy 分桶策略,未声明ShapeBuckets时buckets_为空
+         * @return ErrorCode RS_SUCCESS if parse success, otherwise error code
+         */
+        RS_PUBLIC ErrorCode ParseShapeBuckets(const utils::RSJsonHandle json_handle,
+                                              ShapeBucketPolicy &policy);
+
+        /**
+         * @brief 选择能容纳dims的体积最小的桶
+         * @param[in] buckets 候选桶
+         * @param[in] dims 实际输入尺寸
+         * @param[out] bucket 选中的桶
+         * @return ErrorCode RS_SUCCESS if found, RS_INVALID_PARAM_VALUE if no bucket fits
+         */
+        RS_PUBLIC ErrorCode SelectShapeBucket(const std::vector<Dims> &buckets, const Dims &dims,
+                                              Dims &bucket);
+
+        /**
+         * @brief 计算实际数据在桶内的起始偏移,letterbox只在空间维(H,W)上居中
+         * @param[in] mode pad方式
+         * @param[in] data_format 数据排布,用于确定空间维
+         * @param[in] dims 实际尺寸
+         * @param[in] bucket 桶尺寸
+         * @param[out] offset 每一维的偏移
+         */
+        RS_PUBLIC void ComputeBucketOffset(BucketPadMode mode, DataFormat data_format,
+                                           const Dims &dims, const Dims &bucket, Dims &offset);
+
+        /**
+         * @brief 把src拷贝到dst的offset处,其余位置填pad_value,dst->dims为桶尺寸
+         * @return ErrorCode RS_SUCCESS if copy success, otherwise error code
+         */
+        RS_PUBLIC ErrorCode PadBlobToBucket(const Blob *src, Blob *dst, const Dims &offset,
+                                            int pad_value);
+
+        /**
+         * @brief 从src的offset处裁剪出dst->dims大小的数据
+         * @return ErrorCode RS_SUCCESS if copy success, otherwise error code
+         */
+        RS_PUBLIC ErrorCode CropBlobFromBucket(const Blob *src, Blob *dst, const Dims &offset);
+
+        /**
+         * @brief shape分桶推理,包装任意后端的Inference
+         * @details 对外的输入输出blob保持实际尺寸,内部推理引擎只会看到声明过的桶尺寸.
+         * 输出与输入同维度且在变化的维度上与桶成整数倍关系(如分割mask,特征图)时按比例裁剪,
+         * 其余输出(分类,检测框等)原样返回,letterbox时的坐标还原由调用方通过BucketOffsetGet处理.
+         * 未声明ShapeBuckets时所有接口直接透传给内部推理引擎.
+         */
+        class RS_PUBLIC ShapeBucketInference: public Inference {
+        public:
+            ShapeBucketInference(InferenceType type);
+            ~ShapeBucketInference() override;
+
+            ErrorCode Init(const Model *model, const CustomRuntime *runtime) override;
+            void DeInit() override;
+
+            ErrorCode Reshape(const char **name_arr, const Dims *dims_arr,
+                              size_t dims_size) override;
+            ErrorCode Forward() override;
+
+            ErrorCode InputBlobsGet(const Blob ***blob_arr, size_t *blob_size) override;
+            ErrorCode OutputBlobsGet(const Blob ***blob_arr, size_t *blob_size) override;
+            ErrorCode InputBlobGet(const char *input_name, Blob **blob) override;
+            ErrorCode OutputBlobGet(const char *output_name, const Blob **blob) override;
+
+            /**
+             * @brief 每个桶尺寸预热一次,输入的桶数不同时桶数少的输入重复使用其最后一个桶
+             */
+            ErrorCode WarmupShapesGet(std::vector<std::map<std::string, Dims>> &shapes) override;
+
+            /**
+             * @brief 获取输入当前所在的桶和实际数据在桶内的偏移
+             * @param[in] input_name model input blob name
+             * @param[out] bucket 桶尺寸
+             * @param[out] offset 实际数据起始偏移
+             * @return ErrorCode RS_SUCCESS if found, otherwise error code
+             */
+            ErrorCode BucketOffsetGet(const char *input_name, Dims *bucket, Dims *offset);
+
+        private:
+            ErrorCode CreateBlobArray();
+            void ClearBlobArray();
+            ErrorCode UpdateInputBlobArray();
+            ErrorCode CropOutputs();
+
+        private:
+            std::shared_ptr<Inference> inference_ = nullptr;
+            ShapeBucketPolicy policy_;
+
+            std::map<std::string, Dims> input_buckets_; // input name -> current bucket
+            std::map<std::string, Dims> input_offsets_; // input name -> current offset
+
+            // 分桶输入/可裁剪输出由本类持有,其余直接引用内部推理引擎的blob
+            std::map<std::string, Blob *> bucket_input_blobs_;
+            std::map<std::string, Blob *> crop_output_blobs_;
+
+            std::vector<Blob *> input_blobs_;
+            std::vector<Blob *> output_blobs_;
+        };
+
+        /**
+         * @brief Create a shape bucket Inference wrapping the backend of type
+         * @param[in] InferenceType type backend type
+         * @return std::shared_ptr<Inference>
+         */
+        extern RS_PUBLIC std::shared_ptr<Inference> CreateShapeBucketInference(InferenceType type);
+
+    } // namespace inference
+} // namespace rayshape
+
+#endif // SHAPE_BUCKET_INFERENCE_H
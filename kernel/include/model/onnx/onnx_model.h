@@ -18,6 +18,11 @@ namespace rayshape
     public:
         std::string cfg_str_;
         std::string bin_buf_;
+
+        // pack_models离线优化: bin_buf_为优化后的ORT格式模型,加载时关闭在线图优化
+        bool optimized_ = false;
+        std::string optimized_level_;   // 离线优化级别,"basic","extended","all"
+        std::string optimized_version_; // 离线优化时的onnxruntime版本
     };
 } // namespace rayshape
 
@@ -19,6 +19,11 @@ namespace rayshape
         std::string cfg_str_;
         std::string xml_content_;
         std::string bin_content_;
+
+        // pack_models预编译的export_model结果,设备和OpenVINO版本一致时import_model,否则忽略并在线编译
+        std::string compiled_blob_;
+        std::string compiled_device_;  // 编译设备,完整名称及精度,如"CPU:Intel(R) Xeon(R) 8480+:bf16"
+        std::string compiled_version_; // 编译时的OpenVINO build number
     };
 } // namespace rayshape
 
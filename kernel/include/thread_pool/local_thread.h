@@ -4,6 +4,7 @@
 #include <memory>
 #include <thread>
 
+#include "thread_pool/safe_priority_queue.h"
 #include "thread_pool/safe_ws_queue.h"
 #include "thread_pool/runnable_task.h"
 
@@ -46,6 +47,28 @@ namespace rayshape
                 total_thread_size_ = (int)pool_threads->size();
             }
 
+            /**
+             * 当前线程对应的局部线程对象,不是线程池的线程时为nullptr
+             * @return
+             */
+            static LocalThread *&Current() {
+                static thread_local LocalThread *current = nullptr;
+                return current;
+            }
+
+            bool IsIn(const std::vector<LocalThread *> *pool_threads) const {
+                return pool_threads_ == pool_threads;
+            }
+
+            unsigned int GetIndex() const {
+                return index_;
+            }
+
+            // 唤醒休眠的线程去取任务或窃取
+            void Notify() {
+                cv_.notify_one();
+            }
+
             /**
              * 线程执行函数
              * @return
@@ -56,6 +79,7 @@ namespace rayshape
                     return RS_THREAD_POLL_ERROR;
                 }
 
+                Current() = this;
                 while (done_) {
                     RTask task;
                     if (PopTask(task) || StealTask(task)) {
@@ -81,12 +105,35 @@ namespace rayshape
             }
 
             /**
-             * 从本地弹出一个任务
+             * 带优先级的任务写入优先级队列,比普通任务先执行
+             * @param task
+             * @param priority 越大越先执行
+             * @return
+             */
+            void PushTask(RTask &&task, int64_t priority) {
+                while (!(priority_queue_.TryPush(std::forward<RTask>(task), priority))) {
+                    std::this_thread::yield();
+                }
+                cv_.notify_one();
+            }
+
+            /**
+             * 从本地弹出一个任务,优先级队列优先
              * @param task
              * @return
              */
             bool PopTask(RTask &task) {
-                return primary_queue_.TryPop(task);
+                return priority_queue_.TryPop(task) || primary_queue_.TryPop(task);
+            }
+
+            /**
+             * 供线程池外的线程窃取本线程的任务
+             * @param task
+             * @param priority true从优先级队列窃取,否则从普通队列
+             * @return
+             */
+            bool TrySteal(RTask &task, bool priority) {
+                return priority ? priority_queue_.TrySteal(task) : primary_queue_.TrySteal(task);
             }
 
             /**
@@ -104,6 +151,14 @@ namespace rayshape
                     return false;
                 }
 
+                // 先窃取其他线程优先级最高的任务
+                for (auto &target : steal_targets_) {
+                    if (((*pool_threads_)[target])
+                        && ((*pool_threads_)[target])->priority_queue_.TrySteal(task)) {
+                        return true;
+                    }
+                }
+
                 for (auto &target : steal_targets_) {
                     /**
                      * 从线程中周围的thread中，窃取任务。
@@ -112,7 +167,7 @@ namespace rayshape
                      */
 
                     if (((*pool_threads_)[target])
-                        || ((*pool_threads_)[target])->primary_queue_.TrySteal(task)) {
+                        && ((*pool_threads_)[target])->primary_queue_.TrySteal(task)) {
                         return true;
                     }
                 }
@@ -139,6 +194,7 @@ namespace rayshape
             int total_thread_size_;
 
             SafeWSQueue<RTask> primary_queue_;         // 任务队列
+            SafePriorityQueue<RTask> priority_queue_;  // 带优先级的任务队列
             std::vector<LocalThread *> *pool_threads_; // 全局线程池
             std::vector<int> steal_targets_;           // 从其他线程窃取任务，存储的是其他线程的索引
             std::mutex mutex_;
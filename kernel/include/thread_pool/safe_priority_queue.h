@@ -0,0 +1,91 @@
+#ifndef _SAFE_PRIORITY_QUEUE_H_
+#define _SAFE_PRIORITY_QUEUE_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/*安全
+按优先级出队的任务队列,优先级高的先出,同优先级先进先出;窃取时同样取优先级最高的任务
+*/
+
+namespace rayshape
+{
+    namespace threadpool
+    {
+        template <typename T>
+        class SafePriorityQueue {
+        public:
+            SafePriorityQueue() = default;
+
+            /**
+             * 尝试往队列里写入信息
+             * @param task
+             * @param priority 越大越先执行
+             * @return
+             */
+            bool TryPush(T &&task, int64_t priority) {
+                bool result = false;
+                if (lock_.try_lock()) {
+                    heap_.emplace_back(priority, sequence_++, std::forward<T>(task));
+                    std::push_heap(heap_.begin(), heap_.end(), Less);
+                    lock_.unlock();
+                    result = true;
+                }
+                return result;
+            }
+
+            /**
+             * 弹出优先级最高的节点
+             * @param task
+             * @return
+             */
+            bool TryPop(T &task) {
+                bool result = false;
+                if (!heap_.empty() && lock_.try_lock()) {
+                    if (!heap_.empty()) {
+                        std::pop_heap(heap_.begin(), heap_.end(), Less);
+                        task = std::forward<T>(heap_.back().task_);
+                        heap_.pop_back();
+                        result = true;
+                    }
+                    lock_.unlock();
+                }
+
+                return result;
+            }
+
+            /**
+             * 窃取节点,也取优先级最高的,保证关键路径上的任务先被执行
+             * @param task
+             * @return
+             */
+            bool TrySteal(T &task) {
+                return TryPop(task);
+            }
+
+        private:
+            struct Item {
+                Item(int64_t priority, uint64_t sequence, T &&task) :
+                    priority_(priority), sequence_(sequence), task_(std::forward<T>(task)) {}
+
+                int64_t priority_;
+                uint64_t sequence_; // 入队序号,同优先级先进先出
+                T task_;
+            };
+
+            static bool Less(const Item &a, const Item &b) {
+                return a.priority_ < b.priority_
+                       || (a.priority_ == b.priority_ && a.sequence_ > b.sequence_);
+            }
+
+            std::vector<Item> heap_; // 大顶堆
+            uint64_t sequence_ = 0;
+            std::mutex lock_;
+        };
+    } // namespace threadpool
+
+} // namespace rayshape
+
+#endif // _SAFE_PRIORITY_QUEUE_H_
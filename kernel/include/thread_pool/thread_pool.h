@@ -38,13 +38,21 @@ namespace rayshape
             }
 
             ErrorCode DeInit() {
+                // 先停掉所有线程再释放,避免其他线程还在从已释放的线程窃取任务
                 for (auto &ptr_thread : threads_) {
                     ptr_thread->DeInit();
+                }
+                for (auto &ptr_thread : threads_) {
                     delete ptr_thread;
                 }
+                threads_.clear();
                 return RS_SUCCESS;
             }
 
+            unsigned int GetThreadSize() const {
+                return max_thread_size_;
+            }
+
             // void run();
             template <typename FunctionType>
             auto Commit(const FunctionType &func)
@@ -52,18 +60,127 @@ namespace rayshape
                 using ResultType = decltype(std::declval<FunctionType>()());
                 std::packaged_task<ResultType()> task(func);
                 std::future<ResultType> result(task.get_future());
-                // 均匀提交策略 和Cgraph有差异
-                cur_index_++;
-                if (cur_index_ >= max_thread_size_ || cur_index_ < 0) {
-                    cur_index_ = 0;
+                // 均匀提交策略 和Cgraph有差异,多个线程同时提交时下标也不越界
+                unsigned int index = cur_index_.fetch_add(1) % max_thread_size_;
+                threads_[index]->PushTask(std::move(task)); // 右值
+                return result;
+            }
+
+            /**
+             * @brief 提交到当前工作线程自己的队列,空闲线程从队尾窃取
+             * @details 在本线程池的工作线程上提交后继任务时用,后继读前驱刚写的数据时还在本核缓存里;
+             * 不在本线程池的线程上调用时同Commit
+             */
+            template <typename FunctionType>
+            auto CommitLocal(const FunctionType &func)
+                -> std::future<decltype(std::declval<FunctionType>()())> {
+                LocalThread *current = LocalThread::Current();
+                if (current == nullptr || !current->IsIn(&threads_)) {
+                    return Commit(func);
+                }
+                using ResultType = decltype(std::declval<FunctionType>()());
+                std::packaged_task<ResultType()> task(func);
+                std::future<ResultType> result(task.get_future());
+                current->PushTask(std::move(task));
+                // 本线程正忙,叫醒下一个线程来窃取
+                if (max_thread_size_ > 1) {
+                    threads_[(current->GetIndex() + 1) % max_thread_size_]->Notify();
+                }
+                return result;
+            }
+
+            /**
+             * @brief 按优先级提交,轮询分配到各线程的优先级队列
+             * @details 优先级队列里的任务比普通任务先执行,同一线程内优先级高的先出队,窃取时也取最高的
+             * @param func 任务
+             * @param priority 越大越先执行
+             */
+            template <typename FunctionType>
+            auto Commit(const FunctionType &func, int64_t priority)
+                -> std::future<decltype(std::declval<FunctionType>()())> {
+                using ResultType = decltype(std::declval<FunctionType>()());
+                std::packaged_task<ResultType()> task(func);
+                std::future<ResultType> result(task.get_future());
+                unsigned int index = cur_index_.fetch_add(1) % max_thread_size_;
+                threads_[index]->PushTask(std::move(task), priority);
+                return result;
+            }
+
+            /**
+             * @brief 按优先级提交到当前工作线程自己的优先级队列,不在本线程池的线程上调用时同Commit
+             * @param func 任务
+             * @param priority 越大越先执行
+             */
+            template <typename FunctionType>
+            auto CommitLocal(const FunctionType &func, int64_t priority)
+                -> std::future<decltype(std::declval<FunctionType>()())> {
+                LocalThread *current = LocalThread::Current();
+                if (current == nullptr || !current->IsIn(&threads_)) {
+                    return Commit(func, priority);
+                }
+                using ResultType = decltype(std::declval<FunctionType>()());
+                std::packaged_task<ResultType()> task(func);
+                std::future<ResultType> result(task.get_future());
+                current->PushTask(std::move(task), priority);
+                if (max_thread_size_ > 1) {
+                    threads_[(current->GetIndex() + 1) % max_thread_size_]->Notify();
                 }
-                threads_[cur_index_]->PushTask(std::move(task)); // 右值
                 return result;
             }
 
+            // 当前线程是否是本线程池的工作线程
+            bool IsWorkerThread() {
+                LocalThread *current = LocalThread::Current();
+                return current != nullptr && current->IsIn(&threads_);
+            }
+
+            /**
+             * @brief 在当前线程上执行一个线程池中待执行的任务
+             * @details 工作线程先取自己的队列再窃取,其他线程从各线程窃取,优先级队列优先
+             * @return true 执行了一个任务, false 没有取到任务
+             */
+            bool RunPendingTask() {
+                RTask task;
+                bool found = false;
+                LocalThread *current = LocalThread::Current();
+                if (current != nullptr && current->IsIn(&threads_)) {
+                    found = current->PopTask(task) || current->StealTask(task);
+                } else {
+                    unsigned int start = cur_index_.load(std::memory_order_relaxed);
+                    for (int pass = 0; pass < 2 && !found; ++pass) {
+                        for (unsigned int i = 0; i < max_thread_size_ && !found; ++i) {
+                            found = threads_[(start + i) % max_thread_size_]->TrySteal(task,
+                                                                                       pass == 0);
+                        }
+                    }
+                }
+                if (found) {
+                    task();
+                }
+                return found;
+            }
+
+            /**
+             * @brief 帮助式等待: 等待期间当前线程执行线程池中的任务,结果就绪后立即返回
+             * @details 调用线程不再空等工作线程唤醒它;节点内部等待嵌套提交的任务时也用它,
+             * 工作线程不会因为阻塞等待而闲置
+             * @param future 要等待的结果
+             * @return future的结果
+             */
+            template <typename ResultType>
+            ResultType Wait(std::future<ResultType> &future) {
+                while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                    if (!RunPendingTask()) {
+                        // 没有可执行的任务,短暂等待后再取,结果就绪时立即返回
+                        future.wait_for(std::chrono::microseconds(100));
+                    }
+                }
+                return future.get();
+            }
+
         private:
             unsigned int max_thread_size_ = 0;
-            std::atomic<int> cur_index_{0};
+            std::atomic<unsigned int> cur_index_{0};
             std::vector<LocalThread *> threads_; // 主线程任务primary_threads_
         };
 
@@ -1,7 +1,9 @@
 #ifndef _BLOB_UTILS_H_
 #define _BLOB_UTILS_H_
 
+#include "base/logger.h"
 #include "memory_manager/blob.h"
+#include "utils/memory_size_info.h"
 
 // only inner 对外不公开
 namespace rayshape
@@ -33,6 +35,60 @@ namespace rayshape
             return nullptr;
         }
 
+        /**
+         * @brief 检查调用方buffer能否绑定到blob
+         * @param[in] blob backend blob
+         * @param[in] buffer caller buffer, must be host memory and large enough for blob dims
+         * @return ErrorCode RS_SUCCESS if buffer is valid, otherwise error code
+         */
+        static ErrorCode CheckBindBuffer(const Blob *blob, const Buffer *buffer) {
+            if (blob == nullptr || buffer == nullptr || buffer->GetDataPtr() == nullptr) {
+                RS_LOGE("blob:%p or buffer:%p is nullptr\n", blob, buffer);
+                return RS_INVALID_PARAM;
+            }
+            if (buffer->GetMemoryType() != MemoryType::HOST) {
+                RS_LOGE("blob:%s only support binding host buffer\n", blob->name);
+                return RS_INVALID_PARAM_VALUE;
+            }
+
+            RSMemoryInfo mem_info = buffer->GetMemoryInfo();
+            size_t byte_size = buffer->GetDataSize() * GetBytesSize(mem_info.data_type_);
+            size_t need_size = CalculateMemorySize(blob->dims, blob->data_type);
+            if (byte_size < need_size) {
+                RS_LOGE("blob:%s bind buffer size:%zu < need size:%zu\n", blob->name, byte_size,
+                        need_size);
+                return RS_INVALID_PARAM_VALUE;
+            }
+            return RS_SUCCESS;
+        }
+
+        /**
+         * @brief 让blob直接使用调用方的内存,用于Inference::BindInput/BindOutput
+         * @details blob原有buffer被释放,替换为不拥有内存的外部buffer,调用方需保证buffer在绑定期间有效
+         * @param[in] blob backend blob
+         * @param[in] buffer caller buffer, see CheckBindBuffer
+         * @return ErrorCode RS_SUCCESS if bind success, otherwise error code
+         */
+        static ErrorCode BindBlobBuffer(Blob *blob, Buffer *buffer) {
+            ErrorCode ret = CheckBindBuffer(blob, buffer);
+            if (ret != RS_SUCCESS) {
+                return ret;
+            }
+
+            RSMemoryInfo mem_info = buffer->GetMemoryInfo();
+            size_t byte_size = buffer->GetDataSize() * GetBytesSize(mem_info.data_type_);
+            mem_info.data_type_ = blob->data_type;
+            mem_info.size_ = static_cast<unsigned int>(byte_size / GetBytesSize(blob->data_type));
+            Buffer *bind_buffer = Buffer::Create(buffer->GetDataPtr(), mem_info);
+            if (bind_buffer == nullptr) {
+                RS_LOGE("blob:%s create bind buffer failed\n", blob->name);
+                return RS_OUTOFMEMORY;
+            }
+            delete blob->buffer;
+            blob->buffer = bind_buffer;
+            return RS_SUCCESS;
+        }
+
         static std::string GetDataLayoutString(const Dims &dims) {
             std::string layout;
             if (dims.size == 4) {
@@ -3,6 +3,10 @@
 
 #include "model/model.h"
 #include "utils/codec/codec_include.h"
+#include "utils/codec/model_codec.h"
+
+#include <istream>
+#include <ostream>
 
 // Conditionally include and register model types based on compilation flags
 #ifdef ENABLE_MNN_MODEL
@@ -57,6 +61,63 @@ namespace rayshape
     }
 #endif
 
+    /**
+     * @brief 模型扩展段,追加在ModelCodec之后
+     * @details 各模型已有字段的布局保持不变,新增字段只写在扩展段中:
+     * 旧版本打包的.rsm没有扩展段,新增字段按默认值加载;旧版本的加载器读完ModelCodec即停止,不受影响.
+     * 扩展段以格式版本开头,追加字段时递增kModelExtensionVersion并按版本读取.
+     */
+    constexpr std::uint32_t kModelExtensionVersion = 1;
+
+#if defined(ENABLE_OPENVINO_MODEL) || defined(ENABLE_ONNX_MODEL)
+    template <typename Archive> void SerializeModelExtension(Archive &archive, Model &model) {
+#else
+    template <typename Archive> void SerializeModelExtension(Archive &, Model &) {
+#endif
+#ifdef ENABLE_OPENVINO_MODEL
+        if (auto openvino_model = dynamic_cast<OpenVINOModel *>(&model)) {
+            std::uint32_t version = kModelExtensionVersion;
+            archive(version);
+            // version 1: 预编译blob
+            if (version >= 1) {
+                archive(openvino_model->compiled_blob_, openvino_model->compiled_device_,
+                        openvino_model->compiled_version_);
+            }
+            return;
+        }
+#endif
+#ifdef ENABLE_ONNX_MODEL
+        if (auto onnx_model = dynamic_cast<ONNXModel *>(&model)) {
+            std::uint32_t version = kModelExtensionVersion;
+            archive(version);
+            // version 1: 离线优化标记
+            if (version >= 1) {
+                archive(onnx_model->optimized_, onnx_model->optimized_level_,
+                        onnx_model->optimized_version_);
+            }
+            return;
+        }
+#endif
+    }
+
+    inline void ModelCodecSave(std::ostream &stream, ModelCodec &model_codec) {
+        cereal::BinaryOutputArchive archive(stream);
+        archive(model_codec);
+        if (model_codec.model_ != nullptr) {
+            SerializeModelExtension(archive, *model_codec.model_);
+        }
+    }
+
+    inline void ModelCodecLoad(std::istream &stream, ModelCodec &model_codec) {
+        cereal::BinaryInputArchive archive(stream);
+        archive(model_codec);
+        // 旧版本的.rsm到此结束
+        if (model_codec.model_ != nullptr
+            && stream.peek() != std::istream::traits_type::eof()) {
+            SerializeModelExtension(archive, *model_codec.model_);
+        }
+    }
+
 } // namespace rayshape
 
 #endif // _MODEL_SERIALIZE_H_
@@ -56,7 +56,8 @@ namespace rayshape
                 }
             }
             // 默认设置16 的缓冲区,对于流水线边来控制数据包缓冲区的最大容量.
-            abstract_edge_->SetQueueMaxSize(16);
+            abstract_edge_->SetQueueMaxSize(queue_max_size_ > 0 ? queue_max_size_ : 16);
+            abstract_edge_->SetOverflowPolicy(overflow_policy_);
 
             return ret;
         }
@@ -65,6 +66,60 @@ namespace rayshape
             return abstract_edge_->GetParallelType();
         }
 
+        ErrorCode Edge::SetQueueMaxSize(int queue_max_size) {
+            if (queue_max_size <= 0) {
+                RS_LOGE("edge[%s] queue max size:%d must > 0\n", name_.c_str(), queue_max_size);
+                return RS_INVALID_PARAM_VALUE;
+            }
+            queue_max_size_ = queue_max_size;
+            // 只对流水线边有用,其他类型在切换到流水线时生效
+            if (GetParallelType() != PARALLEL_TYPE_PIPELINE) {
+                return RS_SUCCESS;
+            }
+            return abstract_edge_->SetQueueMaxSize(queue_max_size);
+        }
+
+        ErrorCode Edge::SetOverflowPolicy(QueueOverflowPolicy policy) {
+            overflow_policy_ = policy;
+            is_policy_set_ = true;
+            if (GetParallelType() != PARALLEL_TYPE_PIPELINE) {
+                return RS_SUCCESS;
+            }
+            return abstract_edge_->SetOverflowPolicy(policy);
+        }
+
+        ErrorCode Edge::SetDefaultQueue(int queue_max_size, QueueOverflowPolicy policy) {
+            ErrorCode ret = RS_SUCCESS;
+            if (GetParallelType() != PARALLEL_TYPE_PIPELINE) {
+                return ret;
+            }
+            if (queue_max_size_ <= 0) {
+                ret = abstract_edge_->SetQueueMaxSize(queue_max_size);
+                RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "edge SetQueueMaxSize failed!\n");
+            }
+            if (!is_policy_set_) {
+                ret = abstract_edge_->SetOverflowPolicy(policy);
+                RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "edge SetOverflowPolicy failed!\n");
+            }
+            return ret;
+        }
+
+        int64_t Edge::GetDroppedSize() {
+            return abstract_edge_->GetDroppedSize();
+        }
+
+        void Edge::BeginReplicaWrite() {
+            abstract_edge_->BeginReplicaWrite();
+        }
+
+        void Edge::EndReplicaWrite(int slot, bool publish) {
+            abstract_edge_->EndReplicaWrite(slot, publish);
+        }
+
+        ErrorCode Edge::SetRunSlotSize(int slot_size) {
+            return abstract_edge_->SetRunSlotSize(slot_size);
+        }
+
         ErrorCode Edge::Construct() {
             return abstract_edge_->Construct();
         }
@@ -120,6 +175,18 @@ namespace rayshape
             return abstract_edge_->RequestTerminate();
         }
 
+        void Edge::SetEventListener(const EdgeEventFunc &on_data, const EdgeEventFunc &on_space) {
+            abstract_edge_->SetEventListener(on_data, on_space);
+        }
+
+        bool Edge::IsReadable(const Node *node) {
+            return abstract_edge_->IsReadable(node);
+        }
+
+        bool Edge::IsWritable() {
+            return abstract_edge_->IsWritable();
+        }
+
         ErrorCode Edge::IncreaseProducers(std::vector<Node *> &producers) {
             return abstract_edge_->IncreaseProducers(producers);
         }
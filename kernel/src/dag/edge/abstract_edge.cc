@@ -38,12 +38,13 @@ namespace rayshape
             return RS_SUCCESS;
         }
 
-        void AbstractEdge::IncreaseIndex() {
-            if (index_ != INT64_MAX) {
-                index_++;
-            } else {
-                index_ = 0;
-            }
+        int64_t AbstractEdge::IncreaseIndex() {
+            int64_t index = index_.load(std::memory_order_relaxed);
+            int64_t next = 0;
+            do {
+                next = index != INT64_MAX ? index + 1 : 0;
+            } while (!index_.compare_exchange_weak(index, next, std::memory_order_relaxed));
+            return next;
         }
 
         bool AbstractEdge::CheckNode(const Node *node) {
@@ -61,7 +62,7 @@ namespace rayshape
         }
 
         template <typename T>
-        ErrorCode AbstractEdge::SetAny(T *t, bool is_external = true) {
+        ErrorCode AbstractEdge::SetAny(T *t, bool is_external) {
             DataPackage *data_packet = new DataPackage();
             if (data_packet == nullptr) {
                 RS_LOGE("failed to create data packet");
@@ -88,15 +89,17 @@ namespace rayshape
 
         template <typename T>
         T *AbstractEdge::GetAny(const Node *node) {
-            DataPackage *data_packet = this->getDataPackage(node);
+            DataPackage *data_packet = data_pack_;
             if (data_packet == nullptr) {
                 RS_LOGE("Failed to get data packet.\n");
                 return nullptr;
             }
 
             if (parallel_type_ == PARALLEL_TYPE_PIPELINE) {
+                // #TODO
+                return nullptr;
             } else {
-                T *t = data_packet->get<T>();
+                T *t = data_packet->GetAny<T>();
                 if (t == nullptr) {
                     RS_LOGE("Failed to get any.\n");
                     return nullptr;
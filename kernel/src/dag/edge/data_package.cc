@@ -121,7 +121,7 @@ namespace rayshape
         }
 
         template <typename T>
-        ErrorCode DataPackage::SetAny(T *t, bool is_external = true) {
+        ErrorCode DataPackage::SetAny(T *t, bool is_external) {
             ErrorCode ret = RS_SUCCESS;
             if (data_anything_ == nullptr) {
                 data_anything_ = (void *)(t);
@@ -137,7 +137,7 @@ namespace rayshape
             if (data_anything_ == nullptr) {
                 t = new T(std::forward<Args>(args)...);
             } else {
-                destory();
+                Destory();
                 t = new T(std::forward<Args>(args)...);
             }
             if (t == nullptr) {
@@ -244,6 +244,14 @@ namespace rayshape
             return RS_SUCCESS;
         }
 
+        void PipelineDataPackage::Reset() {
+            std::unique_lock<std::mutex> lock(mutex_);
+            Destory();
+            written_ = false;
+            index_ = -1;
+            consumers_count_ = 0;
+        }
+
         void PipelineDataPackage::IncreaseConsumersSize() {
             std::unique_lock<std::mutex> lock(mutex_);
             consumers_size_++;
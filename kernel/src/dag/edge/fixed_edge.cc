@@ -1,4 +1,5 @@
 #include "dag/edge/fixed_edge.h"
+#include "dag/util.h"
 
 namespace rayshape
 {
@@ -7,11 +8,14 @@ namespace rayshape
         TypeEdgeRegister<TypeEdgeCreator<FixedEdge>> g_fixed_edge_register(EDGE_TYPE_FIXED);
 
         FixedEdge::FixedEdge(ParallelType paralle_type) : AbstractEdge(paralle_type) {
-            data_packet_ = new DataPackage();
+            data_packets_.push_back(new DataPackage());
         }
 
         FixedEdge::~FixedEdge() {
-            delete data_packet_;
+            for (auto iter : data_packets_) {
+                delete iter;
+            }
+            data_packets_.clear();
         }
 
         ErrorCode FixedEdge::SetQueueMaxSize(int queue_max_size) {
@@ -19,66 +23,88 @@ namespace rayshape
             return RS_NOT_IMPLEMENT;
         }
 
+        ErrorCode FixedEdge::SetRunSlotSize(int slot_size) {
+            if (slot_size <= 0) {
+                RS_LOGE("run slot size:%d must > 0\n", slot_size);
+                return RS_INVALID_PARAM_VALUE;
+            }
+            // 保留槽位0的数据包,图外部在Init前设置的数据不丢失
+            while ((int)data_packets_.size() > slot_size) {
+                delete data_packets_.back();
+                data_packets_.pop_back();
+            }
+            while ((int)data_packets_.size() < slot_size) {
+                data_packets_.push_back(new DataPackage());
+            }
+            return RS_SUCCESS;
+        }
+
+        DataPackage *&FixedEdge::SlotDataPackage() {
+            int slot = GetRunSlot();
+            if (unlikely(slot < 0 || slot >= (int)data_packets_.size())) {
+                RS_LOGE("run slot:%d out of range:%zu, use slot 0\n", slot, data_packets_.size());
+                slot = 0;
+            }
+            return data_packets_[slot];
+        }
+
         ErrorCode FixedEdge::Construct() {
             return RS_SUCCESS;
         }
 
         ErrorCode FixedEdge::SetBuff(Buffer *buffer, bool is_external) {
-            this->IncreaseIndex();
-            data_packet_->SetIndex(index_);
-            return data_packet_->SetBuff(buffer, is_external);
+            SlotDataPackage()->SetIndex(this->IncreaseIndex());
+            return SlotDataPackage()->SetBuff(buffer, is_external);
         }
         Buffer *FixedEdge::CreateBuff() {
-            this->IncreaseIndex();
-            data_packet_->SetIndex(index_);
+            SlotDataPackage()->SetIndex(this->IncreaseIndex());
             RSMemoryInfo tmp;
-            return data_packet_->CreateBuff(nullptr, tmp);
+            return SlotDataPackage()->CreateBuff(nullptr, tmp);
         }
 
         bool FixedEdge::NotifyWrite(Buffer *buffer) {
-            return data_packet_->NotifyWrite(buffer);
+            return SlotDataPackage()->NotifyWrite(buffer);
         }
 
         Buffer *FixedEdge::GetBuff(const Node *node) {
-            return data_packet_->GetBuff();
+            return SlotDataPackage()->GetBuff();
         }
 
         Buffer *FixedEdge::GetGraphOutputBuffer() {
-            return data_packet_->GetBuff();
+            return SlotDataPackage()->GetBuff();
         }
 
 #ifdef ENABLE_3RD_OPENCV
         ErrorCode FixedEdge::SetMat(cv::Mat *mat, bool is_external) {
-            this->IncreaseIndex();
-            data_packet_->SetIndex(index_);
-            return data_packet_->SetMat(mat, is_external);
+            SlotDataPackage()->SetIndex(this->IncreaseIndex());
+            return SlotDataPackage()->SetMat(mat, is_external);
         }
 
         cv::Mat *FixedEdge::CreateMat(int rows, int cols, int type, const cv::Scalar &value) {
-            this->IncreaseIndex();
-            data_packet_->SetIndex(index_);
-            return data_packet_->CreateMat(rows, cols, type, value);
+            SlotDataPackage()->SetIndex(this->IncreaseIndex());
+            return SlotDataPackage()->CreateMat(rows, cols, type, value);
         }
 
         bool FixedEdge::NotifyWrite(cv::Mat *mat) {
-            return data_packet_->NotifyWrite(mat);
+            return SlotDataPackage()->NotifyWrite(mat);
         }
 
         cv::Mat *FixedEdge::GetMat(const Node *node) {
-            return data_packet_->GetMat();
+            return SlotDataPackage()->GetMat();
         }
 
         cv::Mat *FixedEdge::GetGraphOutputMat() {
-            return data_packet_->GetMat();
+            return SlotDataPackage()->GetMat();
         }
 
 #endif
 
         ErrorCode FixedEdge::TakeDataPackage(DataPackage *data_pack) {
-            if (data_packet_ != nullptr) {
-                delete data_packet_;
+            DataPackage *&slot_package = SlotDataPackage();
+            if (slot_package != nullptr) {
+                delete slot_package;
             }
-            data_packet_ = data_pack;
+            slot_package = data_pack;
             return RS_SUCCESS;
         }
 
@@ -96,7 +122,7 @@ namespace rayshape
         }
 
         int64_t FixedEdge::GetIndex() {
-            return data_pack_->GetIndex();
+            return SlotDataPackage()->GetIndex();
         }
 
     } // namespace dag
@@ -1,12 +1,13 @@
 #include "dag/edge/pipeline_edge.h"
 
 #include "dag/node.h"
+#include "dag/util.h"
 
 namespace rayshape
 {
     namespace dag
     {
-        TypeEdgeRegister<TypeEdgeCreator<PipelineEdge>> g_fixed_edge_register(EDGE_TYPE_PIPELINE);
+        TypeEdgeRegister<TypeEdgeCreator<PipelineEdge>> g_pipeline_edge_register(EDGE_TYPE_PIPELINE);
 
         PipelineEdge::PipelineEdge(ParallelType paralle_type) : AbstractEdge(paralle_type) {
             is_output_edge_ = false;
@@ -14,62 +15,89 @@ namespace rayshape
 
         PipelineEdge::~PipelineEdge() {
             consumers_size_ = 0;
+            ReleaseSlots();
+            ReleaseStages();
+            delete discard_pack_;
+        }
 
-            for (auto iter : data_packets_) {
-                delete iter;
+        ErrorCode PipelineEdge::SetQueueMaxSize(int queue_max_size) {
+            if (queue_max_size <= 0) {
+                RS_LOGE("queue max size:%d must > 0\n", queue_max_size);
+                return RS_INVALID_PARAM_VALUE;
             }
-            data_packets_.clear();
+            queue_max_size_ = queue_max_size;
+            Reconfigure();
 
-            consuming_dp_.clear();
-            to_consume_index_.clear();
+            return RS_SUCCESS;
         }
 
-        ErrorCode PipelineEdge::SetQueueMaxSize(int queue_max_size) {
-            queue_max_size_ = queue_max_size;
+        ErrorCode PipelineEdge::SetOverflowPolicy(QueueOverflowPolicy policy) {
+            if (policy < QUEUE_OVERFLOW_BLOCK || policy > QUEUE_OVERFLOW_KEEP_LATEST) {
+                RS_LOGE("overflow policy:%d is invalid\n", policy);
+                return RS_INVALID_PARAM_VALUE;
+            }
+            overflow_policy_ = policy;
+            Reconfigure();
 
             return RS_SUCCESS;
         }
 
+        int64_t PipelineEdge::GetDroppedSize() {
+            return dropped_size_.load();
+        }
+
         ErrorCode PipelineEdge::Construct() {
             consumers_size_ = static_cast<int>(consumers_.size());
-
-            for (auto iter : consumers_) {
-                if (to_consume_index_.find(iter) == to_consume_index_.end()) {
-                    to_consume_index_.insert({iter, 0});
+            is_output_edge_ = consumers_size_ <= 0;
+
+            int cursor_size = is_output_edge_ ? 1 : consumers_size_;
+            cursors_.reset(new Cursor[cursor_size]);
+            replica_sizes_.assign(cursor_size, 1);
+            replica_holds_.clear();
+            replica_holds_.resize(cursor_size);
+            for (int i = 0; i < consumers_size_; ++i) {
+                int replica_size = consumers_[i]->GetReplicaSize();
+                if (replica_size <= 1) {
+                    continue;
                 }
-                if (consuming_dp_.find(iter) == consuming_dp_.end()) {
-                    consuming_dp_.insert({iter, nullptr});
+                replica_sizes_[i] = replica_size;
+                replica_holds_[i].reset(new std::atomic<int64_t>[replica_size - 1]);
+                for (int slot = 1; slot < replica_size; ++slot) {
+                    HoldSeq(i, slot).store(-1);
                 }
             }
 
-            if (consumers_size_ <= 0) {
-                is_output_edge_ = true;
+            ReleaseStages();
+            if (producers_.size() == 1 && producers_[0]->GetReplicaSize() > 1) {
+                stages_.resize(producers_[0]->GetReplicaSize());
             }
+            reserved_ = 0;
+            write_seq_ = 0;
+            dropped_size_ = 0;
+            last_dropped_ = false;
+            AllocateSlots();
 
             return RS_SUCCESS;
         }
 
         ErrorCode PipelineEdge::SetBuff(Buffer *buffer, bool is_external) {
-            std::unique_lock<std::mutex> lock(mutex_);
-
-            if (std::find(consumers_.begin(), consumers_.end(), nullptr) == consumers_.end()) {
-                queue_cv_.wait(lock, [this]() {
-                    return data_packets_.size() < queue_max_size_ || is_output_edge_;
-                });
+            if (!stages_.empty()) {
+                return StageWrite()->SetBuff(buffer, is_external);
             }
             // 流量控制(协调生产和消费的速度差异),防止内存无限增长,背压控制.
-
-            PipelineDataPackage *data_pack = new PipelineDataPackage(consumers_size_);
-            RS_CHECK_PARAM_NULL_RET_STATUS(data_pack, "PipelineDataPackage is null.\n");
-            this->IncreaseIndex();
-            data_pack->SetIndex(index_);
-
-            data_packets_.push_back(data_pack);
-            cv_.notify_all();
+            bool dropped = false;
+            PipelineDataPackage *data_pack = AcquireSlot(&dropped);
+            if (data_pack == nullptr) {
+                if (!is_external) {
+                    delete buffer;
+                }
+                return dropped ? RS_SUCCESS : RS_DAG_STATU_ERROR;
+            }
 
             ErrorCode ret = data_pack->SetBuff(buffer, is_external);
             RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "data_pack SetBuff error.\n");
 
+            Publish(true);
             return ret;
         }
 
@@ -79,15 +107,36 @@ namespace rayshape
             return nullptr;
         }
 
-        bool PipelineEdge::NotifyWrite(Buffer *buffer) {
-            std::lock_guard<std::mutex> lock(mutex_);
-            bool is_notify = false;
-            for (auto iter = data_packets_.rbegin(); iter != data_packets_.rend(); ++iter) {
-                if ((*iter)->NotifyWrite(buffer)) {
-                    is_notify = true;
-                    break;
+        template <typename T>
+        bool PipelineEdge::NotifyWritten(T *data) {
+            ReplicaStage *stage = CurrentStage();
+            if (stage != nullptr) {
+                // 暂存的数据包在EndReplicaWrite时才通知消费者
+                for (auto data_pack : stage->written_) {
+                    if (data_pack->NotifyWrite(data)) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+            if (last_dropped_) {
+                // 被丢弃的写入不通知消费者
+                return true;
+            }
+            int64_t released = ReleasedSeq();
+            for (int64_t seq = write_seq_.load() - 1; seq >= released; --seq) {
+                if (Slot(seq)->NotifyWrite(data)) {
+                    if (on_data_) {
+                        on_data_();
+                    }
+                    return true;
                 }
             }
+            return false;
+        }
+
+        bool PipelineEdge::NotifyWrite(Buffer *buffer) {
+            bool is_notify = NotifyWritten(buffer);
             if (!is_notify) {
                 RS_LOGE("This buffer[%p] is error.\n", buffer);
             }
@@ -95,99 +144,97 @@ namespace rayshape
         }
 
         Buffer *PipelineEdge::GetBuff(const Node *node) {
-            PipelineDataPackage *data_pack = GetPipelineDataPacket(node);
-            if (data_pack == nullptr) {
-                RS_LOGE("GetPipelineDataPacket error.\n");
-                return nullptr;
+            int cursor = FindCursor(node);
+            if (cursor >= 0) {
+                int64_t seq = HoldSeq(cursor, ReplicaSlot(cursor)).load(std::memory_order_relaxed);
+                if (seq < 0) {
+                    RS_LOGE("node[%s] has not updated this edge.\n", node->GetName().c_str());
+                    return nullptr;
+                }
+                return Slot(seq)->GetBuff();
             }
-
-            Node *tmp_node = const_cast<Node *>(node);
-            if (consuming_dp_.find(tmp_node) != consuming_dp_.end()) {
-                return data_pack->GetBuff();
-            } else {
-                return data_pack->GetBufferDirect();
+            if (std::find(producers_.begin(), producers_.end(), node) != producers_.end()) {
+                ReplicaStage *stage = CurrentStage();
+                if (stage != nullptr) {
+                    return stage->written_.empty() ? nullptr
+                                                   : stage->written_.back()->GetBufferDirect();
+                }
+                int64_t seq = write_seq_.load(std::memory_order_relaxed) - 1;
+                return seq >= 0 && !last_dropped_ ? Slot(seq)->GetBufferDirect() : nullptr;
             }
+            RS_LOGE("GetPipelineDataPacket error.\n");
+            return nullptr;
         }
 
         Buffer *PipelineEdge::GetGraphOutputBuffer() {
-            PipelineDataPackage *dp = nullptr;
             if (is_output_edge_ != true) {
                 RS_LOGE("This edge is not graph output edge.\n");
                 return nullptr;
             }
-            Buffer *return_buffer = nullptr;
-
-            if (data_packets_.size() > 0) {
-                if (last_data_packet_ != nullptr) {
-                    delete (last_data_packet_);
-                }
-                auto iter = data_packets_.begin();
-                dp = (*iter);
-                return_buffer = dp->GetBuff();
-                data_packets_.erase(iter);
-
-                last_data_packet_ = *iter;
+            // 上一次取走的数据包保留到这次调用
+            std::lock_guard<std::mutex> lock(mutex_);
+            int64_t seq = cursors_[0].read_seq_.load();
+            if (seq >= write_seq_.load()) {
+                return nullptr;
             }
+            Buffer *return_buffer = Slot(seq)->GetBuff();
+            cursors_[0].hold_seq_ = seq;
+            cursors_[0].read_seq_ = seq + 1;
 
             return return_buffer;
         }
 
 #ifdef ENABLE_3RD_OPENCV
         ErrorCode PipelineEdge::SetMat(cv::Mat *mat, bool is_external) {
-            std::unique_lock<std::mutex> lock(mutex_);
-
-            if (std::find(consumers_.begin(), consumers_.end(), nullptr) == consumers_.end()) {
-                queue_cv_.wait(lock, [this]() { return data_packets_.size() < queue_max_size_; });
+            if (!stages_.empty()) {
+                return StageWrite()->SetMat(mat, is_external);
+            }
+            bool dropped = false;
+            PipelineDataPackage *data_pack = AcquireSlot(&dropped);
+            if (data_pack == nullptr) {
+                if (!is_external) {
+                    delete mat;
+                }
+                return dropped ? RS_SUCCESS : RS_DAG_STATU_ERROR;
             }
-
-            PipelineDataPackage *data_pack = new PipelineDataPackage(consumers_size_);
-            RS_CHECK_PARAM_NULL_RET_STATUS(data_pack, "PipelineDataPackage is null.\n");
-            this->IncreaseIndex();       // index++
-            data_pack->SetIndex(index_); // set index.
-
-            data_packets_.push_back(data_pack);
-            cv_.notify_all();
 
             ErrorCode ret = data_pack->SetMat(mat, is_external);
             RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "PipelineDataPackage set error.\n");
 
+            Publish(true);
             return ret;
         }
 
         cv::Mat *PipelineEdge::CreateMat(int rows, int cols, int type, const cv::Scalar &value) {
-            std::unique_lock<std::mutex> lock(mutex_);
-            if (std::find(consumers_.begin(), consumers_.end(), nullptr) == consumers_.end()) {
-                queue_cv_.wait(lock, [this]() { return data_packets_.size() < queue_max_size_; });
+            if (!stages_.empty()) {
+                return StageWrite()->CreateMat(rows, cols, type, value);
             }
-
-            PipelineDataPackage *data_pack = new PipelineDataPackage(consumers_size_);
+            bool dropped = false;
+            PipelineDataPackage *data_pack = AcquireSlot(&dropped);
             if (data_pack == nullptr) {
-                RS_LOGE("PipelineDataPackage is null.\n");
-                return nullptr;
+                if (!dropped) {
+                    return nullptr;
+                }
+                // 被丢弃的写入仍要给生产者一个可写的Mat
+                if (discard_pack_ == nullptr) {
+                    discard_pack_ = new PipelineDataPackage(0);
+                }
+                discard_pack_->Reset();
+                return discard_pack_->CreateMat(rows, cols, type, value);
             }
 
-            this->IncreaseIndex();
-            data_pack->SetIndex(index_);
-            data_packets_.push_back(data_pack);
-            cv_.notify_all();
-
             cv::Mat *ret_mat = data_pack->CreateMat(rows, cols, type, value);
             if (ret_mat == nullptr) {
                 RS_LOGE("data_pack CreateMat is null.\n");
                 return nullptr;
             }
+            // 数据包在NotifyWrite时才通知消费者
+            Publish(false);
             return ret_mat;
         }
 
         bool PipelineEdge::NotifyWrite(cv::Mat *mat) {
-            std::lock_guard<std::mutex> lock(mutex_);
-            bool is_notify = false;
-            for (auto iter = data_packets_.rbegin(); iter != data_packets_.rend(); ++iter) {
-                if ((*iter)->NotifyWrite(mat)) {
-                    is_notify = true;
-                    break;
-                }
-            }
+            bool is_notify = NotifyWritten(mat);
             if (!is_notify) {
                 RS_LOGE("This mat[%p] is error.\n", mat);
             }
@@ -195,150 +242,423 @@ namespace rayshape
         }
 
         cv::Mat *PipelineEdge::GetMat(const Node *node) {
-            PipelineDataPackage *data_pack = GetPipelineDataPacket(node);
-            if (data_pack == nullptr) {
-                RS_LOGE("GetPipelineDataPacket error.\n");
-                return nullptr;
+            int cursor = FindCursor(node);
+            if (cursor >= 0) {
+                int64_t seq = HoldSeq(cursor, ReplicaSlot(cursor)).load(std::memory_order_relaxed);
+                if (seq < 0) {
+                    RS_LOGE("node[%s] has not updated this edge.\n", node->GetName().c_str());
+                    return nullptr;
+                }
+                return Slot(seq)->GetMat();
             }
-            Node *tmp_node = const_cast<Node *>(node);
-            if (consuming_dp_.find(tmp_node) != consuming_dp_.end()) {
-                return data_pack->GetMat();
-            } else {
-                return data_pack->GetMatDirect();
+            if (std::find(producers_.begin(), producers_.end(), node) != producers_.end()) {
+                ReplicaStage *stage = CurrentStage();
+                if (stage != nullptr) {
+                    return stage->written_.empty() ? nullptr
+                                                   : stage->written_.back()->GetMatDirect();
+                }
+                if (last_dropped_) {
+                    return discard_pack_ != nullptr ? discard_pack_->GetMatDirect() : nullptr;
+                }
+                int64_t seq = write_seq_.load(std::memory_order_relaxed) - 1;
+                return seq >= 0 ? Slot(seq)->GetMatDirect() : nullptr;
             }
+            RS_LOGE("GetPipelineDataPacket error.\n");
+            return nullptr;
         }
 
         cv::Mat *PipelineEdge::GetGraphOutputMat() {
-            PipelineDataPackage *data_pack = nullptr;
-            EdgeUpdateFlag update_flag = Update(nullptr);
-            if (update_flag == EdgeUpdateFlag::Terminate) {
-                RS_LOGI("User voluntarily terminates.\n");
-            } else if (update_flag == EdgeUpdateFlag::Error) {
-                RS_LOGI("getGraphOutput update error.\n");
-            } else {
-                data_pack = GetPipelineDataPacket(nullptr);
-            }
-            if (data_pack == nullptr) {
+            if (is_output_edge_ != true) {
                 RS_LOGE("PipelineDataPacket is null, this edge is not output edge.\n");
                 return nullptr;
             }
+            std::lock_guard<std::mutex> lock(mutex_);
+            int64_t seq = cursors_[0].read_seq_.load();
+            if (seq >= write_seq_.load()) {
+                return nullptr;
+            }
+            cv::Mat *return_mat = Slot(seq)->GetMat();
+            cursors_[0].hold_seq_ = seq;
+            cursors_[0].read_seq_ = seq + 1;
 
-            return data_pack->GetMat();
+            return return_mat;
         }
 
 #endif
         ErrorCode PipelineEdge::TakeDataPackage(DataPackage *data_pack) {
-            std::unique_lock<std::mutex> lock(mutex_);
-            if (std::find(consumers_.begin(), consumers_.end(), nullptr) == consumers_.end()) {
-                queue_cv_.wait(lock, [this]() { return data_packets_.size() < queue_max_size_; });
+            if (!stages_.empty()) {
+                return StageWrite()->TakeDataPackage(data_pack);
+            }
+            bool dropped = false;
+            PipelineDataPackage *dp = AcquireSlot(&dropped);
+            if (dp == nullptr) {
+                return dropped ? RS_SUCCESS : RS_DAG_STATU_ERROR;
             }
-            PipelineDataPackage *dp = new PipelineDataPackage(consumers_size_);
-            RS_CHECK_PARAM_NULL_RET_STATUS(dp, "PipelineDataPackage is null.\n");
-
-            data_packets_.push_back(dp);
-            cv_.notify_all();
 
             ErrorCode ret = dp->TakeDataPackage(data_pack);
             RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "PipelineDataPackage take error.\n");
 
+            Publish(true);
             return ret;
         }
 
         EdgeUpdateFlag PipelineEdge::Update(const Node *node) {
-            Node *tmp_node = const_cast<Node *>(node);
-            if (!CheckNode(tmp_node)) {
-                RS_LOGE("This node is error.\n");
+            int cursor_index = FindCursor(node);
+            if (cursor_index < 0) {
+                CheckNode(node);
                 return EdgeUpdateFlag::Error;
             }
 
-            std::unique_lock<std::mutex> lock(mutex_);
-            cv_.wait(lock, [this, tmp_node] {
-                return to_consume_index_[tmp_node] < data_packets_.size() || terminate_flag_;
-            });
-
-            if (terminate_flag_) {
-                return EdgeUpdateFlag::Terminate;
-            }
-            // 找消费包
-            PipelineDataPackage *dp = nullptr;
-            int index = to_consume_index_[tmp_node]; // 找到消费节点的消费包索引
-            int count = 0;                           // 消费者节点计数
-            auto iter = data_packets_.begin();       // 消费包列表
-                                                     // 遍历list找消费包
-            for (int i = 0; i < index; i++) {
-                if ((*iter)->GetConsumersCount() == consumers_size_) {
-                    count++;
-                }
-                iter++;
-            }
-
-            dp = (*iter);
-            dp->IncreaseConsumersCount();
-            consuming_dp_[tmp_node] = dp;
-
-            // update
-            int real_count = 0;
-            iter = data_packets_.begin();
-            for (int i = 0; i < count; i++) {
-                bool delete_flag = true;
-                // 消费者操作是并发的，可能有一个消费者正在使用此数据包
-                for (auto consuming_dp : consuming_dp_) {
-                    if (consuming_dp.second == *iter) {
-                        delete_flag = false; // 迭代需要删掉的数据包中是否还有消费者正在使用的
-                        break;
-                    }
-                }
-                if (delete_flag) {
-                    delete (*iter); // 删掉数据包obj
-                    iter++;         // 迭代下一个数据包
-                    real_count++;   // 标记为可删除pipe包都是顺序的
-                } else {
-                    break;
-                }
+            Cursor &cursor = cursors_[cursor_index];
+            std::unique_lock<std::mutex> lock(mutex_, std::defer_lock);
+            if (IsDropOldest()) {
+                // 生产者会推进读序号,要在锁内取
+                lock.lock();
             }
-
-            // destory no use data package.
-            if (real_count > 0) {
-                data_packets_.erase(data_packets_.begin(), iter);
-                for (auto &iter : to_consume_index_) {
-                    iter.second -= real_count;
+            int64_t seq = cursor.read_seq_.load();
+            if (write_seq_.load() <= seq) {
+                // 环空,休眠到生产者发布或终止
+                if (!lock.owns_lock()) {
+                    lock.lock();
                 }
-
-                if (data_packets_.size() + real_count >= queue_max_size_
-                    && data_packets_.size() < queue_max_size_) {
-                    queue_cv_.notify_all();
+                data_waiters_++;
+                data_cv_.wait(lock, [this, &cursor]() {
+                    return write_seq_.load() > cursor.read_seq_.load() || terminated_;
+                });
+                data_waiters_--;
+                seq = cursor.read_seq_.load();
+                if (write_seq_.load() <= seq) {
+                    return EdgeUpdateFlag::Terminate;
                 }
             }
 
             // 消费下一个数据包
-            to_consume_index_[tmp_node]++;
+            Slot(seq)->IncreaseConsumersCount();
+            // 先持有再推进读序号,生产者先读读序号,不会把seq当成已释放
+            HoldSeq(cursor_index, ReplicaSlot(cursor_index)).store(seq);
+            cursor.read_seq_.store(seq + 1);
+            if (lock.owns_lock()) {
+                lock.unlock();
+            }
+            AfterConsume(seq);
             return EdgeUpdateFlag::Complete;
         }
 
         bool PipelineEdge::RequestTerminate() {
             std::unique_lock<std::mutex> lock(mutex_);
             terminate_flag_ = true;
-            cv_.notify_all();
+            terminated_ = true;
+            data_cv_.notify_all();
+            space_cv_.notify_all(); // 终止后不再背压,唤醒阻塞的生产者
             return true;
         }
 
-        PipelineDataPackage *PipelineEdge::GetPipelineDataPacket(const Node *node) {
-            Node *tmp_node = const_cast<Node *>(node);
-            if (consuming_dp_.find(tmp_node) != consuming_dp_.end()) {
-                auto iter = consuming_dp_.find(tmp_node);
-                if (iter->second == nullptr) {
-                    RS_LOGE("node[%s] is error!\n", tmp_node->GetName().c_str());
+        void PipelineEdge::SetEventListener(const EdgeEventFunc &on_data,
+                                            const EdgeEventFunc &on_space) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            on_data_ = on_data;
+            on_space_ = on_space;
+        }
+
+        bool PipelineEdge::IsReadable(const Node *node) {
+            int cursor = FindCursor(node);
+            if (cursor < 0) {
+                return false;
+            }
+            return cursors_[cursor].read_seq_.load() < write_seq_.load();
+        }
+
+        bool PipelineEdge::IsWritable() {
+            return overflow_policy_ != QUEUE_OVERFLOW_BLOCK || is_output_edge_ || HasSpace();
+        }
+
+        void PipelineEdge::BeginReplicaWrite() {
+            if (IsReserving()) {
+                reserved_++;
+            }
+        }
+
+        void PipelineEdge::EndReplicaWrite(int slot, bool publish) {
+            if (slot < 0 || slot >= (int)stages_.size()) {
+                return;
+            }
+            ReplicaStage &stage = stages_[slot];
+            bool reserved = IsReserving();
+            for (auto staged : stage.written_) {
+                PipelineDataPackage *data_pack = nullptr;
+                if (!publish) {
+                    stage.spare_.push_back(staged);
+                    continue;
+                }
+                if (reserved) {
+                    data_pack = NextSlot(); // 派发时预留过位置,不会阻塞
+                } else {
+                    bool dropped = false;
+                    data_pack = AcquireSlot(&dropped);
+                }
+                if (data_pack == nullptr) {
+                    stage.spare_.push_back(staged);
+                    continue;
+                }
+                // 暂存的数据包换入环中,换出的空数据包留给副本下次写入
+                staged->SetIndex(data_pack->GetIndex());
+                slots_[write_seq_.load(std::memory_order_relaxed) % capacity_] = staged;
+                stage.spare_.push_back(data_pack);
+                Publish(true);
+                if (reserved) {
+                    // 发布后再释放预留,HasSpace只会多算不会少算
+                    reserved_--;
+                    reserved = false;
+                }
+            }
+            stage.written_.clear();
+            if (reserved) {
+                reserved_--;
+            }
+        }
+
+        void PipelineEdge::AllocateSlots() {
+            ReleaseSlots();
+            capacity_ = IsDropOldest() ? 2 * PendingLimit() + 1 : queue_max_size_ + 1;
+            slots_.resize(capacity_);
+            for (auto &slot : slots_) {
+                slot = new PipelineDataPackage(consumers_size_);
+            }
+        }
+
+        void PipelineEdge::Reconfigure() {
+            if (slots_.empty()) {
+                return; // 还没有构建,Construct时分配
+            }
+            if (write_seq_.load() > 0) {
+                RS_LOGD("edge already has data, queue config takes effect on next construct\n");
+                return;
+            }
+            AllocateSlots();
+        }
+
+        void PipelineEdge::ReleaseStages() {
+            for (auto &stage : stages_) {
+                for (auto data_pack : stage.written_) {
+                    delete data_pack;
+                }
+                for (auto data_pack : stage.spare_) {
+                    delete data_pack;
+                }
+            }
+            stages_.clear();
+        }
+
+        void PipelineEdge::ReleaseSlots() {
+            for (auto slot : slots_) {
+                delete slot;
+            }
+            slots_.clear();
+            capacity_ = 0;
+        }
+
+        void PipelineEdge::Grow() {
+            int64_t capacity = capacity_ * 2;
+            std::vector<PipelineDataPackage *> slots(capacity, nullptr);
+            // 未释放的数据包按序号搬到新位置,其余位置复用空闲的旧槽位
+            int64_t write_seq = write_seq_.load();
+            for (int64_t seq = ReleasedSeq(); seq < write_seq; ++seq) {
+                slots[seq % capacity] = Slot(seq);
+                slots_[seq % capacity_] = nullptr;
+            }
+            size_t index = 0;
+            for (auto &slot : slots) {
+                while (slot == nullptr && index < slots_.size()) {
+                    slot = slots_[index++];
+                }
+                if (slot == nullptr) {
+                    slot = new PipelineDataPackage(consumers_size_);
+                }
+            }
+            slots_.swap(slots);
+            capacity_ = capacity;
+            RS_LOGD("graph output edge grow to %lld slots\n", (long long)capacity_);
+        }
+
+        int PipelineEdge::FindCursor(const Node *node) {
+            for (int i = 0; i < consumers_size_; ++i) {
+                if (consumers_[i] == node) {
+                    return i;
+                }
+            }
+            return -1;
+        }
+
+        int PipelineEdge::ReplicaSlot(int cursor) {
+            int slot = GetRunSlot();
+            return slot > 0 && slot < replica_sizes_[cursor] ? slot : 0;
+        }
+
+        int64_t PipelineEdge::CursorReleased(int cursor) {
+            // 消费者还持有刚取走的数据包,还没取过时从读序号算起;先读读序号,与Update的写入顺序相反
+            int64_t released = cursors_[cursor].read_seq_.load();
+            for (int slot = 0; slot < replica_sizes_[cursor]; ++slot) {
+                int64_t hold_seq = HoldSeq(cursor, slot).load();
+                if (hold_seq >= 0) {
+                    released = std::min(released, hold_seq);
+                }
+            }
+            return released;
+        }
+
+        bool PipelineEdge::IsHeld(int64_t seq) {
+            int cursor_size = is_output_edge_ ? 1 : consumers_size_;
+            for (int i = 0; i < cursor_size; ++i) {
+                for (int slot = 0; slot < replica_sizes_[i]; ++slot) {
+                    if (HoldSeq(i, slot).load() == seq) {
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+
+        int64_t PipelineEdge::ReleasedSeq() {
+            int64_t released = write_seq_.load();
+            int cursor_size = is_output_edge_ ? 1 : consumers_size_;
+            for (int i = 0; i < cursor_size; ++i) {
+                released = std::min(released, CursorReleased(i));
+            }
+            return released;
+        }
+
+        bool PipelineEdge::HasSpace() {
+            // 多副本生产者已派发的运行各预留一个位置
+            return write_seq_.load(std::memory_order_relaxed) - ReleasedSeq() + reserved_.load()
+                   < capacity_;
+        }
+
+        PipelineDataPackage *PipelineEdge::AcquireSlot(bool *dropped) {
+            *dropped = false;
+            if (overflow_policy_ != QUEUE_OVERFLOW_BLOCK) {
+                // 不阻塞生产者,写不下时丢数据
+                std::lock_guard<std::mutex> lock(mutex_);
+                bool has_space = IsDropOldest() ? DropForWrite() : HasSpace();
+                if (!has_space) {
+                    dropped_size_++;
+                    last_dropped_ = true;
+                    *dropped = true;
                     return nullptr;
                 }
-                return iter->second;
-            } else if (std::find(producers_.begin(), producers_.end(), tmp_node)
-                       != producers_.end()) {
-                return data_packets_.back();
+            } else if (is_output_edge_) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!HasSpace()) {
+                    Grow();
+                }
+            } else if (!HasSpace()) {
+                // 环满,休眠到消费者释放槽位或终止
+                std::unique_lock<std::mutex> lock(mutex_);
+                space_waiters_++;
+                space_cv_.wait(lock, [this]() { return HasSpace() || terminated_; });
+                space_waiters_--;
+                if (!HasSpace()) {
+                    RS_LOGW("edge is terminated and full, drop data\n");
+                    return nullptr;
+                }
+            }
+
+            return NextSlot();
+        }
+
+        PipelineDataPackage *PipelineEdge::NextSlot() {
+            last_dropped_ = false;
+            PipelineDataPackage *data_pack = Slot(write_seq_.load(std::memory_order_relaxed));
+            data_pack->Reset();
+            data_pack->SetIndex(this->IncreaseIndex());
+            return data_pack;
+        }
+
+        PipelineDataPackage *PipelineEdge::StageWrite() {
+            ReplicaStage *stage = CurrentStage();
+            PipelineDataPackage *data_pack = nullptr;
+            if (stage->spare_.empty()) {
+                data_pack = new PipelineDataPackage(consumers_size_);
             } else {
-                RS_LOGE("node[%s] is error!\n", tmp_node->GetName().c_str());
+                data_pack = stage->spare_.back();
+                stage->spare_.pop_back();
+            }
+            data_pack->Reset();
+            stage->written_.push_back(data_pack);
+            return data_pack;
+        }
+
+        PipelineEdge::ReplicaStage *PipelineEdge::CurrentStage() {
+            if (stages_.empty()) {
                 return nullptr;
             }
+            int slot = GetRunSlot();
+            if (unlikely(slot < 0 || slot >= (int)stages_.size())) {
+                RS_LOGE("run slot:%d out of replica range:%zu, use slot 0\n", slot, stages_.size());
+                slot = 0;
+            }
+            return &stages_[slot];
+        }
+
+        bool PipelineEdge::DropForWrite() {
+            int64_t limit = PendingLimit();
+            int64_t write_seq = write_seq_.load();
+            int cursor_size = is_output_edge_ ? 1 : consumers_size_;
+            int64_t dropped = 0;
+            for (int i = 0; i < cursor_size; ++i) {
+                // 写入后每个消费者最多留limit个未消费的数据包,多出的最旧的跳过
+                int64_t read_seq = cursors_[i].read_seq_.load();
+                if (write_seq - read_seq >= limit) {
+                    dropped = std::max(dropped, write_seq - limit + 1 - read_seq);
+                    cursors_[i].read_seq_.store(write_seq - limit + 1);
+                }
+            }
+            dropped_size_ += dropped;
+            if (HasSpace()) {
+                return true;
+            }
+
+            // 消费者持有旧数据包太久,环满:新数据替换最新的未消费数据包,被持有时丢掉新数据
+            if (IsHeld(write_seq - 1)) {
+                return false;
+            }
+            write_seq_.store(write_seq - 1);
+            bool lost = false; // 是否有消费者还没跳过被替换的数据包
+            for (int i = 0; i < cursor_size; ++i) {
+                if (cursors_[i].read_seq_.load() > write_seq - 1) {
+                    cursors_[i].read_seq_.store(write_seq - 1);
+                } else {
+                    lost = true;
+                }
+            }
+            if (lost) {
+                dropped_size_++;
+            }
+            return true;
+        }
+
+        void PipelineEdge::Publish(bool notify) {
+            write_seq_.fetch_add(1);
+            if (data_waiters_.load() > 0) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                data_cv_.notify_all();
+            }
+            if (notify && on_data_) {
+                on_data_();
+            }
+        }
+
+        void PipelineEdge::AfterConsume(int64_t seq) {
+            if (seq <= 0) {
+                return;
+            }
+            if (space_waiters_.load() > 0) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                space_cv_.notify_all();
+            }
+            if (on_space_) {
+                on_space_();
+            }
         }
 
     } // namespace dag
-} // namespace rayshape
\ No newline at end of file
+} // namespace rayshape
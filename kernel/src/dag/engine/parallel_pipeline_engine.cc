@@ -5,10 +5,34 @@ namespace rayshape
 {
     namespace dag
     {
+        namespace
+        {
+            // 所有流水线图共享的线程池,线程数按硬件并发数限定,进程退出时回收
+            class SharedThreadPool {
+            public:
+                SharedThreadPool() {
+                    unsigned int size = std::thread::hardware_concurrency();
+                    thread_pool_ = new threadpool::ThreadPool(size > 0 ? size : 4);
+                    thread_pool_->Init();
+                }
+
+                ~SharedThreadPool() {
+                    thread_pool_->DeInit();
+                    delete thread_pool_;
+                }
+
+                threadpool::ThreadPool *thread_pool_ = nullptr;
+            };
+
+            threadpool::ThreadPool *GetSharedThreadPool() {
+                static SharedThreadPool shared_thread_pool;
+                return shared_thread_pool.thread_pool_;
+            }
+        } // namespace
+
         ParallelPipelineEngine::ParallelPipelineEngine() : ExecuteEngine() {
             thread_pool_ = nullptr;
             run_size_ = 0;
-            completed_size_ = 0;
         }
 
         ParallelPipelineEngine::~ParallelPipelineEngine() {}
@@ -16,6 +40,7 @@ namespace rayshape
         ErrorCode ParallelPipelineEngine::Init(std::vector<EdgeWrapper *> &edge_repository,
                                                std::vector<NodeWrapper *> &node_repository) {
             ErrorCode ret = TopoSortDFS(node_repository, topo_sort_node_);
+            RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "topo sort failed\n");
 
             for (auto iter : topo_sort_node_) {
                 iter->color_ = NODE_COLOR_WHITE;
@@ -30,11 +55,63 @@ namespace rayshape
             all_task_count_ = static_cast<int>(topo_sort_node_.size());
             edge_repository_ = edge_repository;
 
-            thread_pool_ = new threadpool::ThreadPool(all_task_count_);
-            ret = thread_pool_->Init();
-            RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "ThreadPool init failure\n");
+            std::map<Node *, int> node_index;
+            tasks_.reset(new NodeTask[all_task_count_]);
+            source_nodes_.clear();
+            for (int i = 0; i < all_task_count_; ++i) {
+                NodeTask &task = tasks_[i];
+                task.node_ = topo_sort_node_[i]->node_;
+                task.inputs_ = task.node_->GetAllInput();
+                task.outputs_ = task.node_->GetAllOutput();
+                if (task.inputs_.empty()) {
+                    source_nodes_.push_back(i);
+                }
+                task.replica_size_ = task.node_->GetReplicaSize();
+                if (task.replica_size_ > 1) {
+                    // 先派发副本0
+                    for (int slot = task.replica_size_ - 1; slot >= 0; --slot) {
+                        task.idle_slots_.push_back(slot);
+                    }
+                    task.done_slots_.assign(task.replica_size_, -1);
+                    task.done_success_.assign(task.replica_size_, false);
+                }
+                node_index[task.node_] = i;
+            }
+
+            // 边上有新数据时检查消费者,腾出空位时检查生产者
+            for (auto edge_wrapper : edge_repository_) {
+                std::vector<int> consumers;
+                std::vector<int> producers;
+                for (auto consumer : edge_wrapper->consumers_) {
+                    auto iter = node_index.find(consumer->node_);
+                    if (iter != node_index.end()) {
+                        consumers.push_back(iter->second);
+                    }
+                }
+                for (auto producer : edge_wrapper->producers_) {
+                    auto iter = node_index.find(producer->node_);
+                    if (iter != node_index.end()) {
+                        producers.push_back(iter->second);
+                    }
+                }
+                edge_wrapper->edge_->SetEventListener(
+                    [this, consumers]() {
+                        for (int index : consumers) {
+                            TrySchedule(index);
+                        }
+                    },
+                    [this, producers]() {
+                        for (int index : producers) {
+                            TrySchedule(index);
+                        }
+                    });
+            }
 
-            this->CommitThreadPool();
+            thread_pool_ = GetSharedThreadPool();
+            stop_flag_ = false;
+            status_ = RS_SUCCESS;
+            RS_LOGD("pipeline engine schedule %d nodes on %u shared threads\n", all_task_count_,
+                    thread_pool_->GetThreadSize());
             return RS_SUCCESS;
         }
 
@@ -44,16 +121,16 @@ namespace rayshape
                 this->Synchronize();
             }
 
+            Stop();
+            {
+                // 等线程池上本引擎的任务全部结束
+                std::unique_lock<std::mutex> lock(mutex_);
+                pipeline_cv_.wait(lock, [this]() { return in_flight_ == 0; });
+            }
             for (auto iter : edge_repository_) {
-                bool flag = iter->edge_->RequestTerminate();
-                if (!flag) {
-                    RS_LOGE("failed iter edge requestTerminate()!\n");
-                    return RS_UNKNOWN;
-                }
+                iter->edge_->SetEventListener(nullptr, nullptr);
             }
-            ret = thread_pool_->DeInit();
-            RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "thread_pool_ DeInit failure\n");
-            delete thread_pool_;
+            thread_pool_ = nullptr;
 
             for (auto iter : topo_sort_node_) {
                 ret = iter->node_->Deinit();
@@ -68,7 +145,16 @@ namespace rayshape
         }
 
         ErrorCode ParallelPipelineEngine::Run() {
+            if (status_ != RS_SUCCESS) {
+                RS_LOGE("pipeline stopped by node failure:%d\n", status_.load());
+                return status_;
+            }
             run_size_++;
+            is_synchronize_ = false;
+            // 其余节点由边上的数据驱动
+            for (int index : source_nodes_) {
+                TrySchedule(index);
+            }
             return RS_SUCCESS;
         }
 
@@ -76,17 +162,19 @@ namespace rayshape
             std::unique_lock<std::mutex> lock(mutex_);
 
             pipeline_cv_.wait(lock, [this]() {
-                bool flag = false;
+                // 出错后下游收不到失败的那一帧,等已提交的任务结束即可
+                if (status_ != RS_SUCCESS) {
+                    return in_flight_ == 0;
+                }
+                bool completed = true;
                 for (auto iter : topo_sort_node_) {
                     // check node run completed size.
                     if (iter->node_->GetRunCompletedSize() < run_size_) {
-                        flag = false;
+                        completed = false;
                         break;
                     }
-                    completed_size_ = run_size_;
-                    flag = true;
                 }
-                return flag;
+                return completed || (in_flight_ == 0 && IsDrained());
             });
 
             for (auto iter : topo_sort_node_) {
@@ -95,44 +183,293 @@ namespace rayshape
                 }
             }
 
-            is_synchronize_ = completed_size_ == run_size_;
+            is_synchronize_ = status_ == RS_SUCCESS;
 
             return is_synchronize_;
         }
+
+        bool ParallelPipelineEngine::IsReady(NodeTask &task) {
+            if (stop_flag_) {
+                return false;
+            }
+            if (task.inputs_.empty() && task.launched_ >= run_size_) {
+                return false;
+            }
+            for (auto input : task.inputs_) {
+                if (!input->IsReadable(task.node_)) {
+                    return false;
+                }
+            }
+            for (auto output : task.outputs_) {
+                if (!output->IsWritable()) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        bool ParallelPipelineEngine::IsDrained() {
+            for (int i = 0; i < all_task_count_; ++i) {
+                NodeTask &task = tasks_[i];
+                if (task.inputs_.empty()) {
+                    if (task.launched_ < run_size_) {
+                        return false;
+                    }
+                    continue;
+                }
+                bool readable = true;
+                for (auto input : task.inputs_) {
+                    if (!input->IsReadable(task.node_)) {
+                        readable = false;
+                        break;
+                    }
+                }
+                if (readable) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        void ParallelPipelineEngine::TrySchedule(int index) {
+            NodeTask &task = tasks_[index];
+            if (task.replica_size_ > 1) {
+                DispatchReplicas(index);
+                return;
+            }
+            while (true) {
+                bool expected = false;
+                // 节点已有任务,该任务结束时会重新检查
+                if (!task.scheduled_.compare_exchange_strong(expected, true)) {
+                    return;
+                }
+                if (IsReady(task)) {
+                    in_flight_++;
+                    thread_pool_->Commit([this, index]() { Process(index); });
+                    return;
+                }
+                task.scheduled_ = false;
+                // 检查和清标记之间到达的事件会因为标记被占而返回,这里再查一次
+                if (!IsReady(task)) {
+                    return;
+                }
+            }
+        }
+
         // 流水线模式：通过输入边的状态驱动节点执行，形成流水线效果
-        void ParallelPipelineEngine::CommitThreadPool() {
-            for (auto iter : topo_sort_node_) {
-                auto func = [iter, this]() -> ErrorCode {
-                    ErrorCode ret_status = RS_SUCCESS;
-
-                    while (true) {
-                        EdgeUpdateFlag edge_update_flag = iter->node_->UpdateInput();
-
-                        if (edge_update_flag == EdgeUpdateFlag::Complete) {
-                            iter->node_->SetRunningFlag(true);
-                            ret_status = iter->node_->Run();
-                            RS_RETURN_ON_NEQ(ret_status, RS_SUCCESS, "node execute failed!\n");
-                            iter->node_->SetRunningFlag(false);
-
-                            if (iter->node_->GetRunCompletedSize() == run_size_) {
-                                pipeline_cv_.notify_all();
-                            }
-                        } else if (edge_update_flag == EdgeUpdateFlag::Terminate) {
-                            RS_LOGI("node [%s] UpdateInput terminate!\n",
-                                    iter->node_->GetName().c_str());
-                            break;
-                        } else {
-                            RS_LOGE("failed to node [%s] UpdateInput()!\n",
-                                    iter->node_->GetName().c_str());
-                            ret_status = RS_UNKNOWN;
-                            break;
+        void ParallelPipelineEngine::Process(int index) {
+            NodeTask &task = tasks_[index];
+            Node *node = task.node_;
+            ErrorCode ret = RS_SUCCESS;
+
+            EdgeUpdateFlag edge_update_flag = EdgeUpdateFlag::Complete;
+            for (auto input : task.inputs_) {
+                // 输入已就绪,不会阻塞
+                edge_update_flag = input->Update(node);
+                if (edge_update_flag != EdgeUpdateFlag::Complete) {
+                    break;
+                }
+            }
+
+            if (edge_update_flag == EdgeUpdateFlag::Complete) {
+                task.launched_++;
+                node->SetRunningFlag(true);
+                ret = node->Run();
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    node->SetRunningFlag(false);
+                }
+                if (ret != RS_SUCCESS) {
+                    RS_LOGE("node [%s] execute failed:%d!\n", node->GetName().c_str(), ret);
+                    ErrorCode expected = RS_SUCCESS;
+                    status_.compare_exchange_strong(expected, ret);
+                    Stop();
+                }
+            } else if (edge_update_flag == EdgeUpdateFlag::Terminate) {
+                RS_LOGI("node [%s] UpdateInput terminate!\n", node->GetName().c_str());
+            } else {
+                RS_LOGE("failed to node [%s] UpdateInput()!\n", node->GetName().c_str());
+                ErrorCode expected = RS_SUCCESS;
+                status_.compare_exchange_strong(expected, RS_DAG_STATU_ERROR);
+                Stop();
+            }
+
+            // 运行期间可能又来了数据
+            task.scheduled_ = false;
+            TrySchedule(index);
+
+            // 持锁通知,DeInit等到in_flight_为0后引擎可能马上析构
+            std::lock_guard<std::mutex> lock(mutex_);
+            in_flight_--;
+            if (in_flight_ == 0 || node->GetRunCompletedSize() >= run_size_) {
+                pipeline_cv_.notify_all();
+            }
+        }
+
+        void ParallelPipelineEngine::DispatchReplicas(int index) {
+            NodeTask &task = tasks_[index];
+            while (true) {
+                bool expected = false;
+                // 有线程正在派发,派发结束时会重新检查
+                if (!task.scheduled_.compare_exchange_strong(expected, true)) {
+                    return;
+                }
+                while (IsReady(task)) {
+                    int slot = -1;
+                    {
+                        std::lock_guard<std::mutex> lock(task.replica_mutex_);
+                        if (!task.idle_slots_.empty()) {
+                            slot = task.idle_slots_.back();
+                            task.idle_slots_.pop_back();
                         }
                     }
-                    return ret_status;
-                };
-                thread_pool_->Commit(std::bind(func));
+                    if (slot < 0 || !StartReplica(index, slot)) {
+                        break;
+                    }
+                }
+                task.scheduled_ = false;
+                // 派发和清标记之间到达的事件或空出的副本会因为标记被占而返回,这里再查一次
+                if (!IsReplicaReady(task)) {
+                    return;
+                }
+            }
+        }
+
+        bool ParallelPipelineEngine::IsReplicaReady(NodeTask &task) {
+            {
+                std::lock_guard<std::mutex> lock(task.replica_mutex_);
+                if (task.idle_slots_.empty()) {
+                    return false;
+                }
+            }
+            return IsReady(task);
+        }
+
+        bool ParallelPipelineEngine::StartReplica(int index, int slot) {
+            NodeTask &task = tasks_[index];
+            Node *node = task.node_;
+
+            EdgeUpdateFlag edge_update_flag = EdgeUpdateFlag::Complete;
+            {
+                // 输入已就绪,不会阻塞;按派发顺序取走,副本持有各自的数据包
+                RunSlotGuard guard(slot);
+                for (auto input : task.inputs_) {
+                    edge_update_flag = input->Update(node);
+                    if (edge_update_flag != EdgeUpdateFlag::Complete) {
+                        break;
+                    }
+                }
+            }
+            if (edge_update_flag != EdgeUpdateFlag::Complete) {
+                if (edge_update_flag == EdgeUpdateFlag::Terminate) {
+                    RS_LOGI("node [%s] UpdateInput terminate!\n", node->GetName().c_str());
+                } else {
+                    RS_LOGE("failed to node [%s] UpdateInput()!\n", node->GetName().c_str());
+                    ErrorCode expected = RS_SUCCESS;
+                    status_.compare_exchange_strong(expected, RS_DAG_STATU_ERROR);
+                    Stop();
+                }
+                std::lock_guard<std::mutex> lock(task.replica_mutex_);
+                task.idle_slots_.push_back(slot);
+                return false;
+            }
+
+            for (auto output : task.outputs_) {
+                output->BeginReplicaWrite();
+            }
+            task.launched_++;
+            size_t ticket = task.dispatch_ticket_++;
+            in_flight_++;
+            thread_pool_->Commit([this, index, slot, ticket]() { ProcessReplica(index, slot, ticket); });
+            return true;
+        }
+
+        void ParallelPipelineEngine::ProcessReplica(int index, int slot, size_t ticket) {
+            NodeTask &task = tasks_[index];
+            Node *node = task.node_;
+
+            ErrorCode ret = RS_SUCCESS;
+            {
+                RunSlotGuard guard(slot);
+                ret = node->Run();
+            }
+            if (ret != RS_SUCCESS) {
+                RS_LOGE("node [%s] replica %d execute failed:%d!\n", node->GetName().c_str(), slot,
+                        ret);
+                ErrorCode expected = RS_SUCCESS;
+                status_.compare_exchange_strong(expected, ret);
+                Stop();
+            }
+            {
+                std::lock_guard<std::mutex> lock(task.replica_mutex_);
+                size_t pos = ticket % task.replica_size_;
+                task.done_slots_[pos] = slot;
+                task.done_success_[pos] = ret == RS_SUCCESS;
+            }
+            CommitReplicas(index);
+
+            // 副本空出来了,可能还有数据
+            TrySchedule(index);
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            in_flight_--;
+            if (in_flight_ == 0 || node->GetRunCompletedSize() >= run_size_) {
+                pipeline_cv_.notify_all();
+            }
+        }
+
+        void ParallelPipelineEngine::CommitReplicas(int index) {
+            NodeTask &task = tasks_[index];
+            while (true) {
+                bool expected = false;
+                // 有线程正在提交,它会接着提交后面结束的副本
+                if (!task.committing_.compare_exchange_strong(expected, true)) {
+                    return;
+                }
+                while (true) {
+                    int slot = -1;
+                    bool success = false;
+                    {
+                        std::lock_guard<std::mutex> lock(task.replica_mutex_);
+                        size_t pos = task.commit_ticket_ % task.replica_size_;
+                        slot = task.done_slots_[pos];
+                        success = task.done_success_[pos];
+                    }
+                    if (slot < 0) {
+                        break;
+                    }
+                    for (auto output : task.outputs_) {
+                        output->EndReplicaWrite(slot, success);
+                    }
+                    {
+                        // 提交后才计为完成,Synchronize返回时输出已对下游可见
+                        std::lock_guard<std::mutex> lock(mutex_);
+                        task.node_->RecordCompletedRun();
+                    }
+                    std::lock_guard<std::mutex> lock(task.replica_mutex_);
+                    task.done_slots_[task.commit_ticket_ % task.replica_size_] = -1;
+                    task.commit_ticket_++;
+                    task.idle_slots_.push_back(slot);
+                }
+                task.committing_ = false;
+                // 清标记前结束的副本可能因为标记被占而没有提交
+                std::lock_guard<std::mutex> lock(task.replica_mutex_);
+                if (task.done_slots_[task.commit_ticket_ % task.replica_size_] < 0) {
+                    return;
+                }
+            }
+        }
+
+        void ParallelPipelineEngine::Stop() {
+            if (stop_flag_.exchange(true)) {
+                return;
+            }
+            for (auto iter : edge_repository_) {
+                if (!iter->edge_->RequestTerminate()) {
+                    RS_LOGE("failed iter edge requestTerminate()!\n");
+                }
             }
         }
 
     } // namespace dag
-} // namespace rayshape
\ No newline at end of file
+} // namespace rayshape
@@ -1,14 +1,22 @@
 #include "dag/engine/parallel_task_engine.h"
 #include "dag/util.h"
 
+#include <algorithm>
+#include <chrono>
+
 namespace rayshape
 {
     namespace dag
     {
+        namespace
+        {
+            const int64_t kInitCostNs = 1000; // 未测量前每个节点按相同耗时,秩即剩余路径的节点数
+            const int64_t kCostSmoothing = 4; // 滑动平均中新样本的权重为1/kCostSmoothing
+        } // namespace
+
         ParallelTaskEngine::ParallelTaskEngine() : ExecuteEngine() {
             thread_pool_ = nullptr;
             all_task_count_ = 0;
-            global_status_ = RS_SUCCESS;
         }
 
         ParallelTaskEngine::~ParallelTaskEngine() {}
@@ -17,14 +25,12 @@ namespace rayshape
                                            std::vector<NodeWrapper *> &node_repository) {
             ErrorCode ret = RS_SUCCESS;
 
-            thread_pool_ = new threadpool::ThreadPool();
-            thread_pool_->Init();
-
-            start_nodes_ = FindStartNodes(node_repository);
-            if (start_nodes_.empty()) {
-                RS_LOGE("No start node found in graph.\n");
-                return RS_INVALID_PARAM_VALUE;
+            if (thread_pool_ == nullptr) {
+                thread_pool_ = new threadpool::ThreadPool();
+                thread_pool_->Init();
             }
+
+            topo_sort_node_.clear();
             ret = TopoSortBFS(node_repository, topo_sort_node_);
             if (ret != RS_SUCCESS) {
                 RS_LOGE("TopoSortBFS Failed!\n");
@@ -32,6 +38,63 @@ namespace rayshape
             }
             all_task_count_ = static_cast<int>(topo_sort_node_.size());
 
+            // build execute plan: node index, successors index and predecessors size.
+            std::unordered_map<NodeWrapper *, int> node_index;
+            for (int i = 0; i < all_task_count_; ++i) {
+                node_index[topo_sort_node_[i]] = i;
+            }
+            start_nodes_.clear();
+            predecessors_size_.assign(all_task_count_, 0);
+            successors_.clear();
+            successor_offsets_.assign(1, 0);
+            for (int i = 0; i < all_task_count_; ++i) {
+                for (auto successor : topo_sort_node_[i]->successors_) {
+                    auto iter = node_index.find(successor);
+                    if (iter == node_index.end()) {
+                        RS_LOGE("node[%s] successor[%s] is not in graph!\n",
+                                topo_sort_node_[i]->name_.c_str(), successor->name_.c_str());
+                        return RS_INVALID_PARAM_VALUE;
+                    }
+                    successors_.push_back(iter->second);
+                    predecessors_size_[iter->second]++;
+                }
+                successor_offsets_.push_back(static_cast<int>(successors_.size()));
+            }
+            for (int i = 0; i < all_task_count_; ++i) {
+                if (predecessors_size_[i] == 0) {
+                    start_nodes_.push_back(i);
+                }
+            }
+            if (start_nodes_.empty()) {
+                RS_LOGE("No start node found in graph.\n");
+                return RS_INVALID_PARAM_VALUE;
+            }
+            costs_.reset(new std::atomic<int64_t>[all_task_count_]);
+            ranks_.reset(new std::atomic<int64_t>[all_task_count_]);
+            for (int i = 0; i < all_task_count_; ++i) {
+                costs_[i].store(kInitCostNs, std::memory_order_relaxed);
+            }
+            UpdateRanks();
+
+            // one run context and one edge slot per in flight run.
+            contexts_.clear();
+            idle_contexts_.clear();
+            for (int slot = 0; slot < max_in_flight_; ++slot) {
+                std::unique_ptr<RunContext> context(new RunContext());
+                context->slot_ = slot;
+                context->pending_.reset(new PaddedCounter[all_task_count_]);
+                for (int i = 0; i < all_task_count_; ++i) {
+                    context->pending_[i].value_.store(predecessors_size_[i],
+                                                      std::memory_order_relaxed);
+                }
+                idle_contexts_.push_back(context.get());
+                contexts_.push_back(std::move(context));
+            }
+            for (auto edge_wrapper : edge_repository) {
+                ret = edge_wrapper->edge_->SetRunSlotSize(max_in_flight_);
+                RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "edge SetRunSlotSize failed\n");
+            }
+
             for (auto iter : topo_sort_node_) {
                 // node init
                 iter->color_ = NODE_COLOR_WHITE;
@@ -51,8 +114,12 @@ namespace rayshape
 
         ErrorCode ParallelTaskEngine::DeInit() {
             ErrorCode ret = RS_SUCCESS;
-            thread_pool_->DeInit();
-            delete thread_pool_;
+            this->Synchronize();
+            if (thread_pool_ != nullptr) {
+                thread_pool_->DeInit();
+                delete thread_pool_;
+                thread_pool_ = nullptr;
+            }
 
             for (auto iter : topo_sort_node_) {
                 ret = iter->node_->Deinit();
@@ -67,134 +134,168 @@ namespace rayshape
         }
 
         ErrorCode ParallelTaskEngine::Run() {
-            ErrorCode ret = RS_SUCCESS;
+            std::future<ErrorCode> future = RunAsync(nullptr, nullptr);
+            return Wait(future);
+        }
+
+        ErrorCode ParallelTaskEngine::Wait(std::future<ErrorCode> &future) {
+            // 调用线程不空等,一起执行就绪的节点,本轮结束后立即返回
+            return thread_pool_->Wait(future);
+        }
 
-            for (const auto &node : start_nodes_) {
-                Process(node);
+        ErrorCode ParallelTaskEngine::SetMaxInFlight(int max_in_flight) {
+            if (max_in_flight <= 0) {
+                RS_LOGE("max in flight:%d must > 0\n", max_in_flight);
+                return RS_INVALID_PARAM_VALUE;
             }
-            Wait();
+            max_in_flight_ = max_in_flight;
+            return RS_SUCCESS;
+        }
 
-            //  check no running node
-            for (const auto &node : topo_sort_node_) {
-                if (node->color_ != NODE_COLOR_BLACK) {
-                    std::string err_msg = "node " + node->name_ + " is not finish!";
-                    RS_LOGE("%s\n", err_msg.c_str());
-                    return RS_NODE_STATU_ERROR;
-                }
+        std::future<ErrorCode> ParallelTaskEngine::RunAsync(const RunFeedFunc &feed,
+                                                            const RunDoneFunc &done) {
+            RunContext *context = nullptr;
+            {
+                // 在途轮数达到上限时阻塞,形成背压
+                std::unique_lock<std::mutex> lock(main_lock_);
+                cv_.wait(lock, [this] { return !idle_contexts_.empty(); });
+                context = idle_contexts_.back();
+                idle_contexts_.pop_back();
             }
+            context->completed_task_count_.store(0, std::memory_order_relaxed);
+            context->status_.store(RS_SUCCESS, std::memory_order_relaxed);
+            context->promise_ = std::promise<ErrorCode>();
+            context->done_ = done;
+            std::future<ErrorCode> future = context->promise_.get_future();
 
-            AfterGraphRun();
+            ErrorCode ret = RS_SUCCESS;
+            if (feed) {
+                RunSlotGuard guard(context->slot_);
+                ret = feed();
+            }
+            if (ret != RS_SUCCESS || all_task_count_ == 0) {
+                SetRunStatus(context, ret);
+                AfterGraphRun(context);
+                return future;
+            }
 
-            return ret;
+            // 起始节点按秩从大到小提交,最长路径先分到线程
+            std::vector<int> start_nodes = start_nodes_;
+            std::sort(start_nodes.begin(), start_nodes.end(), [this](int a, int b) {
+                return ranks_[a].load(std::memory_order_relaxed)
+                       > ranks_[b].load(std::memory_order_relaxed);
+            });
+            for (int index : start_nodes) {
+                Process(context, index);
+            }
+            return future;
         }
 
         bool ParallelTaskEngine::Synchronize() {
-            // for (auto iter : topo_sort_node_) {
-            //     if (iter->node_->Synchronize() == false) {
-            //         return false;
-            //     }
-            // }
+            std::unique_lock<std::mutex> lock(main_lock_);
+            cv_.wait(lock, [this] { return idle_contexts_.size() == contexts_.size(); });
             return true;
         }
 
         // global_status_ is refer from Cgraph.
-        void ParallelTaskEngine::Process(NodeWrapper *node_wrapper) {
-            if (unlikely(global_status_ != RS_SUCCESS)) {
-                RS_LOGW("global status is not success\n");
-                return;
-            }
-
-            node_wrapper->color_ = NODE_COLOR_GRAY;
-
-            const auto &func = [this, node_wrapper] {
-                ErrorCode cur_ret = node_wrapper->node_->Run();
-                if (unlikely(cur_ret != RS_SUCCESS)) {
-                    RS_LOGE("[%s] run error: %d\n", node_wrapper->node_->GetName().c_str(),
-                            cur_ret);
+        void ParallelTaskEngine::Process(RunContext *context, int index) {
+            // 在工作线程上提交时进该线程自己的队列,否则轮询分配;队列内按秩出队
+            thread_pool_->CommitLocal([this, context, index] { Execute(context, index); },
+                                      ranks_[index].load(std::memory_order_relaxed));
+        }
 
-                    std::lock_guard<std::mutex> status_lock(status_lock_);
+        void ParallelTaskEngine::Execute(RunContext *context, int index) {
+            while (index >= 0) {
+                // 有节点失败后,本轮剩余节点不再执行,但仍按依赖完成计数,保证本轮结束时没有任务在运行
+                if (likely(context->status_.load(std::memory_order_relaxed) == RS_SUCCESS)) {
+                    RunSlotGuard guard(context->slot_);
+                    Node *node = topo_sort_node_[index]->node_;
+                    auto start = std::chrono::steady_clock::now();
+                    ErrorCode cur_ret = node->Run();
+                    int64_t cost = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                       std::chrono::steady_clock::now() - start)
+                                       .count();
+                    // 并发轮次同时更新时丢掉一个样本无妨
+                    int64_t average = costs_[index].load(std::memory_order_relaxed);
+                    costs_[index].store(average + (cost - average) / kCostSmoothing,
+                                        std::memory_order_relaxed);
+                    if (unlikely(cur_ret != RS_SUCCESS)) {
+                        RS_LOGE("[%s] run error: %d\n", node->GetName().c_str(), cur_ret);
+                        SetRunStatus(context, cur_ret);
+                    }
+                }
+                // 秩最大的就绪后继不再提交,直接在本线程上接着执行
+                index = AfterNodeRun(context, index);
+            }
+        }
 
-                    if (global_status_ == RS_SUCCESS) {
-                        global_status_ = cur_ret;
+        int ParallelTaskEngine::AfterNodeRun(RunContext *context, int index) {
+            int next = -1;
+            PaddedCounter *pending = context->pending_.get();
+            for (int k = successor_offsets_[index]; k < successor_offsets_[index + 1]; ++k) {
+                int successor = successors_[k];
+                // 最后一个完成的前驱负责提交,并把计数恢复成前驱个数供下一轮使用
+                if (pending[successor].value_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    pending[successor].value_.store(predecessors_size_[successor],
+                                                    std::memory_order_relaxed);
+                    if (next < 0) {
+                        next = successor;
+                    } else if (ranks_[successor].load(std::memory_order_relaxed)
+                               > ranks_[next].load(std::memory_order_relaxed)) {
+                        Process(context, next);
+                        next = successor;
                     } else {
-                        // global_status_ is not success, no longer assign value.
-                        RS_LOGI("global status is [%d],cur status is [%d].\n", global_status_,
-                                cur_ret);
+                        Process(context, successor);
                     }
                 }
-                AfterNodeRun(node_wrapper);
-            };
+            }
 
-            thread_pool_->Commit(func);
+            if (context->completed_task_count_.fetch_add(1, std::memory_order_acq_rel) + 1
+                == all_task_count_) {
+                AfterGraphRun(context);
+            }
+            return next;
         }
-        // Recursion,from top to bottom.
-        void ParallelTaskEngine::AfterNodeRun(NodeWrapper *node_wrapper) {
-            {
-                std::lock_guard<std::mutex> lock(main_lock_);
-                completed_task_count_++;
-            }
-            // node status refresh.
-            node_wrapper->color_ = NODE_COLOR_BLACK;
-            if (!node_wrapper->successors_.empty() && (global_status_ == RS_SUCCESS)) {
-                for (auto successor : node_wrapper->successors_) {
-                    bool all_pre_done = true;
-                    for (auto iter : successor->predecessors_) {
-                        all_pre_done &= (iter->color_ == NODE_COLOR_BLACK);
-                    }
-                    if (all_pre_done && successor->color_ == NODE_COLOR_WHITE) {
-                        if (successor->predecessors_.size() <= 1) {
-                            Process(successor);
-                        } else {
-                            SubmitTaskSynchronized(successor);
-                        }
-                    }
-                }
-            } else {
-                std::lock_guard<std::mutex> lock(main_lock_);
-                // completed_task_count_++;
-                /**
-                 * 满足一下条件之一，则通知wait函数停止等待
-                 * 1，无后缀节点全部执行完毕(在运行正常的情况下，只有无后缀节点执行完成的时候，才可能整体运行结束)
-                 * 2，有节点执行状态异常
-                 */
-
-                if ((node_wrapper->successors_.empty()
-                     && (completed_task_count_ >= all_task_count_))
-                    || (global_status_ != RS_SUCCESS)) {
-                    cv_.notify_one();
+
+        void ParallelTaskEngine::UpdateRanks() {
+            // topo_sort_node_是拓扑序,后继的下标总在前驱之后
+            for (int i = all_task_count_ - 1; i >= 0; --i) {
+                int64_t longest = 0;
+                for (int k = successor_offsets_[i]; k < successor_offsets_[i + 1]; ++k) {
+                    longest = std::max(longest,
+                                       ranks_[successors_[k]].load(std::memory_order_relaxed));
                 }
+                ranks_[i].store(costs_[i].load(std::memory_order_relaxed) + longest,
+                                std::memory_order_relaxed);
             }
         }
 
-        // clear running status.
-        void ParallelTaskEngine::AfterGraphRun() {
-            completed_task_count_ = 0;
-            for (auto &node : topo_sort_node_) {
-                node->color_ = NODE_COLOR_WHITE;
-                // reset node color to white(no runing) ready for next run
+        void ParallelTaskEngine::AfterGraphRun(RunContext *context) {
+            ErrorCode ret = context->status_.load(std::memory_order_acquire);
+            UpdateRanks();
+            if (context->done_) {
+                RunSlotGuard guard(context->slot_);
+                context->done_(ret);
+                context->done_ = nullptr;
+            }
+            // 先取出promise,上下文归还后可能立即被下一轮复用
+            std::promise<ErrorCode> promise = std::move(context->promise_);
+            {
+                std::lock_guard<std::mutex> lock(main_lock_);
+                idle_contexts_.push_back(context);
             }
+            cv_.notify_all();
+            promise.set_value(ret);
         }
 
-        void ParallelTaskEngine::SubmitTaskSynchronized(NodeWrapper *node_wrapper) {
-            std::lock_guard<std::mutex> lock(commit_lock_);
-            if (node_wrapper->color_ == NODE_COLOR_WHITE) {
-                Process(node_wrapper);
+        void ParallelTaskEngine::SetRunStatus(RunContext *context, ErrorCode ret) {
+            ErrorCode expected = RS_SUCCESS;
+            if (!context->status_.compare_exchange_strong(expected, ret,
+                                                          std::memory_order_acq_rel)) {
+                // run status is not success, no longer assign value.
+                RS_LOGI("run status is [%d],cur status is [%d].\n", expected, ret);
             }
         }
-        void ParallelTaskEngine::Wait() {
-            std::unique_lock<std::mutex> lock(main_lock_);
-            /**
-             * 主线程等待检查；
-             * 遇到以下条件之一，结束执行：
-             * 1，执行结束
-             * 2，状态异常
-             */
-
-            cv_.wait(lock, [this] {
-                return ((completed_task_count_ >= all_task_count_)
-                        || (global_status_ != RS_SUCCESS));
-            });
-        }
 
     } // namespace dag
-} // namespace rayshape
\ No newline at end of file
+} // namespace rayshape
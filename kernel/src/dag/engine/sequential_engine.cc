@@ -11,11 +11,56 @@ namespace rayshape
 
         ErrorCode SequentialEngine::Init(std::vector<EdgeWrapper *> &edge_repository,
                                          std::vector<NodeWrapper *> &node_repository) {
-            return RS_SUCCESS;
+            ErrorCode ret = TopoSortBFS(node_repository, topo_sort_node_);
+            RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "TopoSortBFS Failed!\n");
+
+            for (auto iter : topo_sort_node_) {
+                iter->color_ = NODE_COLOR_WHITE;
+                if (iter->node_->GetInitStatus()) {
+                    continue;
+                }
+
+                ret = iter->node_->Init();
+                RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "node init failure\n");
+                iter->node_->SetInitStatus(true);
+            }
+            edge_repository_ = edge_repository;
+
+            // build flat execute plan.
+            run_nodes_.clear();
+            run_input_edges_.clear();
+            run_edge_offsets_.clear();
+            run_nodes_.reserve(topo_sort_node_.size());
+            run_edge_offsets_.reserve(topo_sort_node_.size() + 1);
+            run_edge_offsets_.push_back(0);
+            for (auto iter : topo_sort_node_) {
+                run_nodes_.push_back(iter->node_);
+                for (auto input : iter->node_->GetAllInput()) {
+                    run_input_edges_.push_back(input);
+                }
+                run_edge_offsets_.push_back(run_input_edges_.size());
+            }
+            RS_LOGD("SequentialEngine plan %zu nodes %zu input edges\n", run_nodes_.size(),
+                    run_input_edges_.size());
+
+            return ret;
         }
 
         ErrorCode SequentialEngine::DeInit() {
-            return RS_SUCCESS;
+            ErrorCode ret = RS_SUCCESS;
+            for (auto iter : topo_sort_node_) {
+                if (!iter->node_->GetInitStatus()) {
+                    continue;
+                }
+                ret = iter->node_->Deinit();
+                RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "node deinit failed\n");
+                iter->node_->SetInitStatus(false);
+            }
+            run_nodes_.clear();
+            run_input_edges_.clear();
+            run_edge_offsets_.clear();
+            topo_sort_node_.clear();
+            return ret;
         }
 
         ErrorCode SequentialEngine::Setup() {
@@ -24,9 +69,32 @@ namespace rayshape
 
         ErrorCode SequentialEngine::Run() {
             ErrorCode ret = RS_SUCCESS;
+            const size_t node_size = run_nodes_.size();
+            for (size_t i = 0; i < node_size; ++i) {
+                Node *node = run_nodes_[i];
+                // 输入边被请求终止时,本轮后续节点不再执行
+                for (size_t k = run_edge_offsets_[i]; k < run_edge_offsets_[i + 1]; ++k) {
+                    EdgeUpdateFlag flag = run_input_edges_[k]->Update(node);
+                    if (flag == EdgeUpdateFlag::Terminate) {
+                        RS_LOGI("node [%s] input terminate!\n", node->GetName().c_str());
+                        return RS_SUCCESS;
+                    } else if (flag != EdgeUpdateFlag::Complete) {
+                        RS_LOGE("node [%s] update input failed!\n", node->GetName().c_str());
+                        return RS_NODE_STATU_ERROR;
+                    }
+                }
+
+                node->SetRunningFlag(true);
+                ret = node->Run();
+                node->SetRunningFlag(false);
+                if (unlikely(ret != RS_SUCCESS)) {
+                    RS_LOGE("[%s] run error: %d\n", node->GetName().c_str(), ret);
+                    return ret;
+                }
+            }
 
             return ret;
         }
 
     } // namespace dag
-} // namespace rayshape
\ No newline at end of file
+} // namespace rayshape
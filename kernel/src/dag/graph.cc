@@ -323,6 +323,14 @@ namespace rayshape
                 return ret;
             }
 
+            if (warmup_flag_) {
+                ret = this->Warmup();
+                if (ret != RS_SUCCESS) {
+                    RS_LOGE("graph Warmup failed!");
+                    return ret;
+                }
+            }
+
             // set init flag. 设置初始化标志
             SetInitStatus(true);
 
@@ -350,6 +358,33 @@ namespace rayshape
             return ret;
         }
 
+        ErrorCode Graph::Warmup() {
+            ErrorCode ret = RS_SUCCESS;
+            auto graph_start = std::chrono::steady_clock::now();
+            for (auto node_wrapper : node_repository_) {
+                auto start = std::chrono::steady_clock::now();
+                ret = node_wrapper->node_->Warmup();
+                if (ret != RS_SUCCESS) {
+                    RS_LOGE("node[%s] warmup failed:%d\n", node_wrapper->name_.c_str(), ret);
+                    return ret;
+                }
+                RS_LOGD("node[%s] warmup cost:%.3fms\n", node_wrapper->name_.c_str(),
+                        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now()
+                                                                  - start)
+                            .count());
+            }
+            RS_LOGI("graph[%s] warmup %zu nodes cost:%.3fms\n", node_name_.c_str(),
+                    node_repository_.size(),
+                    std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now()
+                                                              - graph_start)
+                        .count());
+            return ret;
+        }
+
+        void Graph::SetWarmupFlag(bool flag) {
+            warmup_flag_ = flag;
+        }
+
         ErrorCode Graph::Construct() {
             ErrorCode ret = RS_SUCCESS;
 
@@ -404,6 +439,10 @@ namespace rayshape
                 ErrorCode ret = edge_wrapper->edge_->SetParallelType(parallel_type_);
                 RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "setParallelType failed!");
 
+                // pipeline use,边单独设置过的队列深度和溢出策略优先
+                ret = edge_wrapper->edge_->SetDefaultQueue(queue_max_size_, overflow_policy_);
+                RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "edge SetDefaultQueue failed!");
+
                 ret = edge_wrapper->edge_->IncreaseProducers(producers);
                 RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "edge IncreaseProducers failed!");
 
@@ -412,10 +451,6 @@ namespace rayshape
 
                 ret = edge_wrapper->edge_->Construct();
                 RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "edge construct failed!");
-
-                // pipeline use
-                // ret = edge_wrapper->edge_->SetQueueMaxSize(queue_max_size_)
-                // RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "edge setQueueMaxSize failed!");
             }
 
             // #TODO:引入cuda流 对于节点的运行
@@ -454,6 +489,7 @@ namespace rayshape
             if (parallel_type_ == ParallelType::PARALLEL_TYPE_NONE) {
                 execute_engine_ = std::make_shared<SequentialEngine>();
             } else if (parallel_type_ == ParallelType::PARALLEL_TYPE_SEQUENTIAL) {
+                execute_engine_ = std::make_shared<SequentialEngine>();
             } else if (parallel_type_ == ParallelType::PARALLEL_TYPE_TASK) {
                 execute_engine_ = std::make_shared<ParallelTaskEngine>();
             } else if (parallel_type_ == ParallelType::PARALLEL_TYPE_PIPELINE) {
@@ -463,6 +499,8 @@ namespace rayshape
                 return RS_NOT_IMPLEMENT;
             }
             RS_CHECK_PARAM_NULL_RET_STATUS(execute_engine_, "Create executor engine failed!");
+            ret = execute_engine_->SetMaxInFlight(max_in_flight_);
+            RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "executor engine SetMaxInFlight failed!");
 
             std::vector<NodeWrapper *> run_node_repository;
             for (auto node_wrapper : node_repository_) {
@@ -497,6 +535,61 @@ namespace rayshape
             return ret;
         }
 
+        ErrorCode Graph::SetMaxInFlight(int max_in_flight) {
+            if (max_in_flight <= 0) {
+                RS_LOGE("max in flight:%d must > 0\n", max_in_flight);
+                return RS_INVALID_PARAM_VALUE;
+            }
+            if (GetInitStatus()) {
+                RS_LOGE("graph[%s] SetMaxInFlight must be called before Init\n",
+                        node_name_.c_str());
+                return RS_DAG_STATU_ERROR;
+            }
+            max_in_flight_ = max_in_flight;
+            return RS_SUCCESS;
+        }
+
+        ErrorCode Graph::SetQueueMaxSize(int queue_max_size) {
+            if (queue_max_size <= 0) {
+                RS_LOGE("queue max size:%d must > 0\n", queue_max_size);
+                return RS_INVALID_PARAM_VALUE;
+            }
+            if (GetInitStatus()) {
+                RS_LOGE("graph[%s] SetQueueMaxSize must be called before Init\n",
+                        node_name_.c_str());
+                return RS_DAG_STATU_ERROR;
+            }
+            queue_max_size_ = queue_max_size;
+            return RS_SUCCESS;
+        }
+
+        ErrorCode Graph::SetOverflowPolicy(QueueOverflowPolicy policy) {
+            if (GetInitStatus()) {
+                RS_LOGE("graph[%s] SetOverflowPolicy must be called before Init\n",
+                        node_name_.c_str());
+                return RS_DAG_STATU_ERROR;
+            }
+            overflow_policy_ = policy;
+            return RS_SUCCESS;
+        }
+
+        std::future<ErrorCode> Graph::RunAsync(const RunFeedFunc &feed, const RunDoneFunc &done) {
+            if (execute_engine_ == nullptr) {
+                RS_LOGE("graph[%s] is not initialized\n", node_name_.c_str());
+                std::promise<ErrorCode> promise;
+                promise.set_value(RS_DAG_STATU_ERROR);
+                return promise.get_future();
+            }
+            return execute_engine_->RunAsync(feed, done);
+        }
+
+        ErrorCode Graph::Wait(std::future<ErrorCode> &future) {
+            if (execute_engine_ == nullptr) {
+                return future.get();
+            }
+            return execute_engine_->Wait(future);
+        }
+
         bool Graph::Synchronize() {
             bool is_synchronize = execute_engine_->Synchronize();
             if (!is_synchronize) {
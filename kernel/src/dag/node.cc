@@ -152,6 +152,10 @@ namespace rayshape
             return RS_SUCCESS;
         }
 
+        ErrorCode Node::Warmup() {
+            return RS_SUCCESS;
+        }
+
         std::vector<Edge *> Node::Forward(std::vector<Edge *> inputs) {
             // init
             if (is_init_ == false && is_trace_ == false) {
@@ -303,6 +307,11 @@ namespace rayshape
             // }
         }
 
+        void Node::RecordCompletedRun() {
+            run_size_++;
+            completed_size_++;
+        }
+
         size_t Node::GetRunCompletedSize() {
             return completed_size_;
         }
@@ -311,6 +320,23 @@ namespace rayshape
             return true;
         }
 
+        ErrorCode Node::SetReplicaSize(int replica_size) {
+            if (replica_size <= 0) {
+                RS_LOGE("node[%s] replica size:%d must > 0\n", node_name_.c_str(), replica_size);
+                return RS_INVALID_PARAM_VALUE;
+            }
+            if (is_init_) {
+                RS_LOGE("node[%s] SetReplicaSize must be called before Init\n", node_name_.c_str());
+                return RS_NODE_STATU_ERROR;
+            }
+            replica_size_ = replica_size;
+            return RS_SUCCESS;
+        }
+
+        int Node::GetReplicaSize() const {
+            return replica_size_;
+        }
+
         EdgeUpdateFlag Node::UpdateInput() {
             EdgeUpdateFlag flag = EdgeUpdateFlag::Complete;
             for (auto input : inputs_) {
@@ -4,6 +4,22 @@ namespace rayshape
 {
     namespace dag
     {
+        namespace
+        {
+            thread_local int g_run_slot = 0;
+        } // namespace
+
+        int GetRunSlot() {
+            return g_run_slot;
+        }
+
+        RunSlotGuard::RunSlotGuard(int slot) : last_slot_(g_run_slot) {
+            g_run_slot = slot;
+        }
+
+        RunSlotGuard::~RunSlotGuard() {
+            g_run_slot = last_slot_;
+        }
 
         std::vector<NodeWrapper *> CheckUnuseNode(std::vector<NodeWrapper *> &node_repository) {
             std::vector<NodeWrapper *> unused;
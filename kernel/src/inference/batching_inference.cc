@@ -0,0 +1,572 @@
+#include "inference/batching_inference.h"
+
+#include "utils/memory_size_info.h"
+#include "utils/blob_utils.h"
+#include "base/logger.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace rayshape::utils;
+
+namespace rayshape
+{
+    namespace inference
+    {
+        static Dims BatchDims(const Dims &dims, int batch) {
+            Dims batch_dims = dims;
+            if (batch_dims.size > 0) {
+                batch_dims.value[0] = batch;
+            }
+            return batch_dims;
+        }
+
+        // 单个样本(batch维之外)的字节数
+        static size_t SampleBytes(const Blob *blob) {
+            if (blob->dims.size <= 0 || blob->dims.value[0] <= 0) {
+                return 0;
+            }
+            return CalculateMemorySize(blob->dims, blob->data_type) / blob->dims.value[0];
+        }
+
+        // 容量不足时重新分配,否则只修改dims
+        static ErrorCode EnsureSampleBlob(Blob **blob, const Blob *like, const Dims &dims) {
+            if (*blob != nullptr && (*blob)->data_type == like->data_type
+                && (*blob)->buffer->GetDataSize() >= CalculateDims(dims)) {
+                (*blob)->dims = dims;
+                return RS_SUCCESS;
+            }
+            Blob *new_blob =
+                BlobAlloc(DeviceType::CPU, like->data_type, like->data_format, like->name, &dims);
+            if (new_blob == nullptr) {
+                RS_LOGE("BlobAlloc %s failed\n", like->name);
+                return RS_OUTOFMEMORY;
+            }
+            if (*blob != nullptr) {
+                BlobFree(*blob);
+            }
+            *blob = new_blob;
+            return RS_SUCCESS;
+        }
+
+        static Blob *FindSlotBlob(const std::vector<Blob *> &blobs, const char *name) {
+            if (name == nullptr) {
+                return nullptr;
+            }
+            for (Blob *blob : blobs) {
+                if (blob != nullptr && strcmp(blob->name, name) == 0) {
+                    return blob;
+                }
+            }
+            return nullptr;
+        }
+
+        ErrorCode ParseBatchPolicy(const RSJsonHandle json_handle, BatchPolicy &policy) {
+            RSJsonObject root_obj = RSJsonRootGet(json_handle);
+            RSJsonObject network_obj = RSJsonObjectGet(root_obj, "NetworkConfig");
+            if (network_obj == nullptr) {
+                return RS_SUCCESS;
+            }
+            RSJsonObject batch_obj = RSJsonObjectGet(network_obj, "BatchConfig");
+            if (batch_obj == nullptr) {
+                return RS_SUCCESS;
+            }
+
+            policy.max_batch_size_ =
+                RSJsonIntGet(RSJsonObjectGet(batch_obj, "MaxBatchSize"), policy.max_batch_size_);
+            policy.max_queue_delay_us_ = RSJsonIntGet(RSJsonObjectGet(batch_obj, "MaxQueueDelayUs"),
+                                                      policy.max_queue_delay_us_);
+            if (policy.max_batch_size_ <= 0 || policy.max_queue_delay_us_ < 0) {
+                RS_LOGE("BatchConfig MaxBatchSize:%d must > 0 and MaxQueueDelayUs:%d must >= 0\n",
+                        policy.max_batch_size_, policy.max_queue_delay_us_);
+                return RS_INVALID_PARAM_VALUE;
+            }
+            return RS_SUCCESS;
+        }
+
+        BatchingInference::BatchingInference(InferenceType type) : Inference(type) {
+            inference_ = CreateInference(type);
+        }
+
+        BatchingInference::BatchingInference(std::shared_ptr<Inference> inference) :
+            Inference(inference != nullptr ? inference->GetInferenceType() : InferenceType::NONE),
+            inference_(inference) {}
+
+        BatchingInference::~BatchingInference() {
+            Wait();
+            StopWorker();
+            ClearSlots();
+        }
+
+        ErrorCode BatchingInference::Init(const Model *model, const CustomRuntime *runtime) {
+            ErrorCode ret = RS_SUCCESS;
+
+            if (inference_ == nullptr) {
+                RS_LOGE("inference type:%d is not registered!\n", (int)type_);
+                return RS_INVALID_PARAM;
+            }
+            if (model == nullptr || runtime == nullptr) {
+                RS_LOGE("model or runtime is nullptr!\n");
+                return RS_INVALID_PARAM;
+            }
+
+            const std::string *cfg_str = GetModelConfig(model);
+            if (cfg_str != nullptr && !cfg_str->empty()) {
+                RSJsonHandle json_handle = nullptr;
+                if ((ret = RSJsonCreate(*cfg_str, &json_handle)) != RS_SUCCESS) {
+                    RS_LOGE("RSJsonCreate failed:%d\n", ret);
+                    return ret;
+                }
+                ret = ParseBatchPolicy(json_handle, policy_);
+                RSJsonDestory(&json_handle);
+                if (ret != RS_SUCCESS) {
+                    RS_LOGE("ParseBatchPolicy failed:%d!\n", ret);
+                    return ret;
+                }
+            }
+
+            if ((ret = inference_->Init(model, runtime)) != RS_SUCCESS) {
+                RS_LOGE("inference Init failed:%d!\n", ret);
+                return ret;
+            }
+
+            if ((ret = InitBatchMode()) != RS_SUCCESS) {
+                RS_LOGE("InitBatchMode failed:%d!\n", ret);
+                return ret;
+            }
+
+            stats_ = BatchStatistics();
+            stats_.batch_size_hist_.assign(policy_.max_batch_size_ + 1, 0);
+            total_queue_delay_us_ = 0;
+
+            stop_ = false;
+            worker_ = std::thread(&BatchingInference::WorkerLoop, this);
+            return RS_SUCCESS;
+        }
+
+        ErrorCode BatchingInference::InitBatchMode() {
+            const Blob **inner_blobs = nullptr;
+            size_t inner_size = 0;
+            ErrorCode ret = inference_->InputBlobsGet(&inner_blobs, &inner_size);
+            RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "inference InputBlobsGet failed.");
+
+            input_templates_.clear();
+            output_templates_.clear();
+            int model_batch = -1;
+            for (size_t i = 0; i < inner_size; ++i) {
+                const Blob *blob = inner_blobs[i];
+                if (blob->dims.size <= 0) {
+                    RS_LOGE("input:%s has no batch dim\n", blob->name);
+                    return RS_INVALID_MODEL;
+                }
+                if (model_batch >= 0 && blob->dims.value[0] != model_batch) {
+                    RS_LOGE("input:%s batch:%d != %d, inputs must share batch dim\n", blob->name,
+                            blob->dims.value[0], model_batch);
+                    return RS_INVALID_MODEL;
+                }
+                model_batch = blob->dims.value[0];
+                Blob blob_template = *blob;
+                blob_template.buffer = nullptr;
+                blob_template.dims = BatchDims(blob->dims, 1);
+                input_templates_.push_back(blob_template);
+            }
+
+            // 能Reshape到另一个batch说明batch维是动态的
+            int probe_batch = model_batch != policy_.max_batch_size_ ? policy_.max_batch_size_ : 1;
+            std::vector<const char *> names;
+            std::vector<Dims> dims;
+            for (const Blob &blob_template : input_templates_) {
+                names.push_back(blob_template.name);
+                dims.push_back(BatchDims(blob_template.dims, probe_batch));
+            }
+            if (model_batch == probe_batch
+                || inference_->Reshape(names.data(), dims.data(), dims.size()) == RS_SUCCESS) {
+                dynamic_batch_ = true;
+                model_batch = probe_batch;
+            } else if (model_batch == policy_.max_batch_size_) {
+                dynamic_batch_ = false;
+            } else {
+                RS_LOGW("model batch:%d is static, MaxBatchSize:%d is limited to it\n",
+                        model_batch, policy_.max_batch_size_);
+                dynamic_batch_ = false;
+                policy_.max_batch_size_ = model_batch;
+            }
+            inner_batch_ = model_batch;
+
+            const Blob **output_blobs = nullptr;
+            size_t output_size = 0;
+            ret = inference_->OutputBlobsGet(&output_blobs, &output_size);
+            RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "inference OutputBlobsGet failed.");
+            for (size_t i = 0; i < output_size; ++i) {
+                Blob blob_template = *output_blobs[i];
+                blob_template.buffer = nullptr;
+                blob_template.dims = BatchDims(blob_template.dims, 1);
+                output_templates_.push_back(blob_template);
+            }
+
+            RS_LOGD("BatchingInference max_batch:%d max_delay_us:%d dynamic_batch:%d\n",
+                    policy_.max_batch_size_, policy_.max_queue_delay_us_, dynamic_batch_);
+            return RS_SUCCESS;
+        }
+
+        void BatchingInference::DeInit() {
+            StopWorker();
+            ClearSlots();
+            if (inference_ != nullptr) {
+                inference_->DeInit();
+            }
+        }
+
+        void BatchingInference::StopWorker() {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stop_ = true;
+            }
+            queue_cond_.notify_all();
+            if (worker_.joinable()) {
+                worker_.join();
+                RS_LOGD("BatchingInference batches:%llu requests:%llu avg_batch:%.2f "
+                        "avg_delay_us:%.1f max_delay_us:%.1f\n",
+                        (unsigned long long)stats_.batch_count_,
+                        (unsigned long long)stats_.request_count_, stats_.avg_batch_size_,
+                        stats_.avg_queue_delay_us_, stats_.max_queue_delay_us_);
+            }
+        }
+
+        void BatchingInference::ClearSlots() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto &it : slots_) {
+                for (Blob *blob : it.second->inputs_) {
+                    BlobFree(blob);
+                }
+                for (Blob *blob : it.second->outputs_) {
+                    BlobFree(blob);
+                }
+                delete it.second;
+            }
+            slots_.clear();
+            queue_.clear();
+        }
+
+        ErrorCode BatchingInference::SlotGet(BatchSlot **slot) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stop_) {
+                RS_LOGE("BatchingInference is not initialized\n");
+                return RS_INVALID_MODEL;
+            }
+
+            auto iter = slots_.find(std::this_thread::get_id());
+            if (iter != slots_.end()) {
+                *slot = iter->second;
+                return RS_SUCCESS;
+            }
+
+            // 首次使用的线程按内部模型的输入输出创建batch为1的blob
+            ErrorCode ret = RS_SUCCESS;
+            BatchSlot *new_slot = new BatchSlot();
+            for (size_t i = 0; i < input_templates_.size() && ret == RS_SUCCESS; ++i) {
+                Blob *blob = nullptr;
+                ret = EnsureSampleBlob(&blob, &input_templates_[i], input_templates_[i].dims);
+                if (ret == RS_SUCCESS) {
+                    new_slot->inputs_.push_back(blob);
+                }
+            }
+            for (size_t i = 0; i < output_templates_.size() && ret == RS_SUCCESS; ++i) {
+                Blob *blob = nullptr;
+                ret = EnsureSampleBlob(&blob, &output_templates_[i], output_templates_[i].dims);
+                if (ret == RS_SUCCESS) {
+                    new_slot->outputs_.push_back(blob);
+                }
+            }
+            if (ret != RS_SUCCESS) {
+                for (Blob *blob : new_slot->inputs_) {
+                    BlobFree(blob);
+                }
+                for (Blob *blob : new_slot->outputs_) {
+                    BlobFree(blob);
+                }
+                delete new_slot;
+                return ret;
+            }
+
+            slots_[std::this_thread::get_id()] = new_slot;
+            *slot = new_slot;
+            return RS_SUCCESS;
+        }
+
+        ErrorCode BatchingInference::Reshape(const char ** /*name_arr*/, const Dims * /*dims_arr*/,
+                                             size_t /*dims_size*/) {
+            RS_LOGE("BatchingInference manages batch dim itself, Reshape is not supported\n");
+            return RS_NOT_IMPLEMENT;
+        }
+
+        // 调用前须持有mutex_
+        ErrorCode BatchingInference::EnqueueSlot(BatchSlot *slot, bool async) {
+            if (!slot->done_) {
+                RS_LOGE("request of this thread is not finished\n");
+                return RS_INFERENCE_BUSY;
+            }
+            slot->done_ = false;
+            slot->async_ = async;
+            slot->ret_ = RS_SUCCESS;
+            slot->enqueue_time_ = std::chrono::steady_clock::now();
+            queue_.push_back(slot);
+            queue_cond_.notify_one();
+            return RS_SUCCESS;
+        }
+
+        ErrorCode BatchingInference::Forward() {
+            BatchSlot *slot = nullptr;
+            ErrorCode ret = SlotGet(&slot);
+            RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "BatchingInference SlotGet failed.");
+
+            std::unique_lock<std::mutex> lock(mutex_);
+            ret = EnqueueSlot(slot, false);
+            RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "BatchingInference EnqueueSlot failed.");
+
+            done_cond_.wait(lock, [slot]() { return slot->done_; });
+            return slot->ret_;
+        }
+
+        ErrorCode BatchingInference::StartForward() {
+            BatchSlot *slot = nullptr;
+            ErrorCode ret = SlotGet(&slot);
+            RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "BatchingInference SlotGet failed.");
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            return EnqueueSlot(slot, true);
+        }
+
+        void BatchingInference::WorkerLoop() {
+            std::unique_lock<std::mutex> lock(mutex_);
+            while (true) {
+                queue_cond_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+                if (queue_.empty()) {
+                    break; // stop_
+                }
+
+                // 从最早的请求开始计时,攒满batch或超时即执行
+                auto deadline = queue_.front()->enqueue_time_
+                                + std::chrono::microseconds(policy_.max_queue_delay_us_);
+                queue_cond_.wait_until(lock, deadline, [this]() {
+                    return stop_ || queue_.size() >= static_cast<size_t>(policy_.max_batch_size_);
+                });
+
+                size_t batch_size =
+                    std::min(queue_.size(), static_cast<size_t>(policy_.max_batch_size_));
+                std::vector<BatchSlot *> batch(queue_.begin(), queue_.begin() + batch_size);
+                queue_.erase(queue_.begin(), queue_.begin() + batch_size);
+                auto start_time = std::chrono::steady_clock::now();
+
+                lock.unlock();
+                ErrorCode ret = RunBatch(batch);
+                lock.lock();
+
+                bool finish_async = false;
+                for (BatchSlot *slot : batch) {
+                    slot->ret_ = ret;
+                    slot->done_ = true;
+                    finish_async = finish_async || slot->async_;
+                    slot->async_ = false;
+                }
+                UpdateStatistics(batch, start_time);
+                done_cond_.notify_all();
+
+                // 回调中可能再次访问本对象,在锁外通知
+                if (finish_async) {
+                    lock.unlock();
+                    FinishForward(ret);
+                    lock.lock();
+                }
+            }
+        }
+
+        ErrorCode BatchingInference::RunBatch(const std::vector<BatchSlot *> &batch) {
+            ErrorCode ret = RS_SUCCESS;
+            int batch_size = static_cast<int>(batch.size());
+            int run_batch = dynamic_batch_ ? batch_size : inner_batch_;
+
+            if (dynamic_batch_ && inner_batch_ != batch_size) {
+                std::vector<const char *> names;
+                std::vector<Dims> dims;
+                for (const Blob &blob_template : input_templates_) {
+                    names.push_back(blob_template.name);
+                    dims.push_back(BatchDims(blob_template.dims, batch_size));
+                }
+                ret = inference_->Reshape(names.data(), dims.data(), dims.size());
+                RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "inference Reshape batch failed.");
+                inner_batch_ = batch_size;
+            }
+
+            ret = PackInputs(batch, run_batch);
+            RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "BatchingInference PackInputs failed.");
+
+            ret = inference_->Forward();
+            RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "inference Forward failed.");
+
+            return ScatterOutputs(batch, run_batch);
+        }
+
+        ErrorCode BatchingInference::PackInputs(const std::vector<BatchSlot *> &batch,
+                                                int run_batch) {
+            const Blob **inner_blobs = nullptr;
+            size_t inner_size = 0;
+            ErrorCode ret = inference_->InputBlobsGet(&inner_blobs, &inner_size);
+            RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "inference InputBlobsGet failed.");
+
+            for (size_t i = 0; i < inner_size; ++i) {
+                const Blob *inner = inner_blobs[i];
+                char *dst = static_cast<char *>(inner->buffer->GetDataPtr());
+                size_t sample_bytes = SampleBytes(inner);
+                for (size_t j = 0; j < batch.size(); ++j) {
+                    const Blob *src = FindSlotBlob(batch[j]->inputs_, inner->name);
+                    if (src == nullptr || CalculateMemorySize(src->dims, src->data_type)
+                                              != sample_bytes) {
+                        RS_LOGE("input:%s sample size mismatch with model\n", inner->name);
+                        return RS_INVALID_PARAM_VALUE;
+                    }
+                    memcpy(dst + j * sample_bytes, src->buffer->GetDataPtr(), sample_bytes);
+                }
+                // 固定batch的模型,空位补零
+                if (static_cast<int>(batch.size()) < run_batch) {
+                    memset(dst + batch.size() * sample_bytes, 0,
+                           (run_batch - batch.size()) * sample_bytes);
+                }
+            }
+            return RS_SUCCESS;
+        }
+
+        ErrorCode BatchingInference::ScatterOutputs(const std::vector<BatchSlot *> &batch,
+                                                    int run_batch) {
+            const Blob **inner_blobs = nullptr;
+            size_t inner_size = 0;
+            ErrorCode ret = inference_->OutputBlobsGet(&inner_blobs, &inner_size);
+            RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "inference OutputBlobsGet failed.");
+
+            for (size_t i = 0; i < inner_size; ++i) {
+                const Blob *inner = inner_blobs[i];
+                if (inner->dims.size <= 0 || inner->dims.value[0] != run_batch) {
+                    RS_LOGE("output:%s dim[0] is not batch:%d\n", inner->name, run_batch);
+                    return RS_INVALID_MODEL;
+                }
+                const char *src = static_cast<const char *>(inner->buffer->GetDataPtr());
+                size_t sample_bytes = SampleBytes(inner);
+                Dims sample_dims = BatchDims(inner->dims, 1);
+                for (size_t j = 0; j < batch.size(); ++j) {
+                    std::vector<Blob *> &outputs = batch[j]->outputs_;
+                    auto iter = std::find_if(outputs.begin(), outputs.end(), [inner](Blob *blob) {
+                        return strcmp(blob->name, inner->name) == 0;
+                    });
+                    if (iter == outputs.end()) {
+                        RS_LOGE("output:%s not found in caller blobs\n", inner->name);
+                        return RS_INVALID_MODEL;
+                    }
+                    ret = EnsureSampleBlob(&(*iter), inner, sample_dims);
+                    RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "EnsureSampleBlob failed.");
+                    memcpy((*iter)->buffer->GetDataPtr(), src + j * sample_bytes, sample_bytes);
+                }
+            }
+            return RS_SUCCESS;
+        }
+
+        void BatchingInference::UpdateStatistics(const std::vector<BatchSlot *> &batch,
+                                                 std::chrono::steady_clock::time_point start_time) {
+            int batch_size = static_cast<int>(batch.size());
+            stats_.batch_count_++;
+            stats_.request_count_ += batch_size;
+            stats_.max_batch_size_ = std::max(stats_.max_batch_size_, batch_size);
+            if (batch_size < static_cast<int>(stats_.batch_size_hist_.size())) {
+                stats_.batch_size_hist_[batch_size]++;
+            }
+            for (const BatchSlot *slot : batch) {
+                double delay_us =
+                    std::chrono::duration<double, std::micro>(start_time - slot->enqueue_time_)
+                        .count();
+                total_queue_delay_us_ += delay_us;
+                stats_.max_queue_delay_us_ = std::max(stats_.max_queue_delay_us_, delay_us);
+            }
+            stats_.avg_batch_size_ =
+                static_cast<double>(stats_.request_count_) / stats_.batch_count_;
+            stats_.avg_queue_delay_us_ = total_queue_delay_us_ / stats_.request_count_;
+        }
+
+        ErrorCode BatchingInference::StatisticsGet(BatchStatistics *stats) {
+            if (stats == nullptr) {
+                RS_LOGE("stats is nullptr\n");
+                return RS_INVALID_PARAM;
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            *stats = stats_;
+            return RS_SUCCESS;
+        }
+
+        ErrorCode BatchingInference::InputBlobsGet(const Blob ***blob_arr, size_t *blob_size) {
+            if (blob_arr == nullptr || blob_size == nullptr) {
+                RS_LOGE("blob_arr:%p or blob_size:%p is nullptr\n", blob_arr, blob_size);
+                return RS_INVALID_PARAM;
+            }
+            BatchSlot *slot = nullptr;
+            ErrorCode ret = SlotGet(&slot);
+            RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "BatchingInference SlotGet failed.");
+
+            *blob_arr = (const Blob **)slot->inputs_.data();
+            *blob_size = slot->inputs_.size();
+            return RS_SUCCESS;
+        }
+
+        ErrorCode BatchingInference::OutputBlobsGet(const Blob ***blob_arr, size_t *blob_size) {
+            if (blob_arr == nullptr || blob_size == nullptr) {
+                RS_LOGE("blob_arr:%p or blob_size:%p is nullptr\n", blob_arr, blob_size);
+                return RS_INVALID_PARAM;
+            }
+            BatchSlot *slot = nullptr;
+            ErrorCode ret = SlotGet(&slot);
+            RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "BatchingInference SlotGet failed.");
+
+            *blob_arr = (const Blob **)slot->outputs_.data();
+            *blob_size = slot->outputs_.size();
+            return RS_SUCCESS;
+        }
+
+        ErrorCode BatchingInference::InputBlobGet(const char *input_name, Blob **blob) {
+            if (blob == nullptr) {
+                RS_LOGE("blob is nullptr\n");
+                return RS_INVALID_PARAM;
+            }
+            BatchSlot *slot = nullptr;
+            ErrorCode ret = SlotGet(&slot);
+            RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "BatchingInference SlotGet failed.");
+
+            *blob = FindSlotBlob(slot->inputs_, input_name);
+            if (*blob == nullptr) {
+                RS_LOGE("Not find Blob name:%s\n", input_name != nullptr ? input_name : "");
+                return RS_INVALID_PARAM;
+            }
+            return RS_SUCCESS;
+        }
+
+        ErrorCode BatchingInference::OutputBlobGet(const char *output_name, const Blob **blob) {
+            if (blob == nullptr) {
+                RS_LOGE("blob is nullptr\n");
+                return RS_INVALID_PARAM;
+            }
+            BatchSlot *slot = nullptr;
+            ErrorCode ret = SlotGet(&slot);
+            RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "BatchingInference SlotGet failed.");
+
+            *blob = FindSlotBlob(slot->outputs_, output_name);
+            if (*blob == nullptr) {
+                RS_LOGE("Not find Blob name:%s\n", output_name != nullptr ? output_name : "");
+                return RS_INVALID_PARAM;
+            }
+            return RS_SUCCESS;
+        }
+
+        std::shared_ptr<Inference> CreateBatchingInference(InferenceType type) {
+            if (GetGlobalInferenceCreatorMap().count(type) <= 0) {
+                return nullptr;
+            }
+            return std::make_shared<BatchingInference>(type);
+        }
+
+    } // namespace inference
+} // namespace rayshape
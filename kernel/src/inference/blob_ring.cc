@@ -0,0 +1,273 @@
+#include "inference/blob_ring.h"
+#include "base/logger.h"
+#include "utils/memory_size_info.h"
+
+namespace rayshape
+{
+    namespace inference
+    {
+        struct BlobRing::RingState {
+            typedef struct Slot {
+                std::vector<Blob *> inputs_;
+                std::vector<Blob *> outputs_;
+                int refs_ = 0; // 生产者 + 下游共享buffer的引用数,为0时空闲
+                bool producer_ = false; // Acquire之后,Release之前为true
+            } Slot;
+
+            ~RingState() {
+                for (auto &slot : slots_) {
+                    for (auto blob : slot.inputs_) {
+                        BlobFree(blob);
+                    }
+                    for (auto blob : slot.outputs_) {
+                        BlobFree(blob);
+                    }
+                }
+            }
+
+            // producer为true时归还Acquire的引用,每次Acquire只能归还一次
+            ErrorCode Unref(int slot, bool producer) {
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    Slot &target = slots_[slot];
+                    if (target.refs_ <= 0 || (producer && !target.producer_)) {
+                        return RS_INVALID_PARAM;
+                    }
+                    if (producer) {
+                        target.producer_ = false;
+                    }
+                    if (--target.refs_ > 0) {
+                        return RS_SUCCESS;
+                    }
+                }
+                cond_.notify_all();
+                return RS_SUCCESS;
+            }
+
+            // 共享给下游的槽位输出,不拥有内存,析构时归还槽位引用
+            class SlotBuffer: public Buffer {
+            public:
+                SlotBuffer(void *data, const RSMemoryInfo &mem_info,
+                           std::shared_ptr<RingState> state, int slot) :
+                    Buffer(data, mem_info), state_(state), slot_(slot) {}
+                ~SlotBuffer() override {
+                    state_->Unref(slot_, false);
+                }
+
+            private:
+                std::shared_ptr<RingState> state_;
+                int slot_;
+            };
+
+            std::mutex mutex_;
+            std::condition_variable cond_;
+            std::vector<Slot> slots_;
+            size_t next_ = 0; // 按顺序轮转槽位
+        };
+
+        namespace
+        {
+            Blob *CreateSlotBlob(const Blob *src) {
+                if (src == nullptr || utils::CalculateDims(src->dims) == 0) {
+                    RS_LOGE("blob:%s dims is unknown, can not create slot\n",
+                            src != nullptr ? src->name : "");
+                    return nullptr;
+                }
+                for (int i = 0; i < src->dims.size; ++i) {
+                    if (src->dims.value[i] <= 0) {
+                        RS_LOGE("blob:%s dim[%d]:%d is dynamic, can not create slot\n", src->name,
+                                i, src->dims.value[i]);
+                        return nullptr;
+                    }
+                }
+                Dims dims = src->dims;
+                return BlobAlloc(DeviceType::CPU, src->data_type, src->data_format, src->name,
+                                 &dims);
+            }
+        } // namespace
+
+        BlobRing::BlobRing() {}
+
+        BlobRing::~BlobRing() {
+            DeInit();
+        }
+
+        ErrorCode BlobRing::Init(Inference *inference, int depth) {
+            if (inference == nullptr || depth <= 0) {
+                RS_LOGE("inference:%p is nullptr or depth:%d <= 0\n", inference, depth);
+                return RS_INVALID_PARAM;
+            }
+            DeInit();
+
+            const Blob **input_arr = nullptr;
+            const Blob **output_arr = nullptr;
+            size_t input_size = 0;
+            size_t output_size = 0;
+            ErrorCode ret = inference->InputBlobsGet(&input_arr, &input_size);
+            RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "BlobRing get input blobs failed.");
+            ret = inference->OutputBlobsGet(&output_arr, &output_size);
+            RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "BlobRing get output blobs failed.");
+
+            std::shared_ptr<RingState> state = std::make_shared<RingState>();
+            state->slots_.resize(depth);
+            for (auto &slot : state->slots_) {
+                for (size_t i = 0; i < input_size; ++i) {
+                    Blob *blob = CreateSlotBlob(input_arr[i]);
+                    if (blob == nullptr) {
+                        return RS_INVALID_MODEL;
+                    }
+                    slot.inputs_.push_back(blob);
+                }
+                for (size_t i = 0; i < output_size; ++i) {
+                    Blob *blob = CreateSlotBlob(output_arr[i]);
+                    if (blob == nullptr) {
+                        return RS_INVALID_MODEL;
+                    }
+                    slot.outputs_.push_back(blob);
+                }
+            }
+
+            inference_ = inference;
+            state_ = state;
+            RS_LOGD("BlobRing create %d slots, %zu inputs %zu outputs\n", depth, input_size,
+                    output_size);
+            return RS_SUCCESS;
+        }
+
+        void BlobRing::DeInit() {
+            if (state_ != nullptr) {
+                std::lock_guard<std::mutex> lock(state_->mutex_);
+                for (auto &slot : state_->slots_) {
+                    if (slot.refs_ > 0) {
+                        RS_LOGW("BlobRing DeInit with slot still referenced\n");
+                        break;
+                    }
+                }
+            }
+            state_ = nullptr;
+            inference_ = nullptr;
+        }
+
+        ErrorCode BlobRing::Acquire(int *slot, int timeout_ms) {
+            if (slot == nullptr) {
+                RS_LOGE("slot is nullptr\n");
+                return RS_INVALID_PARAM;
+            }
+            if (state_ == nullptr) {
+                RS_LOGE("BlobRing is not initialized\n");
+                return RS_INVALID_MODEL;
+            }
+
+            int index = -1;
+            {
+                std::unique_lock<std::mutex> lock(state_->mutex_);
+                size_t depth = state_->slots_.size();
+                // 从上次位置往后找空闲槽位,保持轮转顺序
+                auto find_idle = [this, depth, &index]() {
+                    for (size_t i = 0; i < depth; ++i) {
+                        size_t k = (state_->next_ + i) % depth;
+                        if (state_->slots_[k].refs_ == 0) {
+                            index = static_cast<int>(k);
+                            return true;
+                        }
+                    }
+                    return false;
+                };
+                if (timeout_ms < 0) {
+                    state_->cond_.wait(lock, find_idle);
+                } else if (!state_->cond_.wait_for(lock, std::chrono::milliseconds(timeout_ms),
+                                                   find_idle)) {
+                    return RS_INFERENCE_TIMEOUT;
+                }
+                state_->slots_[index].refs_ = 1;
+                state_->slots_[index].producer_ = true;
+                state_->next_ = (index + 1) % depth;
+            }
+
+            RingState::Slot &acquired = state_->slots_[index];
+            ErrorCode ret = RS_SUCCESS;
+            for (size_t i = 0; i < acquired.inputs_.size() && ret == RS_SUCCESS; ++i) {
+                ret = inference_->BindInput(i, acquired.inputs_[i]->buffer);
+            }
+            for (size_t i = 0; i < acquired.outputs_.size() && ret == RS_SUCCESS; ++i) {
+                ret = inference_->BindOutput(i, acquired.outputs_[i]->buffer);
+            }
+            if (ret != RS_SUCCESS) {
+                RS_LOGE("BlobRing bind slot:%d to inference failed:%d\n", index, ret);
+                state_->Unref(index, true);
+                return ret;
+            }
+
+            *slot = index;
+            return RS_SUCCESS;
+        }
+
+        ErrorCode BlobRing::Release(int slot) {
+            if (state_ == nullptr || slot < 0 || slot >= (int)state_->slots_.size()) {
+                RS_LOGE("BlobRing release invalid slot:%d\n", slot);
+                return RS_INVALID_PARAM;
+            }
+            if (state_->Unref(slot, true) != RS_SUCCESS) {
+                RS_LOGE("BlobRing slot:%d is not acquired or released twice\n", slot);
+                return RS_INVALID_PARAM;
+            }
+            return RS_SUCCESS;
+        }
+
+        ErrorCode BlobRing::InputBlobGet(int slot, size_t index, Blob **blob) {
+            if (state_ == nullptr || blob == nullptr || slot < 0
+                || slot >= (int)state_->slots_.size()
+                || index >= state_->slots_[slot].inputs_.size()) {
+                RS_LOGE("BlobRing get input slot:%d index:%zu invalid\n", slot, index);
+                return RS_INVALID_PARAM;
+            }
+            *blob = state_->slots_[slot].inputs_[index];
+            return RS_SUCCESS;
+        }
+
+        ErrorCode BlobRing::OutputBlobGet(int slot, size_t index, const Blob **blob) {
+            if (state_ == nullptr || blob == nullptr || slot < 0
+                || slot >= (int)state_->slots_.size()
+                || index >= state_->slots_[slot].outputs_.size()) {
+                RS_LOGE("BlobRing get output slot:%d index:%zu invalid\n", slot, index);
+                return RS_INVALID_PARAM;
+            }
+            *blob = state_->slots_[slot].outputs_[index];
+            return RS_SUCCESS;
+        }
+
+        Buffer *BlobRing::OutputBufferShare(int slot, size_t index) {
+            const Blob *blob = nullptr;
+            if (OutputBlobGet(slot, index, &blob) != RS_SUCCESS) {
+                return nullptr;
+            }
+            {
+                std::lock_guard<std::mutex> lock(state_->mutex_);
+                if (state_->slots_[slot].refs_ <= 0) {
+                    RS_LOGE("BlobRing slot:%d is not acquired\n", slot);
+                    return nullptr;
+                }
+                state_->slots_[slot].refs_++;
+            }
+            return new RingState::SlotBuffer(blob->buffer->GetDataPtr(),
+                                             blob->buffer->GetMemoryInfo(), state_, slot);
+        }
+
+        int BlobRing::Depth() {
+            return state_ != nullptr ? static_cast<int>(state_->slots_.size()) : 0;
+        }
+
+        int BlobRing::IdleSize() {
+            if (state_ == nullptr) {
+                return 0;
+            }
+            std::lock_guard<std::mutex> lock(state_->mutex_);
+            int idle = 0;
+            for (auto &slot : state_->slots_) {
+                idle += slot.refs_ == 0 ? 1 : 0;
+            }
+            return idle;
+        }
+
+    } // namespace inference
+} // namespace rayshape
@@ -1,4 +1,16 @@
 #include "inference/inference.h"
+#include "thread_pool/thread_pool.h"
+#include "utils/blob_utils.h"
+#include "utils/debug_utils.h"
+#ifdef ENABLE_OPENVINO_MODEL
+#include "model/openvino/openvino_model.h"
+#endif
+#ifdef ENABLE_ONNX_MODEL
+#include "model/onnx/onnx_model.h"
+#endif
+#ifdef ENABLE_MNN_MODEL
+#include "model/mnn/mnn_model.h"
+#endif
 
 namespace rayshape
 {
@@ -14,6 +26,270 @@ namespace rayshape
             return type_;
         }
 
+        std::shared_ptr<Inference> Inference::Clone() {
+            return nullptr;
+        }
+
+        static std::string ShapeString(const std::map<std::string, Dims> &shapes) {
+            std::string str;
+            for (const auto &it : shapes) {
+                str += it.first + "[";
+                for (int i = 0; i < it.second.size; ++i) {
+                    str += (i > 0 ? "," : "") + std::to_string(it.second.value[i]);
+                }
+                str += "]";
+            }
+            return str;
+        }
+
+        // 只有尺寸变化时才Reshape,静态模型在当前尺寸上预热不会因Reshape未实现而失败
+        static ErrorCode ReshapeIfChanged(Inference *inference,
+                                          const std::map<std::string, Dims> &shapes) {
+            const Blob **blob_arr = nullptr;
+            size_t blob_size = 0;
+            CHECK_RET(inference->InputBlobsGet(&blob_arr, &blob_size))
+
+            std::vector<const char *> names;
+            std::vector<Dims> dims;
+            bool changed = false;
+            for (size_t i = 0; i < blob_size; ++i) {
+                auto iter = shapes.find(blob_arr[i]->name);
+                const Dims &target = iter != shapes.end() ? iter->second : blob_arr[i]->dims;
+                changed = changed || memcmp(&target, &blob_arr[i]->dims, sizeof(Dims)) != 0;
+                names.push_back(blob_arr[i]->name);
+                dims.push_back(target);
+            }
+            if (!changed) {
+                return RS_SUCCESS;
+            }
+            return inference->Reshape(names.data(), dims.data(), names.size());
+        }
+
+        static ErrorCode WarmupShape(Inference *inference, const std::map<std::string, Dims> &shapes,
+                                     int iterations) {
+            ErrorCode ret = ReshapeIfChanged(inference, shapes);
+            if (ret != RS_SUCCESS) {
+                RS_LOGE("warmup reshape to %s failed:%d\n", ShapeString(shapes).c_str(), ret);
+                return ret;
+            }
+
+            const Blob **blob_arr = nullptr;
+            size_t blob_size = 0;
+            CHECK_RET(inference->InputBlobsGet(&blob_arr, &blob_size))
+            std::map<std::string, Dims> current;
+            for (size_t i = 0; i < blob_size; ++i) {
+                const Blob *blob = blob_arr[i];
+                current[blob->name] = blob->dims;
+                void *data = blob->buffer != nullptr ? blob->buffer->GetDataPtr() : nullptr;
+                // 非host内存的输入内容不影响预热,不填充
+                if (data != nullptr && blob->buffer->GetMemoryType() == MemoryType::HOST) {
+                    memset(data, 0, utils::CalculateMemorySize(blob->dims, blob->data_type));
+                }
+            }
+
+            double cold_ms = 0;
+            double warm_ms = 0;
+            for (int i = 0; i < iterations; ++i) {
+                auto start = std::chrono::steady_clock::now();
+                ret = inference->Forward();
+                double cost_ms = std::chrono::duration<double, std::milli>(
+                                     std::chrono::steady_clock::now() - start)
+                                     .count();
+                if (ret != RS_SUCCESS) {
+                    RS_LOGE("warmup forward %s failed:%d\n", ShapeString(current).c_str(), ret);
+                    return ret;
+                }
+                if (i == 0) {
+                    cold_ms = cost_ms;
+                } else {
+                    warm_ms += cost_ms;
+                }
+            }
+            if (iterations > 1) {
+                RS_LOGI("warmup %s cold:%.3fms warm:%.3fms(avg of %d)\n",
+                        ShapeString(current).c_str(), cold_ms, warm_ms / (iterations - 1),
+                        iterations - 1);
+            } else {
+                RS_LOGI("warmup %s cold:%.3fms\n", ShapeString(current).c_str(), cold_ms);
+            }
+            return RS_SUCCESS;
+        }
+
+        ErrorCode Inference::Warmup(int iterations,
+                                    const std::vector<std::map<std::string, Dims>> &shapes) {
+            if (iterations <= 0) {
+                RS_LOGE("warmup iterations:%d <= 0\n", iterations);
+                return RS_INVALID_PARAM;
+            }
+
+            const Blob **blob_arr = nullptr;
+            size_t blob_size = 0;
+            CHECK_RET(InputBlobsGet(&blob_arr, &blob_size))
+            std::map<std::string, Dims> origin_shapes;
+            for (size_t i = 0; i < blob_size; ++i) {
+                origin_shapes[blob_arr[i]->name] = blob_arr[i]->dims;
+            }
+
+            std::vector<std::map<std::string, Dims>> warmup_shapes = shapes;
+            if (warmup_shapes.empty()) {
+                CHECK_RET(WarmupShapesGet(warmup_shapes))
+            }
+            if (warmup_shapes.empty()) {
+                warmup_shapes.push_back(origin_shapes);
+            }
+
+            ErrorCode ret = RS_SUCCESS;
+            std::set<std::string> warmed; // 最小与最大尺寸相同等重复尺寸只预热一次
+            for (const auto &warmup_shape : warmup_shapes) {
+                if (!warmed.insert(ShapeString(warmup_shape)).second) {
+                    continue;
+                }
+                ret = WarmupShape(this, warmup_shape, iterations);
+                if (ret != RS_SUCCESS) {
+                    break;
+                }
+            }
+
+            // 恢复预热前的输入尺寸
+            ErrorCode restore_ret = ReshapeIfChanged(this, origin_shapes);
+            if (restore_ret != RS_SUCCESS) {
+                RS_LOGE("warmup restore shape %s failed:%d\n", ShapeString(origin_shapes).c_str(),
+                        restore_ret);
+                return restore_ret;
+            }
+            return ret;
+        }
+
+        ErrorCode Inference::WarmupShapesGet(std::vector<std::map<std::string, Dims>> &shapes) {
+            shapes.clear();
+            return RS_SUCCESS;
+        }
+
+        ErrorCode Inference::InputIndexGet(const char *input_name, size_t *index) {
+            const Blob **blob_arr = nullptr;
+            size_t blob_size = 0;
+            if (input_name == nullptr || index == nullptr) {
+                RS_LOGE("input_name:%p or index:%p is nullptr\n", input_name, index);
+                return RS_INVALID_PARAM;
+            }
+            CHECK_RET(InputBlobsGet(&blob_arr, &blob_size))
+            int blob_index = -1;
+            utils::FindBlobAndIndexByName((Blob **)blob_arr, blob_size, input_name, &blob_index);
+            if (blob_index < 0) {
+                RS_LOGE("Not find input Blob name:%s\n", input_name);
+                return RS_INVALID_PARAM;
+            }
+            *index = static_cast<size_t>(blob_index);
+            return RS_SUCCESS;
+        }
+
+        ErrorCode Inference::OutputIndexGet(const char *output_name, size_t *index) {
+            const Blob **blob_arr = nullptr;
+            size_t blob_size = 0;
+            if (output_name == nullptr || index == nullptr) {
+                RS_LOGE("output_name:%p or index:%p is nullptr\n", output_name, index);
+                return RS_INVALID_PARAM;
+            }
+            CHECK_RET(OutputBlobsGet(&blob_arr, &blob_size))
+            int blob_index = -1;
+            utils::FindBlobAndIndexByName((Blob **)blob_arr, blob_size, output_name, &blob_index);
+            if (blob_index < 0) {
+                RS_LOGE("Not find output Blob name:%s\n", output_name);
+                return RS_INVALID_PARAM;
+            }
+            *index = static_cast<size_t>(blob_index);
+            return RS_SUCCESS;
+        }
+
+        ErrorCode Inference::BindInput(size_t /*index*/, Buffer * /*buffer*/) {
+            RS_LOGE("inference type:%d does not support BindInput\n", (int)type_);
+            return RS_NOT_IMPLEMENT;
+        }
+
+        ErrorCode Inference::BindOutput(size_t /*index*/, Buffer * /*buffer*/) {
+            RS_LOGE("inference type:%d does not support BindOutput\n", (int)type_);
+            return RS_NOT_IMPLEMENT;
+        }
+
+        // 无原生异步接口的推理引擎共用的线程池,首次ForwardAsync时按GlobalRuntime创建
+        static threadpool::ThreadPool *GetAsyncThreadPool() {
+            static std::once_flag once;
+            static threadpool::ThreadPool *thread_pool = nullptr;
+            std::call_once(once, []() {
+                int num_thread = ApplyGlobalRuntime().async_num_thread_;
+                if (num_thread <= 0) {
+                    num_thread = std::max(1u, std::thread::hardware_concurrency());
+                }
+                thread_pool = new threadpool::ThreadPool(num_thread);
+                thread_pool->Init();
+            });
+            return thread_pool;
+        }
+
+        ErrorCode Inference::ForwardAsync(ForwardCallback callback) {
+            {
+                std::lock_guard<std::mutex> lock(async_mutex_);
+                if (async_pending_) {
+                    RS_LOGE("previous ForwardAsync is not finished\n");
+                    return RS_INFERENCE_BUSY;
+                }
+                async_pending_ = true;
+                async_callback_ = callback;
+            }
+
+            ErrorCode ret = StartForward();
+            if (ret != RS_SUCCESS) {
+                RS_LOGE("StartForward failed:%d\n", ret);
+                {
+                    std::lock_guard<std::mutex> lock(async_mutex_);
+                    async_pending_ = false;
+                    async_callback_ = nullptr;
+                }
+                async_cond_.notify_all();
+            }
+            return ret;
+        }
+
+        std::future<ErrorCode> Inference::ForwardAsync() {
+            auto promise = std::make_shared<std::promise<ErrorCode>>();
+            std::future<ErrorCode> future = promise->get_future();
+            ErrorCode ret = ForwardAsync([promise](ErrorCode status) { promise->set_value(status); });
+            if (ret != RS_SUCCESS) {
+                promise->set_value(ret);
+            }
+            return future;
+        }
+
+        ErrorCode Inference::Wait() {
+            std::unique_lock<std::mutex> lock(async_mutex_);
+            async_cond_.wait(lock, [this]() { return !async_pending_; });
+            return async_ret_;
+        }
+
+        ErrorCode Inference::StartForward() {
+            GetAsyncThreadPool()->Commit([this]() { FinishForward(Forward()); });
+            return RS_SUCCESS;
+        }
+
+        void Inference::FinishForward(ErrorCode ret) {
+            ForwardCallback callback = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(async_mutex_);
+                callback = std::move(async_callback_);
+                async_callback_ = nullptr;
+                async_ret_ = ret;
+            }
+            // 回调结束后才唤醒Wait,保证Wait返回时回调中的结果已可见
+            if (callback) {
+                callback(ret);
+            }
+            {
+                std::lock_guard<std::mutex> lock(async_mutex_);
+                async_pending_ = false;
+            }
+            async_cond_.notify_all();
+        }
+
         std::map<InferenceType, std::shared_ptr<InferenceCreator>> &GetGlobalInferenceCreatorMap() {
             static std::once_flag once;
             static std::shared_ptr<std::map<InferenceType, std::shared_ptr<InferenceCreator>>>
@@ -33,5 +309,53 @@ namespace rayshape
             return temp;
         }
 
+        const std::string *GetModelConfig(const Model *model) {
+#ifdef ENABLE_OPENVINO_MODEL
+            if (auto openvino_model = dynamic_cast<const OpenVINOModel *>(model)) {
+                return &openvino_model->cfg_str_;
+            }
+#endif
+#ifdef ENABLE_ONNX_MODEL
+            if (auto onnx_model = dynamic_cast<const ONNXModel *>(model)) {
+                return &onnx_model->cfg_str_;
+            }
+#endif
+#ifdef ENABLE_MNN_MODEL
+            if (auto mnn_model = dynamic_cast<const MNNModel *>(model)) {
+                return &mnn_model->cfg_str_;
+            }
+#endif
+            return nullptr;
+        }
+
+        static std::mutex g_global_runtime_mutex;
+        static GlobalRuntime g_global_runtime;
+        static bool g_global_runtime_applied = false; // 已按g_global_runtime创建了进程级资源
+
+        ErrorCode SetGlobalRuntime(const GlobalRuntime *runtime) {
+            if (runtime == nullptr) {
+                RS_LOGE("global runtime is nullptr!\n");
+                return RS_INVALID_PARAM;
+            }
+            std::lock_guard<std::mutex> lock(g_global_runtime_mutex);
+            if (g_global_runtime_applied) {
+                RS_LOGE("global runtime is already applied, set it before the first Init\n");
+                return RS_INVALID_PARAM;
+            }
+            g_global_runtime = *runtime;
+            return RS_SUCCESS;
+        }
+
+        GlobalRuntime GetGlobalRuntime() {
+            std::lock_guard<std::mutex> lock(g_global_runtime_mutex);
+            return g_global_runtime;
+        }
+
+        GlobalRuntime ApplyGlobalRuntime() {
+            std::lock_guard<std::mutex> lock(g_global_runtime_mutex);
+            g_global_runtime_applied = true;
+            return g_global_runtime;
+        }
+
     } // namespace inference
 } // namespace rayshape
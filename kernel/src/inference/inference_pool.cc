@@ -0,0 +1,129 @@
+#include "inference/inference_pool.h"
+#include "base/logger.h"
+
+namespace rayshape
+{
+    namespace inference
+    {
+        InferencePool::InferencePool(InferenceType type) : type_(type) {}
+
+        InferencePool::~InferencePool() {
+            DeInit();
+        }
+
+        ErrorCode InferencePool::Init(const Model *model, const CustomRuntime *runtime,
+                                      size_t pool_size) {
+            if (model == nullptr || runtime == nullptr || pool_size == 0) {
+                RS_LOGE("model:%p runtime:%p is nullptr or pool_size:%zu is 0\n", model, runtime,
+                        pool_size);
+                return RS_INVALID_PARAM;
+            }
+
+            DeInit();
+
+            std::vector<std::shared_ptr<Inference>> contexts;
+            std::shared_ptr<Inference> first = CreateInference(type_);
+            if (first == nullptr) {
+                RS_LOGE("CreateInference type:%d failed\n", (int)type_);
+                return RS_INVALID_PARAM;
+            }
+            ErrorCode ret = first->Init(model, runtime);
+            RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "InferencePool init first context failed.");
+            contexts.push_back(first);
+
+            for (size_t i = 1; i < pool_size; ++i) {
+                std::shared_ptr<Inference> context = first->Clone();
+                if (context == nullptr) {
+                    // 后端不支持共享编译模型,单独加载
+                    if (i == 1) {
+                        RS_LOGW("inference type:%d does not support Clone, each context loads "
+                                "its own model\n",
+                                (int)type_);
+                    }
+                    context = CreateInference(type_);
+                    if (context == nullptr) {
+                        RS_LOGE("CreateInference type:%d failed\n", (int)type_);
+                        return RS_INVALID_PARAM;
+                    }
+                    ret = context->Init(model, runtime);
+                    RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "InferencePool init context failed.");
+                }
+                contexts.push_back(context);
+            }
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            contexts_ = contexts;
+            idle_contexts_.assign(contexts.begin(), contexts.end());
+            RS_LOGD("InferencePool type:%d create %zu contexts\n", (int)type_, pool_size);
+            return RS_SUCCESS;
+        }
+
+        void InferencePool::DeInit() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto &context : idle_contexts_) {
+                context->DeInit();
+            }
+            if (idle_contexts_.size() != contexts_.size()) {
+                RS_LOGW("InferencePool DeInit with %zu contexts still acquired\n",
+                        contexts_.size() - idle_contexts_.size());
+            }
+            idle_contexts_.clear();
+            contexts_.clear();
+        }
+
+        ErrorCode InferencePool::Acquire(std::shared_ptr<Inference> &inference, int timeout_ms) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (contexts_.empty()) {
+                RS_LOGE("InferencePool is not initialized\n");
+                return RS_INVALID_MODEL;
+            }
+
+            auto has_idle = [this]() { return !idle_contexts_.empty(); };
+            if (timeout_ms < 0) {
+                cond_.wait(lock, has_idle);
+            } else if (!cond_.wait_for(lock, std::chrono::milliseconds(timeout_ms), has_idle)) {
+                return RS_INFERENCE_TIMEOUT;
+            }
+
+            inference = idle_contexts_.front();
+            idle_contexts_.pop_front();
+            return RS_SUCCESS;
+        }
+
+        ErrorCode InferencePool::Release(const std::shared_ptr<Inference> &inference) {
+            if (inference == nullptr) {
+                RS_LOGE("release inference is nullptr\n");
+                return RS_INVALID_PARAM;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (std::find(contexts_.begin(), contexts_.end(), inference) == contexts_.end()) {
+                    // 池已DeInit或不是本池的实例
+                    RS_LOGW("release inference does not belong to pool\n");
+                    inference->DeInit();
+                    return RS_INVALID_PARAM;
+                }
+                if (std::find(idle_contexts_.begin(), idle_contexts_.end(), inference)
+                    != idle_contexts_.end()) {
+                    RS_LOGE("inference is released twice\n");
+                    return RS_INVALID_PARAM;
+                }
+                idle_contexts_.push_back(inference);
+            }
+            cond_.notify_one();
+            return RS_SUCCESS;
+        }
+
+        size_t InferencePool::Size() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return contexts_.size();
+        }
+
+        size_t InferencePool::IdleSize() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return idle_contexts_.size();
+        }
+
+    } // namespace inference
+} // namespace rayshape
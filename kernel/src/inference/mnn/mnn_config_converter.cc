@@ -146,6 +146,78 @@ namespace rayshape
             return RS_SUCCESS;
         }
 
+        ErrorCode MNNConfigConverter::ConvertFromPrecision(MNN::BackendConfig::PrecisionMode &dst,
+                                                           const Precision src) {
+            switch (src) {
+            case Precision::AUTO:
+                break;
+            case Precision::NORMAL:
+                dst = MNN::BackendConfig::Precision_Normal;
+                break;
+            case Precision::HIGH:
+                dst = MNN::BackendConfig::Precision_High;
+                break;
+            case Precision::LOW:
+            case Precision::FP16:
+                dst = MNN::BackendConfig::Precision_Low;
+                break;
+            case Precision::BF16:
+                dst = MNN::BackendConfig::Precision_Low_BF16;
+                break;
+            default:
+                RS_LOGE("Unsupported Precision: %d\n", (int)src);
+                return RS_INVALID_PARAM_VALUE;
+            }
+            return RS_SUCCESS;
+        }
+
+        ErrorCode MNNConfigConverter::ConvertToPrecisionMode(
+            MNN::BackendConfig::PrecisionMode &dst, const std::string &src) {
+            if ("normal" == src) {
+                dst = MNN::BackendConfig::Precision_Normal;
+            } else if ("high" == src) {
+                dst = MNN::BackendConfig::Precision_High;
+            } else if ("low" == src) {
+                dst = MNN::BackendConfig::Precision_Low;
+            } else if ("low_bf16" == src) {
+                dst = MNN::BackendConfig::Precision_Low_BF16;
+            } else {
+                RS_LOGE("Unsupported PrecisionMode: %s\n", src.c_str());
+                return RS_INVALID_PARAM_VALUE;
+            }
+            return RS_SUCCESS;
+        }
+
+        ErrorCode MNNConfigConverter::ConvertToMemoryMode(MNN::BackendConfig::MemoryMode &dst,
+                                                          const std::string &src) {
+            if ("normal" == src) {
+                dst = MNN::BackendConfig::Memory_Normal;
+            } else if ("high" == src) {
+                dst = MNN::BackendConfig::Memory_High;
+            } else if ("low" == src) {
+                dst = MNN::BackendConfig::Memory_Low;
+            } else {
+                RS_LOGE("Unsupported MemoryMode: %s\n", src.c_str());
+                return RS_INVALID_PARAM_VALUE;
+            }
+            return RS_SUCCESS;
+        }
+
+        ErrorCode MNNConfigConverter::ConvertToPowerMode(MNN::BackendConfig::PowerMode &dst,
+                                                         const std::string &src) {
+            if ("normal" == src) {
+                dst = MNN::BackendConfig::Power_Normal;
+            } else if ("high" == src) {
+                dst = MNN::BackendConfig::Power_High;
+            } else if ("low" == src) {
+                dst = MNN::BackendConfig::Power_Low;
+            } else {
+                RS_LOGE("Unsupported PowerMode: %s\n", src.c_str());
+                return RS_INVALID_PARAM_VALUE;
+            }
+            return RS_SUCCESS;
+        }
+
         DataFormat MNNConfigConverter::ConvertToDataFormat(const std::string &src) {
             if (src == "NCHW" || src == "nchw") {
                 return DataFormat::NCHW;
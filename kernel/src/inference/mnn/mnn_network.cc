@@ -1,8 +1,10 @@
 #include "inference/mnn/mnn_network.h"
 #include "inference/mnn/mnn_blob_converter.h"
 #include "inference/mnn/mnn_config_converter.h"
+#include "inference/precision.h"
 #include "model/mnn/mnn_model.h"
 #include "utils/blob_utils.h"
+#include "utils/debug_utils.h"
 #include "base/logger.h"
 
 using namespace rayshape::mnn;
@@ -19,6 +21,7 @@ namespace rayshape
         MNNNetwork::MNNNetwork(InferenceType type) : Inference(type) {}
 
         MNNNetwork::~MNNNetwork() {
+            Wait();
             ClearBlobArray();
         }
 
@@ -34,6 +37,7 @@ namespace rayshape
 
             device_type_ = runtime->device_type_;
             num_threads_ = runtime->num_thread_;
+            precision_ = runtime->precision_;
 
             auto mnn_model = dynamic_cast<const MNNModel *>(model);
             if (mnn_model == nullptr) {
@@ -53,6 +57,16 @@ namespace rayshape
                     break;
                 }
 
+                if ((ret = ParsePrecision(json_handle, precision_)) != RS_SUCCESS) {
+                    RS_LOGE("ParsePrecision failed:%d!\n", ret);
+                    break;
+                }
+
+                if ((ret = ParseSessionConfig(json_handle)) != RS_SUCCESS) {
+                    RS_LOGE("ParseSessionConfig failed:%d!\n", ret);
+                    break;
+                }
+
                 if ((ret = InitWithModel(mnn_model->bin_buf_)) != RS_SUCCESS) {
                     RS_LOGE("InitWithModel failed:%d!\n", ret);
                     break;
@@ -78,17 +92,48 @@ namespace rayshape
         }
 
         void MNNNetwork::DeInit() {
-            // TODO: Implement resource cleanup
             ClearBlobArray();
 
-            if (session_ != nullptr) {
-                interpreter_->releaseSession(session_);
-                session_ = nullptr;
+            if (interpreter_ != nullptr) {
+                std::lock_guard<std::mutex> lock(*interpreter_mutex_);
+                for (auto &it : session_cache_) {
+                    interpreter_->releaseSession(it.second);
+                }
             }
+            session_cache_.clear();
+            session_ = nullptr;
+            input_shapes_.clear();
 
             interpreter_.reset();
         }
 
+        std::shared_ptr<Inference> MNNNetwork::Clone() {
+            if (interpreter_ == nullptr || session_ == nullptr) {
+                RS_LOGE("MNN interpreter or session is null, can not clone\n");
+                return nullptr;
+            }
+
+            // 共享interpreter_中的模型权重,每个实例创建自己的session
+            auto network = std::make_shared<MNNNetwork>(type_);
+            network->device_type_ = device_type_;
+            network->num_threads_ = num_threads_;
+            network->precision_ = precision_;
+            network->cache_file_ = cache_file_;
+            network->session_cache_size_ = session_cache_size_;
+            network->interpreter_ = interpreter_;
+            network->interpreter_mutex_ = interpreter_mutex_;
+            network->schedule_config_ = schedule_config_;
+            network->backend_config_ = backend_config_;
+            network->schedule_config_.backendConfig = &network->backend_config_;
+            network->input_max_shapes_ = input_max_shapes_;
+            if (network->SwitchSession(input_shapes_) != RS_SUCCESS
+                || network->CreateBlobArray() != RS_SUCCESS) {
+                RS_LOGE("MNN clone create session failed\n");
+                return nullptr;
+            }
+            return network;
+        }
+
         ErrorCode MNNNetwork::InitWithModel(const std::string &model_buf) {
             ErrorCode ret = RS_SUCCESS;
 
@@ -100,29 +145,18 @@ namespace rayshape
                     RS_LOGE("Failed to create MNN interpreter from buffer\n");
                     return RS_MODEL_ERROR;
                 }
+                interpreter_mutex_ = std::make_shared<std::mutex>();
 
-                // Configure backend
-                MNN::BackendConfig backend_config;
-                MNNForwardType forward_type;
-                ret = MNNConfigConverter::ConvertFromDevice(device_type_, backend_config,
-                                                            forward_type);
+                ret = InitBackendConfig();
                 if (ret != RS_SUCCESS) {
-                    RS_LOGE("ConvertFromDevice failed:%d\n", ret);
+                    RS_LOGE("InitBackendConfig failed:%d\n", ret);
                     return ret;
                 }
 
-                // Setup schedule config
-                schedule_config_.type = forward_type;
-                schedule_config_.numThread = num_threads_;
-                schedule_config_.backendConfig = &backend_config;
-
-                // Create session
-                session_ = interpreter_->createSession(schedule_config_);
-                if (session_ == nullptr) {
-                    RS_LOGE("Failed to create MNN session\n");
-                    return RS_MODEL_ERROR;
+                // 缓存文件需在createSession之前设置,保存GPU等后端的kernel编译/调优结果
+                if (!cache_file_.empty()) {
+                    interpreter_->setCacheFile(cache_file_.c_str());
                 }
-
             } catch (const std::exception &e) {
                 RS_LOGE("MNN model initialization failed: %s\n", e.what());
                 return RS_MODEL_ERROR;
@@ -132,9 +166,6 @@ namespace rayshape
         }
 
         ErrorCode MNNNetwork::ParseInputShapes(const RSJsonHandle json_handle) {
-            // TODO: Implement input shape parsing from JSON
-            ErrorCode ret = RS_SUCCESS;
-
             RSJsonObject root_obj = RSJsonRootGet(json_handle);
             RSJsonObject model_obj = RSJsonObjectGet(root_obj, "ModelConfig");
             if (model_obj == nullptr) {
@@ -182,41 +213,229 @@ namespace rayshape
             return RS_SUCCESS;
         }
 
-        ErrorCode MNNNetwork::Reshape(const char **name_arr, const Dims *dims_arr,
-                                      size_t dims_size) {
-            // TODO: Implement dynamic reshape
+        ErrorCode MNNNetwork::ParseSessionConfig(const RSJsonHandle json_handle) {
+            RSJsonObject root_obj = RSJsonRootGet(json_handle);
+            RSJsonObject network_obj = RSJsonObjectGet(root_obj, "NetworkConfig");
+            if (network_obj == nullptr) {
+                return RS_SUCCESS;
+            }
+            RSJsonObject session_obj = RSJsonObjectGet(network_obj, "SessionConfig");
+            if (session_obj == nullptr) {
+                return RS_SUCCESS;
+            }
+
+            const char *precision = RSJsonStringGet(RSJsonObjectGet(session_obj, "PrecisionMode"));
+            precision_mode_ = precision != nullptr ? precision : "";
+            const char *memory = RSJsonStringGet(RSJsonObjectGet(session_obj, "MemoryMode"));
+            memory_mode_ = memory != nullptr ? memory : "";
+            const char *power = RSJsonStringGet(RSJsonObjectGet(session_obj, "PowerMode"));
+            power_mode_ = power != nullptr ? power : "";
+            const char *cache_file = RSJsonStringGet(RSJsonObjectGet(session_obj, "CacheFile"));
+            cache_file_ = cache_file != nullptr ? cache_file : "";
+
+            session_cache_size_ = RSJsonIntGet(RSJsonObjectGet(session_obj, "SessionCacheSize"), 4);
+            if (session_cache_size_ <= 0) {
+                RS_LOGE("SessionConfig SessionCacheSize:%d must > 0!\n", session_cache_size_);
+                return RS_INVALID_PARAM_VALUE;
+            }
+
+            RS_LOGD("SessionConfig precision:%s memory:%s power:%s cache:%s cache_size:%d\n",
+                    precision_mode_.c_str(), memory_mode_.c_str(), power_mode_.c_str(),
+                    cache_file_.c_str(), session_cache_size_);
+            return RS_SUCCESS;
+        }
+
+        ErrorCode MNNNetwork::InitBackendConfig() {
             ErrorCode ret = RS_SUCCESS;
+            MNNForwardType forward_type;
+
+            // 优先级: SessionConfig/PrecisionMode > CustomRuntime::precision_ >
+            // NetworkConfig/Precision > 设备默认值
+            ret = MNNConfigConverter::ConvertFromDevice(device_type_, backend_config_,
+                                                        forward_type);
+            RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "ConvertFromDevice failed.");
+
+            ret = MNNConfigConverter::ConvertFromPrecision(backend_config_.precision, precision_);
+            RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "ConvertFromPrecision failed.");
+
+            if (!precision_mode_.empty()) {
+                ret = MNNConfigConverter::ConvertToPrecisionMode(backend_config_.precision,
+                                                                 precision_mode_);
+                RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "SessionConfig PrecisionMode is invalid.");
+            }
+            if (!memory_mode_.empty()) {
+                ret = MNNConfigConverter::ConvertToMemoryMode(backend_config_.memory,
+                                                              memory_mode_);
+                RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "SessionConfig MemoryMode is invalid.");
+            }
+            if (!power_mode_.empty()) {
+                ret = MNNConfigConverter::ConvertToPowerMode(backend_config_.power, power_mode_);
+                RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "SessionConfig PowerMode is invalid.");
+            }
+
+            schedule_config_.type = forward_type;
+            schedule_config_.numThread = num_threads_ > 0 ? num_threads_ : 4;
+            schedule_config_.backendConfig = &backend_config_;
+
+            return RS_SUCCESS;
+        }
+
+        std::string MNNNetwork::ShapeKey(const std::map<std::string, Dims> &input_shapes) {
+            std::string key;
+            for (const auto &it : input_shapes) {
+                key += it.first;
+                key += ":";
+                for (int i = 0; i < it.second.size; ++i) {
+                    key += std::to_string(it.second.value[i]);
+                    key += (i + 1 < it.second.size) ? "x" : "";
+                }
+                key += ";";
+            }
+            return key;
+        }
+
+        ErrorCode MNNNetwork::CreateSession(const std::map<std::string, Dims> &input_shapes,
+                                            MNN::Session **session) {
+            std::lock_guard<std::mutex> lock(*interpreter_mutex_);
+            MNN::Session *new_session = nullptr;
+            try {
+                new_session = interpreter_->createSession(schedule_config_);
+                if (new_session == nullptr) {
+                    RS_LOGE("Failed to create MNN session\n");
+                    return RS_MODEL_ERROR;
+                }
+
+                if (!input_shapes.empty()) {
+                    for (const auto &it : input_shapes) {
+                        MNN::Tensor *tensor =
+                            interpreter_->getSessionInput(new_session, it.first.c_str());
+                        if (tensor == nullptr) {
+                            RS_LOGE("MNN session has no input:%s\n", it.first.c_str());
+                            interpreter_->releaseSession(new_session);
+                            return RS_INVALID_PARAM;
+                        }
+                        std::vector<int> shape;
+                        MNNConfigConverter::ConvertFromDims(shape, it.second);
+                        interpreter_->resizeTensor(tensor, shape);
+                    }
+                    interpreter_->resizeSession(new_session);
+                }
+            } catch (const std::exception &e) {
+                RS_LOGE("MNN create session failed: %s\n", e.what());
+                if (new_session != nullptr) {
+                    interpreter_->releaseSession(new_session);
+                }
+                return RS_MODEL_ERROR;
+            }
+
+            if (!cache_file_.empty()) {
+                MNN::ErrorCode mnn_ret = interpreter_->updateCacheFile(new_session);
+                if (mnn_ret != MNN::NO_ERROR) {
+                    RS_LOGW("MNN updateCacheFile:%s failed:%d\n", cache_file_.c_str(), mnn_ret);
+                }
+            }
+
+            *session = new_session;
+            return RS_SUCCESS;
+        }
+
+        ErrorCode MNNNetwork::SwitchSession(const std::map<std::string, Dims> &input_shapes) {
+            std::string key = ShapeKey(input_shapes);
+            for (auto it = session_cache_.begin(); it != session_cache_.end(); ++it) {
+                if (it->first == key) {
+                    session_cache_.splice(session_cache_.begin(), session_cache_, it);
+                    session_ = session_cache_.front().second;
+                    input_shapes_ = input_shapes;
+                    return RS_SUCCESS;
+                }
+            }
+
+            MNN::Session *session = nullptr;
+            ErrorCode ret = CreateSession(input_shapes, &session);
+            RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "CreateSession failed.");
+
+            // 以session实际的输入尺寸作为key,保证未配置MaxShapes的输入也参与匹配
+            std::map<std::string, Dims> actual_shapes;
+            for (const auto &it : interpreter_->getSessionInputAll(session)) {
+                Dims dims;
+                MNNConfigConverter::ConvertToDims(dims, it.second->shape());
+                actual_shapes[it.first] = dims;
+            }
+            session_cache_.emplace_front(ShapeKey(actual_shapes), session);
+            while (session_cache_.size() > static_cast<size_t>(session_cache_size_)) {
+                RS_LOGD("MNN session cache evict shape:%s\n",
+                        session_cache_.back().first.c_str());
+                std::lock_guard<std::mutex> lock(*interpreter_mutex_);
+                interpreter_->releaseSession(session_cache_.back().second);
+                session_cache_.pop_back();
+            }
+
+            session_ = session;
+            input_shapes_ = actual_shapes;
+            return RS_SUCCESS;
+        }
 
-            if (name_arr == nullptr || dims_arr == nullptr) {
+        ErrorCode MNNNetwork::Reshape(const char **name_arr, const Dims *dims_arr,
+                                      size_t dims_size) {
+            if (name_arr == nullptr || dims_arr == nullptr || dims_size == 0) {
                 RS_LOGE("Invalid input parameters for Reshape.\n");
                 return RS_INVALID_PARAM;
             }
 
-            // MNN reshape implementation would go here
-            RS_LOGD("MNNNetwork::Reshape not fully implemented yet\n");
-            return RS_NOT_IMPLEMENT;
-        }
+            if (interpreter_ == nullptr || session_ == nullptr) {
+                RS_LOGE("MNN interpreter or session is null\n");
+                return RS_INVALID_MODEL;
+            }
 
-        ErrorCode MNNNetwork::Reshape() {
-            // TODO: Implement reshape with predefined shapes
-            ErrorCode ret = RS_SUCCESS;
+            std::map<std::string, Dims> input_shapes = input_shapes_;
+            for (size_t i = 0; i < dims_size; ++i) {
+                if (name_arr[i] == nullptr) {
+                    RS_LOGE("Reshape name_arr[%zu] is nullptr\n", i);
+                    return RS_INVALID_PARAM;
+                }
+                auto it = input_shapes.find(name_arr[i]);
+                if (it == input_shapes.end()) {
+                    RS_LOGE("Reshape input:%s not found\n", name_arr[i]);
+                    return RS_INVALID_PARAM;
+                }
 
-            if (input_max_shapes_.size() > 0) {
-                // Reshape based on max shapes
-                for (const auto &it : input_max_shapes_) {
-                    const std::string &name = it.first;
-                    const Dims &dims = it.second;
+                const Dims &dims = dims_arr[i];
+                if (dims.size != it->second.size) {
+                    RS_LOGE("Reshape input:%s dims size:%d != model dims size:%d\n", name_arr[i],
+                            dims.size, it->second.size);
+                    return RS_INVALID_PARAM_VALUE;
+                }
 
-                    // MNN reshape implementation would go here
-                    RS_LOGD("Reshaping input %s\n", name.c_str());
+                auto max_it = input_max_shapes_.find(name_arr[i]);
+                for (int j = 0; j < dims.size; ++j) {
+                    if (dims.value[j] <= 0 ||
+                        (max_it != input_max_shapes_.end() &&
+                         dims.value[j] > max_it->second.value[j])) {
+                        RS_LOGE("Reshape input:%s dims[%d]:%d is out of range\n", name_arr[i], j,
+                                dims.value[j]);
+                        return RS_INVALID_PARAM_VALUE;
+                    }
                 }
+                it->second = dims;
             }
 
-            return ret;
+            if (ShapeKey(input_shapes) == ShapeKey(input_shapes_)) {
+                return RS_SUCCESS;
+            }
+
+            ErrorCode ret = SwitchSession(input_shapes);
+            RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "SwitchSession failed.");
+
+            // 切换session后输入输出tensor均已变化,blob需要重新关联
+            return CreateBlobArray();
+        }
+
+        ErrorCode MNNNetwork::Reshape() {
+            // 初始session按MaxShapes创建,未配置时使用模型自带的输入尺寸
+            return SwitchSession(input_max_shapes_);
         }
 
         ErrorCode MNNNetwork::CreateBlobArray() {
-            // TODO: Implement blob array creation
             ErrorCode ret = RS_SUCCESS;
             ClearBlobArray();
 
@@ -320,6 +539,8 @@ namespace rayshape
 
             input_tensors_.clear();
             output_tensors_.clear();
+            input_host_tensors_.clear();
+            output_host_tensors_.clear();
         }
 
         ErrorCode MNNNetwork::Forward() {
@@ -334,6 +555,10 @@ namespace rayshape
             try {
                 // Set input tensors
                 for (size_t i = 0; i < input_blob_size_; ++i) {
+                    if (i < input_host_tensors_.size() && input_host_tensors_[i] != nullptr) {
+                        input_tensors_[i]->copyFromHostTensor(input_host_tensors_[i].get());
+                        continue;
+                    }
                     Blob *blob = input_blob_arr_[i];
                     Buffer *blob_buffer = blob->buffer;
                     bool need_set_input = blob_buffer->GetExternalFlag();
@@ -362,6 +587,12 @@ namespace rayshape
                     return RS_MODEL_ERROR;
                 }
 
+                for (size_t i = 0; i < output_host_tensors_.size(); ++i) {
+                    if (output_host_tensors_[i] != nullptr) {
+                        output_tensors_[i]->copyToHostTensor(output_host_tensors_[i].get());
+                    }
+                }
+
             } catch (const std::exception &e) {
                 RS_LOGE("MNN model inference failed: %s\n", e.what());
                 return RS_MODEL_ERROR;
@@ -370,6 +601,56 @@ namespace rayshape
             return RS_SUCCESS;
         }
 
+        ErrorCode MNNNetwork::CreateHostTensor(const Blob *blob, Buffer *buffer,
+                                               std::shared_ptr<MNN::Tensor> &host_tensor) {
+            CHECK_RET(CheckBindBuffer(blob, buffer))
+            Blob host_blob = *blob;
+            host_blob.buffer = buffer;
+            ErrorCode ret = RS_SUCCESS;
+            host_tensor = MNNBlobConverter::ConvertFromBlob(ret, &host_blob);
+            if (host_tensor == nullptr || ret != RS_SUCCESS) {
+                RS_LOGE("create host tensor for blob:%s failed\n", blob->name);
+                return ret != RS_SUCCESS ? ret : RS_MODEL_ERROR;
+            }
+            return RS_SUCCESS;
+        }
+
+        ErrorCode MNNNetwork::BindInput(size_t index, Buffer *buffer) {
+            if (index >= input_blob_size_) {
+                RS_LOGE("input index:%zu >= input size:%zu\n", index, input_blob_size_);
+                return RS_INVALID_PARAM;
+            }
+            std::shared_ptr<MNN::Tensor> host_tensor = nullptr;
+            CHECK_RET(CreateHostTensor(input_blob_arr_[index], buffer, host_tensor))
+            input_host_tensors_.resize(input_blob_size_);
+            input_host_tensors_[index] = host_tensor;
+            return RS_SUCCESS;
+        }
+
+        ErrorCode MNNNetwork::BindOutput(size_t index, Buffer *buffer) {
+            if (index >= output_blob_size_) {
+                RS_LOGE("output index:%zu >= output size:%zu\n", index, output_blob_size_);
+                return RS_INVALID_PARAM;
+            }
+            std::shared_ptr<MNN::Tensor> host_tensor = nullptr;
+            CHECK_RET(CreateHostTensor(output_blob_arr_[index], buffer, host_tensor))
+            output_host_tensors_.resize(output_blob_size_);
+            output_host_tensors_[index] = host_tensor;
+            return RS_SUCCESS;
+        }
+
+        ErrorCode MNNNetwork::WarmupShapesGet(std::vector<std::map<std::string, Dims>> &shapes) {
+            shapes.clear();
+            // 动态尺寸模型在声明的最大/最小尺寸上各预热一次,最大尺寸在前以便一次分配好内存
+            if (!input_max_shapes_.empty()) {
+                shapes.push_back(input_max_shapes_);
+            }
+            if (!input_min_shapes_.empty()) {
+                shapes.push_back(input_min_shapes_);
+            }
+            return RS_SUCCESS;
+        }
+
         ErrorCode MNNNetwork::InputBlobsGet(const Blob ***blob_arr, size_t *blob_size) {
             if (blob_arr == nullptr || blob_size == nullptr) {
                 RS_LOGE("blob_arr:%p or blob_size:%p is nullptr\n", blob_arr, blob_size);
@@ -117,5 +117,35 @@ namespace rayshape
                 return DataFormat::AUTO;
             } // 暂时先列举这些数据格式
         }
+
+        ErrorCode ONNXRuntimeConfigConverter::ConvertToGraphOptLevel(GraphOptimizationLevel &dst,
+                                                                     const std::string &src) {
+            if ("disable" == src) {
+                dst = GraphOptimizationLevel::ORT_DISABLE_ALL;
+            } else if ("basic" == src) {
+                dst = GraphOptimizationLevel::ORT_ENABLE_BASIC;
+            } else if ("extended" == src) {
+                dst = GraphOptimizationLevel::ORT_ENABLE_EXTENDED;
+            } else if ("all" == src) {
+                dst = GraphOptimizationLevel::ORT_ENABLE_ALL;
+            } else {
+                RS_LOGE("Unsupported GraphOptLevel: %s\n", src.c_str());
+                return ErrorCode::RS_INVALID_PARAM_VALUE;
+            }
+            return ErrorCode::RS_SUCCESS;
+        }
+
+        ErrorCode ONNXRuntimeConfigConverter::ConvertToExecutionMode(ExecutionMode &dst,
+                                                                     const std::string &src) {
+            if ("sequential" == src) {
+                dst = ExecutionMode::ORT_SEQUENTIAL;
+            } else if ("parallel" == src) {
+                dst = ExecutionMode::ORT_PARALLEL;
+            } else {
+                RS_LOGE("Unsupported ExecutionMode: %s\n", src.c_str());
+                return ErrorCode::RS_INVALID_PARAM_VALUE;
+            }
+            return ErrorCode::RS_SUCCESS;
+        }
     } // namespace onnxruntime
 } // namespace rayshape
@@ -0,0 +1,52 @@
+#include "inference/onnxruntime/onnxruntime_env.h"
+
+#include "inference/inference.h"
+#include "base/logger.h"
+
+namespace rayshape
+{
+    namespace onnxruntime
+    {
+        std::shared_ptr<Ort::Env> ONNXRuntimeEnv::env_ = nullptr;
+        bool ONNXRuntimeEnv::global_thread_pool_ = false;
+
+        static std::once_flag g_env_once;
+
+        void ONNXRuntimeEnv::Create() {
+            GlobalRuntime runtime = inference::ApplyGlobalRuntime();
+            try {
+                if (runtime.share_thread_pool_) {
+                    Ort::ThreadingOptions threading_options;
+                    if (runtime.intra_op_num_thread_ > 0) {
+                        threading_options.SetGlobalIntraOpNumThreads(runtime.intra_op_num_thread_);
+                    }
+                    if (runtime.inter_op_num_thread_ > 0) {
+                        threading_options.SetGlobalInterOpNumThreads(runtime.inter_op_num_thread_);
+                    }
+                    env_ = std::make_shared<Ort::Env>(threading_options, ORT_LOGGING_LEVEL_WARNING,
+                                                      "rayshape");
+                    global_thread_pool_ = true;
+                } else {
+                    env_ = std::make_shared<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "rayshape");
+                }
+                RS_LOGD("onnxruntime env created, global thread pool:%d intra:%d inter:%d\n",
+                        global_thread_pool_, runtime.intra_op_num_thread_,
+                        runtime.inter_op_num_thread_);
+            } catch (const Ort::Exception &e) {
+                RS_LOGE("create onnxruntime env failed: %s\n", e.what());
+                env_ = nullptr;
+            }
+        }
+
+        std::shared_ptr<Ort::Env> ONNXRuntimeEnv::Get() {
+            std::call_once(g_env_once, &ONNXRuntimeEnv::Create);
+            return env_;
+        }
+
+        bool ONNXRuntimeEnv::IsGlobalThreadPool() {
+            std::call_once(g_env_once, &ONNXRuntimeEnv::Create);
+            return global_thread_pool_;
+        }
+
+    } // namespace onnxruntime
+} // namespace rayshape
@@ -1,12 +1,18 @@
 #include "inference/onnxruntime/onnxruntime_network.h"
 
 #include "inference/onnxruntime/onnxruntime_config_converter.h"
+#include "inference/onnxruntime/onnxruntime_env.h"
+#include "inference/precision.h"
 #include "model/onnx/onnx_model.h"
 #include "utils/memory_size_info.h"
 #include "utils/blob_utils.h"
 #include "utils/debug_utils.h"
 #include "base/logger.h"
 #include "utils/device_convert_utils.h"
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <thread>
 
 using namespace rayshape::onnxruntime;
 using namespace rayshape::utils;
@@ -18,9 +24,30 @@ namespace rayshape
         TypeInferenceRegister<TypeInferenceCreator<ONNXRuntimeNetWork>>
             g_onnxruntime_inference_register(InferenceType::ONNXRUNTIME);
 
+        // 影响优化结果的选项,作为优化模型缓存文件名的一部分
+        static std::string OptimizedCacheTag(GraphOptimizationLevel opt_level,
+                                              Precision precision) {
+            std::stringstream ss;
+            ss << "o" << (int)opt_level << "_p" << (int)precision;
+#ifdef RS_ONNXRUNTIME_PROVIDER_CUDA
+            ss << "_cuda";
+#else
+            ss << "_cpu";
+#endif
+#if defined(__aarch64__) || defined(_M_ARM64)
+            ss << "_arm64";
+#elif defined(__x86_64__) || defined(_M_X64)
+            ss << "_x64";
+#else
+            ss << "_other";
+#endif
+            return ss.str();
+        }
+
         ONNXRuntimeNetWork::ONNXRuntimeNetWork(InferenceType type) : Inference(type) {}
 
         ONNXRuntimeNetWork::~ONNXRuntimeNetWork() {
+            Wait();
             ClearBlobArray();
         }
 
@@ -38,129 +65,511 @@ namespace rayshape
                 return ErrorCode::RS_INVALID_PARAM;
             }
 
-            env_ = std::make_shared<Ort::Env>();
+            precision_ = runtime->precision_;
+            if (!onnx_model->cfg_str_.empty()) {
+                RSJsonHandle json_handle = nullptr;
+                ErrorCode ret = RSJsonCreate(onnx_model->cfg_str_, &json_handle);
+                if (ret != RS_SUCCESS) {
+                    RS_LOGE("RSJsonCreate failed:%d\n", ret);
+                    return ret;
+                }
+                do {
+                    if ((ret = ParseInputShapes(json_handle)) != RS_SUCCESS) {
+                        RS_LOGE("ParseInputShapes failed:%d!\n", ret);
+                        break;
+                    }
+                    if ((ret = ParsePrecision(json_handle, precision_)) != RS_SUCCESS) {
+                        RS_LOGE("ParsePrecision failed:%d!\n", ret);
+                        break;
+                    }
+                    if ((ret = ParseSessionConfig(json_handle)) != RS_SUCCESS) {
+                        RS_LOGE("ParseSessionConfig failed:%d!\n", ret);
+                        break;
+                    }
+                } while (false);
+                RSJsonDestory(&json_handle);
+                if (ret != RS_SUCCESS) {
+                    return ret;
+                }
+            }
+            device_type_ = runtime->device_type_;
+            num_threads_ = runtime->num_thread_;
+            model_optimized_ = onnx_model->optimized_;
+            if (model_optimized_ && onnx_model->optimized_version_ != Ort::GetVersionString()) {
+                RS_LOGW("onnx model is optimized by onnxruntime %s, runtime is %s\n",
+                        onnx_model->optimized_version_.c_str(), Ort::GetVersionString().c_str());
+            }
+
+            env_ = ONNXRuntimeEnv::Get();
             if (!env_) {
                 RS_LOGE("Init env failed!\n");
                 return ErrorCode::RS_MODEL_ERROR;
             }
 
-            const auto &onnx_data = onnx_model->bin_buf_;
-            Ort::SessionOptions options;
+            CHECK_RET(CreateSession(onnx_model->bin_buf_))
+
+            return InitContext();
+        }
+
+        ErrorCode ONNXRuntimeNetWork::InitContext() {
+            try {
+                io_binding_ = std::make_shared<Ort::IoBinding>(*session_);
+            } catch (const Ort::Exception &e) {
+                RS_LOGE("create onnxruntime io binding failed: %s\n", e.what());
+                return RS_MODEL_ERROR;
+            }
+
+            // 输入按MaxShapes分配,之后Reshape只要不超过最大尺寸就不会重新申请内存
+            CHECK_RET(CreateBlobArray())
+
+            for (size_t i = 0; i < output_blob_size_; ++i) {
+                Dims dims;
+                if (!ResolveOutputDims(i, dims)) {
+                    CHECK_RET(ProbeOutputShapes())
+                    break;
+                }
+            }
+
+            CHECK_RET(BindBlobs())
+
+            return RS_SUCCESS;
+        }
+
+        void ONNXRuntimeNetWork::DeInit() {}
+
+        std::shared_ptr<Inference> ONNXRuntimeNetWork::Clone() {
+            if (session_ == nullptr) {
+                RS_LOGE("onnxruntime session is not initialized, can not clone\n");
+                return nullptr;
+            }
+
+            // Ort::Session::Run是线程安全的,各实例只独占io_binding和blob
+            auto network = std::make_shared<ONNXRuntimeNetWork>(type_);
+            network->device_type_ = device_type_;
+            network->num_threads_ = num_threads_;
+            network->input_min_shapes_ = input_min_shapes_;
+            network->input_max_shapes_ = input_max_shapes_;
+            network->env_ = env_;
+            network->session_ = session_;
+            network->native_async_ = native_async_;
+            if (network->InitContext() != RS_SUCCESS) {
+                RS_LOGE("onnxruntime clone InitContext failed\n");
+                return nullptr;
+            }
+            return network;
+        }
+
+        ErrorCode ONNXRuntimeNetWork::ParseInputShapes(const RSJsonHandle json_handle) {
+            RSJsonObject root_obj = RSJsonRootGet(json_handle);
+            RSJsonObject model_obj = RSJsonObjectGet(root_obj, "ModelConfig");
+            if (model_obj == nullptr) {
+                return RS_SUCCESS;
+            }
+
+            const char *keys[] = {"MinShapes", "MaxShapes"};
+            std::map<std::string, Dims> *shapes[] = {&input_min_shapes_, &input_max_shapes_};
+            for (int k = 0; k < 2; ++k) {
+                RSJsonObject shapes_arr = RSJsonObjectGet(model_obj, keys[k]);
+                if (shapes_arr == nullptr) {
+                    continue;
+                }
+
+                unsigned int size = RSJsonArraySize(shapes_arr);
+                for (unsigned int i = 0; i < size; i++) {
+                    RSJsonObject shape_obj = RSJsonArrayAt(shapes_arr, i);
+                    const char *name = RSJsonStringGet(RSJsonObjectGet(shape_obj, "name"));
+                    if (name == nullptr || strlen(name) <= 0 || strlen(name) > MAX_BLOB_NAME) {
+                        RS_LOGE("%s Name is empty or > MAX_BLOB_NAME:%d!\n", keys[k],
+                                MAX_BLOB_NAME);
+                        return RS_INVALID_MODEL;
+                    }
+
+                    RSJsonObject dims_arr = RSJsonObjectGet(shape_obj, "dims");
+                    unsigned int dims_size = RSJsonArraySize(dims_arr);
+                    if (dims_size <= 0 || dims_size > MAX_DIMS_SIZE) {
+                        RS_LOGE("%s Dims size:%d is empty or > MAX_DIMS_SIZE:%d!\n", keys[k],
+                                dims_size, MAX_DIMS_SIZE);
+                        return RS_INVALID_MODEL;
+                    }
+
+                    Dims dims;
+                    dims.size = dims_size;
+                    for (unsigned int j = 0; j < dims_size; j++) {
+                        dims.value[j] = RSJsonIntGet(RSJsonArrayAt(dims_arr, j), 0);
+                    }
+                    (*shapes[k])[name] = dims;
+                }
+            }
+
+            return RS_SUCCESS;
+        }
+
+        ErrorCode ONNXRuntimeNetWork::ParseSessionConfig(const RSJsonHandle json_handle) {
+            ErrorCode ret = RS_SUCCESS;
+
+            RSJsonObject root_obj = RSJsonRootGet(json_handle);
+            RSJsonObject network_obj = RSJsonObjectGet(root_obj, "NetworkConfig");
+            if (network_obj == nullptr) {
+                return RS_SUCCESS;
+            }
+            RSJsonObject session_obj = RSJsonObjectGet(network_obj, "SessionConfig");
+            if (session_obj == nullptr) {
+                return RS_SUCCESS;
+            }
+
+            inter_op_num_threads_ =
+                RSJsonIntGet(RSJsonObjectGet(session_obj, "InterOpNumThreads"), -1);
+
+            const char *opt_level = RSJsonStringGet(RSJsonObjectGet(session_obj, "GraphOptLevel"));
+            // 未配置的键RSJsonStringGet返回空串,保持默认值
+            if (strlen(opt_level) > 0) {
+                ret = ONNXRuntimeConfigConverter::ConvertToGraphOptLevel(graph_opt_level_,
+                                                                         opt_level);
+                RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "SessionConfig GraphOptLevel is invalid.");
+            }
+
+            const char *exec_mode = RSJsonStringGet(RSJsonObjectGet(session_obj, "ExecutionMode"));
+            if (strlen(exec_mode) > 0) {
+                ret = ONNXRuntimeConfigConverter::ConvertToExecutionMode(execution_mode_,
+                                                                         exec_mode);
+                RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "SessionConfig ExecutionMode is invalid.");
+            }
+
+            enable_mem_pattern_ =
+                RSJsonBoolGet(RSJsonObjectGet(session_obj, "EnableMemPattern"), true);
+            enable_cpu_mem_arena_ =
+                RSJsonBoolGet(RSJsonObjectGet(session_obj, "EnableCpuMemArena"), true);
+
+            const char *cache_path =
+                RSJsonStringGet(RSJsonObjectGet(session_obj, "OptimizedModelPath"));
+            optimized_model_path_ = cache_path;
+
+            RS_LOGD("SessionConfig inter_op:%d opt_level:%d exec_mode:%d mem_pattern:%d "
+                    "cpu_arena:%d cache:%s\n",
+                    inter_op_num_threads_, (int)graph_opt_level_, (int)execution_mode_,
+                    enable_mem_pattern_, enable_cpu_mem_arena_, optimized_model_path_.c_str());
+            return RS_SUCCESS;
+        }
+
+        ErrorCode ONNXRuntimeNetWork::CreateSession(const std::string &onnx_data) {
+            try {
+                Ort::SessionOptions options;
+                if (ONNXRuntimeEnv::IsGlobalThreadPool()) {
+                    // 线程数由GlobalRuntime决定,session级线程设置不生效
+                    options.DisablePerSessionThreads();
+                    if (num_threads_ > 0 || inter_op_num_threads_ > 0) {
+                        RS_LOGW("onnxruntime shares global thread pool, session threads "
+                                "intra:%d inter:%d are ignored\n",
+                                num_threads_, inter_op_num_threads_);
+                    }
+                } else {
+                    if (num_threads_ > 0) {
+                        options.SetIntraOpNumThreads(num_threads_);
+                    }
+                    if (inter_op_num_threads_ > 0) {
+                        options.SetInterOpNumThreads(inter_op_num_threads_);
+                    }
+                }
+                // 未设置线程数时ort按CPU核数创建intra op线程池
+                int intra_op_threads = num_threads_ > 0
+                                           ? num_threads_
+                                           : static_cast<int>(std::thread::hardware_concurrency());
+                native_async_ = !ONNXRuntimeEnv::IsGlobalThreadPool() && intra_op_threads > 1;
+                options.SetExecutionMode(execution_mode_);
+                if (enable_mem_pattern_) {
+                    options.EnableMemPattern();
+                } else {
+                    options.DisableMemPattern();
+                }
+                if (enable_cpu_mem_arena_) {
+                    options.EnableCpuMemArena();
+                } else {
+                    options.DisableCpuMemArena();
+                }
 #ifdef RS_ONNXRUNTIME_PROVIDER_CUDA
-            OrtCUDAProviderOptions cuda_options;
-            options.AppendExecutionProvider_CUDA(cuda_options);
+                OrtCUDAProviderOptions cuda_options;
+                options.AppendExecutionProvider_CUDA(cuda_options);
 #endif
-            session_ =
-                std::make_shared<Ort::Session>(*env_, onnx_data.data(), onnx_data.size(), options);
-            if (!session_) {
-                RS_LOGE("Init session failed!\n");
+                PrecisionOptionsSet(options);
+
+                if (model_optimized_) {
+                    // 打包时已离线优化为ORT格式,跳过在线图优化和优化模型缓存
+                    options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_DISABLE_ALL);
+                    options.AddConfigEntry(kOrtSessionOptionsConfigLoadModelFormat, "ORT");
+                    session_ = std::make_shared<Ort::Session>(*env_, onnx_data.data(),
+                                                              onnx_data.size(), options);
+                    RS_LOGD("load offline optimized ort format model\n");
+                    return RS_SUCCESS;
+                }
+
+                if (optimized_model_path_.empty()) {
+                    options.SetGraphOptimizationLevel(graph_opt_level_);
+                    session_ = std::make_shared<Ort::Session>(*env_, onnx_data.data(),
+                                                              onnx_data.size(), options);
+                    return RS_SUCCESS;
+                }
+
+                // 缓存文件名带上模型内容的hash和优化级别、精度、执行提供者、CPU架构,
+                // 模型或这些选项变化后不会误用旧缓存
+                std::stringstream ss;
+                ss << optimized_model_path_ << "." << std::hex
+                   << std::hash<std::string>()(onnx_data) << "."
+                   << OptimizedCacheTag(graph_opt_level_, precision_) << ".onnx";
+                std::string cache_file = ss.str();
+                std::basic_string<ORTCHAR_T> ort_cache_file(cache_file.begin(), cache_file.end());
+
+                if (std::ifstream(cache_file, std::ios::binary).good()) {
+                    // 缓存已经是优化后的图,跳过启动时的图优化
+                    RS_LOGD("load optimized onnx model cache:%s\n", cache_file.c_str());
+                    options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_DISABLE_ALL);
+                    try {
+                        session_ =
+                            std::make_shared<Ort::Session>(*env_, ort_cache_file.c_str(), options);
+                        return RS_SUCCESS;
+                    } catch (const Ort::Exception &e) {
+                        RS_LOGW("load optimized model cache failed: %s, rebuild it\n", e.what());
+                    }
+                }
+
+                options.SetGraphOptimizationLevel(graph_opt_level_);
+                options.SetOptimizedModelFilePath(ort_cache_file.c_str());
+                session_ = std::make_shared<Ort::Session>(*env_, onnx_data.data(),
+                                                          onnx_data.size(), options);
+                RS_LOGD("save optimized onnx model cache:%s\n", cache_file.c_str());
+            } catch (const Ort::Exception &e) {
+                RS_LOGE("Init session failed: %s\n", e.what());
                 return ErrorCode::RS_MODEL_ERROR;
             }
+            return RS_SUCCESS;
+        }
 
-            // TODO: 支持动态shape
-            // if ((ret = Reshape()) != RS_SUCCESS)
-            // {
-            //     RS_LOGE("Reshape failed:%d!", ret);
-            //     return ret;
-            // }
+        void ONNXRuntimeNetWork::PrecisionOptionsSet(Ort::SessionOptions &options) {
+            if (precision_ == Precision::BF16 || precision_ == Precision::LOW) {
+#if defined(__aarch64__) || defined(_M_ARM64)
+                // arm64上fp32 gemm用bf16 matmul加速
+                options.AddConfigEntry(kOrtSessionOptionsMlasGemmFastMathArm64Bfloat16, "1");
+                RS_LOGD("onnxruntime enable arm64 bf16 gemm fastmath\n");
+                return;
+#else
+                (void)options;
+#endif
+            }
+            if (precision_ == Precision::BF16 || precision_ == Precision::FP16) {
+                // cpu ep没有fp32模型降精度执行的选项,需在打包前把模型转换为对应精度
+                RS_LOGW("onnxruntime cpu does not support precision:%s for fp32 model, "
+                        "convert the model before packing\n",
+                        PrecisionToString(precision_));
+            }
+        }
 
-            CHECK_RET(CreateBlobArray())
+        ErrorCode ONNXRuntimeNetWork::Reshape(const char **name_arr, const Dims *dims_arr,
+                                              size_t dims_size) {
+            if (name_arr == nullptr || dims_arr == nullptr) {
+                RS_LOGE("Invalid input parameters for Reshape.\n");
+                return RS_INVALID_PARAM;
+            }
 
-            for (size_t i = 0; i < input_blob_size_; ++i) {
-                Blob *blob = input_blob_arr_[i];
-                Buffer *blob_buffer = blob->buffer;
-                bool need_set_input = blob_buffer->GetExternalFlag();
-                if (!need_set_input) {
-                    const char *name = blob->name;
+            bool reshape_flag = false;
+            for (size_t i = 0; i < dims_size; ++i) {
+                const char *name = name_arr[i];
+                const Dims &dims = dims_arr[i];
+                int index = -1;
+                Blob *blob = FindBlobAndIndexByName(input_blob_arr_, input_blob_size_, name, &index);
+                if (blob == nullptr) {
+                    RS_LOGE("Not find input Blob name:%s\n", name != nullptr ? name : "");
+                    return RS_INVALID_PARAM;
+                }
 
-                    void *input_mem = blob->buffer->GetDataPtr();
-                    if (input_mem == nullptr) {
-                        RS_LOGE("input mem is null\n");
-                        return RS_NULL_PARAM;
+                const std::vector<int64_t> &model_shape = input_model_shapes_[index];
+                if (dims.size != (int)model_shape.size()) {
+                    RS_LOGE("input:%s reshape rank:%d != model rank:%zu\n", name, dims.size,
+                            model_shape.size());
+                    return RS_INVALID_PARAM_VALUE;
+                }
+                auto min_iter = input_min_shapes_.find(name);
+                auto max_iter = input_max_shapes_.find(name);
+                for (int j = 0; j < dims.size; ++j) {
+                    if ((model_shape[j] > 0 && dims.value[j] != model_shape[j])
+                        || (min_iter != input_min_shapes_.end()
+                            && dims.value[j] < min_iter->second.value[j])
+                        || (max_iter != input_max_shapes_.end()
+                            && dims.value[j] > max_iter->second.value[j])) {
+                        RS_LOGE("input:%s dim[%d]:%d out of model/min/max shape range\n", name, j,
+                                dims.value[j]);
+                        return RS_INVALID_PARAM_VALUE;
+                    }
+                }
+
+                size_t count = CalculateDims(dims);
+                if (count > blob->buffer->GetDataSize()) {
+                    // 未声明MaxShapes时才会走到这里
+                    RS_LOGW("input:%s reshape exceeds allocated size, realloc\n", name);
+                    RSMemoryInfo mem_info = blob->buffer->GetMemoryInfo();
+                    mem_info.size_ = static_cast<unsigned int>(count);
+                    Buffer *buffer = Buffer::Alloc(mem_info);
+                    if (buffer == nullptr) {
+                        RS_LOGE("Buffer Alloc failed\n");
+                        return RS_OUTOFMEMORY;
+                    }
+                    delete blob->buffer;
+                    blob->buffer = buffer;
+                }
+                if (memcmp(&blob->dims, &dims, sizeof(Dims)) != 0) {
+                    blob->dims = dims;
+                    reshape_flag = true;
+                }
+            }
+
+            if (!reshape_flag) {
+                return RS_SUCCESS;
+            }
+            return BindBlobs();
+        }
+
+        bool ONNXRuntimeNetWork::ResolveOutputDims(size_t idx, Dims &dims) {
+            std::map<std::string, int> symbol_values;
+            for (size_t i = 0; i < input_blob_size_; ++i) {
+                for (size_t j = 0; j < input_model_shapes_[i].size(); ++j) {
+                    if (input_model_shapes_[i][j] < 0 && !input_symbols_[i][j].empty()) {
+                        symbol_values[input_symbols_[i][j]] = input_blob_arr_[i]->dims.value[j];
                     }
+                }
+            }
 
-                    input_names_.emplace_back(name);
+            const std::vector<int64_t> &model_shape = output_model_shapes_[idx];
+            dims.size = static_cast<int>(model_shape.size());
+            for (size_t j = 0; j < model_shape.size(); ++j) {
+                if (model_shape[j] >= 0) {
+                    dims.value[j] = static_cast<int>(model_shape[j]);
+                    continue;
+                }
+                auto iter = symbol_values.find(output_symbols_[idx][j]);
+                if (iter == symbol_values.end()) {
+                    return false;
+                }
+                dims.value[j] = iter->second;
+            }
+            return true;
+        }
 
-                    auto memory_info =
-                        Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeCPU);
+        ErrorCode ONNXRuntimeNetWork::ProbeOutputShapes() {
+            RS_LOGD("onnxruntime output shape not resolvable, probe with max input shape\n");
+            try {
+                Ort::MemoryInfo memory_info =
+                    Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeCPU);
+                io_binding_->ClearBoundInputs();
+                io_binding_->ClearBoundOutputs();
+                for (size_t i = 0; i < input_blob_size_; ++i) {
+                    Blob *blob = input_blob_arr_[i];
+                    memset(blob->buffer->GetDataPtr(), 0,
+                           CalculateMemorySize(blob->dims, blob->data_type));
                     std::vector<int64_t> dims;
                     CHECK_RET(ONNXRuntimeConfigConverter::ConvertFromDims(dims, blob->dims));
                     ONNXTensorElementDataType dtype;
                     CHECK_RET(
                         ONNXRuntimeConfigConverter::ConvertFromDataType(dtype, blob->data_type));
-                    input_tensors_.emplace_back(Ort::Value::CreateTensor(
-                        memory_info, input_mem,
-                        blob->buffer->GetDataSize()
-                            * GetBytesSize(blob->buffer->GetMemoryInfo().data_type_),
-                        dims.data(), dims.size(), dtype));
-
-#if 1
-                    RS_LOGD("blob name: %s\n", name);
-                    RS_LOGD("blob dtype: %d\n", blob->data_type);
-                    RS_LOGD("blob format: %d\n", blob->data_format);
-                    RS_LOGD("blob device: %d\n", blob->device_type);
-                    RS_LOGD("blob dims: %d, %d, %d, %d\n", blob->dims.value[0], blob->dims.value[1],
-                            blob->dims.value[2], blob->dims.value[3]);
-                    RS_LOGD("blob bytes: %zu\n",
-                            blob->buffer->GetDataSize()
-                                * GetBytesSize(blob->buffer->GetMemoryInfo().data_type_));
-                    RS_LOGD("blob alloc flag: %d\n", blob->buffer->GetExternalFlag());
-#endif
+                    io_binding_->BindInput(
+                        blob->name, Ort::Value::CreateTensor(
+                                        memory_info, blob->buffer->GetDataPtr(),
+                                        CalculateMemorySize(blob->dims, blob->data_type),
+                                        dims.data(), dims.size(), dtype));
+                }
+                for (size_t i = 0; i < output_blob_size_; ++i) {
+                    io_binding_->BindOutput(output_blob_arr_[i]->name, memory_info);
+                }
+
+                Ort::RunOptions run_options;
+                session_->Run(run_options, *io_binding_);
+
+                std::vector<Ort::Value> values = io_binding_->GetOutputValues();
+                for (size_t i = 0; i < values.size() && i < output_blob_size_; ++i) {
+                    CHECK_RET(UpdateOutputBlob(i, values[i]))
                 }
+            } catch (const Ort::Exception &e) {
+                RS_LOGE("onnxruntime probe output shape failed: %s\n", e.what());
+                return RS_MODEL_ERROR;
             }
+            return RS_SUCCESS;
+        }
 
-            for (size_t i = 0; i < output_blob_size_; ++i) {
-                Blob *blob = output_blob_arr_[i];
-                Buffer *blob_buffer = blob->buffer;
-                bool need_set_output = blob_buffer->GetExternalFlag();
-                if (!need_set_output) {
-                    const char *name = blob->name;
-
-                    void *output_mem = blob->buffer->GetDataPtr();
-                    if (output_mem == nullptr) {
-                        RS_LOGE("output mem is null\n");
+        ErrorCode ONNXRuntimeNetWork::BindBlobs() {
+            try {
+                Ort::MemoryInfo memory_info =
+                    Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeCPU);
+                io_binding_->ClearBoundInputs();
+                io_binding_->ClearBoundOutputs();
+
+                for (size_t i = 0; i < input_blob_size_; ++i) {
+                    Blob *blob = input_blob_arr_[i];
+                    void *input_mem = blob->buffer->GetDataPtr();
+                    if (input_mem == nullptr) {
+                        RS_LOGE("input mem is null\n");
                         return RS_NULL_PARAM;
                     }
+                    std::vector<int64_t> dims;
+                    CHECK_RET(ONNXRuntimeConfigConverter::ConvertFromDims(dims, blob->dims));
+                    ONNXTensorElementDataType dtype;
+                    CHECK_RET(
+                        ONNXRuntimeConfigConverter::ConvertFromDataType(dtype, blob->data_type));
+                    io_binding_->BindInput(
+                        blob->name,
+                        Ort::Value::CreateTensor(memory_info, input_mem,
+                                                 CalculateMemorySize(blob->dims, blob->data_type),
+                                                 dims.data(), dims.size(), dtype));
+                }
 
-                    output_names_.emplace_back(name);
-
-                    auto memory_info =
-                        Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeCPU);
+                output_bind_blob_.assign(output_blob_size_, false);
+                for (size_t i = 0; i < output_blob_size_; ++i) {
+                    Blob *blob = output_blob_arr_[i];
+                    Dims resolved;
+                    if (!ResolveOutputDims(i, resolved)
+                        || CalculateDims(resolved) > blob->buffer->GetDataSize()) {
+                        // 输出尺寸依赖于数据,交给ort分配,Forward后再拷贝
+                        io_binding_->BindOutput(blob->name, memory_info);
+                        continue;
+                    }
+                    blob->dims = resolved;
                     std::vector<int64_t> dims;
                     CHECK_RET(ONNXRuntimeConfigConverter::ConvertFromDims(dims, blob->dims));
                     ONNXTensorElementDataType dtype;
                     CHECK_RET(
                         ONNXRuntimeConfigConverter::ConvertFromDataType(dtype, blob->data_type));
-                    output_tensors_.emplace_back(Ort::Value::CreateTensor(
-                        memory_info, output_mem,
-                        blob->buffer->GetDataSize()
-                            * GetBytesSize(blob->buffer->GetMemoryInfo().data_type_),
-                        dims.data(), dims.size(), dtype));
-
-#if 1
-                    RS_LOGD("blob name: %s\n", name);
-                    RS_LOGD("blob dtype: %d\n", blob->data_type);
-                    RS_LOGD("blob format: %d\n", blob->data_format);
-                    RS_LOGD("blob device: %d\n", blob->device_type);
-                    RS_LOGD("blob dims: %d, %d, %d, %d\n", blob->dims.value[0], blob->dims.value[1],
-                            blob->dims.value[2], blob->dims.value[3]);
-                    RS_LOGD("blob bytes: %zu\n",
-                            blob->buffer->GetDataSize()
-                                * GetBytesSize(blob->buffer->GetMemoryInfo().data_type_));
-                    RS_LOGD("blob alloc flag: %d\n", blob->buffer->GetExternalFlag());
-#endif
+                    io_binding_->BindOutput(
+                        blob->name,
+                        Ort::Value::CreateTensor(memory_info, blob->buffer->GetDataPtr(),
+                                                 CalculateMemorySize(blob->dims, blob->data_type),
+                                                 dims.data(), dims.size(), dtype));
+                    output_bind_blob_[i] = true;
                 }
+            } catch (const Ort::Exception &e) {
+                RS_LOGE("onnxruntime bind blobs failed: %s\n", e.what());
+                return RS_MODEL_ERROR;
             }
-
             return RS_SUCCESS;
         }
 
-        void ONNXRuntimeNetWork::DeInit() {}
-
-        ErrorCode ONNXRuntimeNetWork::Reshape(const char **name_arr, const Dims *dims_arr,
-                                              size_t dims_size) {
-            // TODO: Support Dynamic model
-            return RS_NOT_IMPLEMENT;
+        ErrorCode ONNXRuntimeNetWork::UpdateOutputBlob(size_t idx, const Ort::Value &value) {
+            Blob *blob = output_blob_arr_[idx];
+            Ort::TensorTypeAndShapeInfo info = value.GetTensorTypeAndShapeInfo();
+            Dims dims;
+            CHECK_RET(ONNXRuntimeConfigConverter::ConvertToDims(dims, info.GetShape()));
+
+            size_t count = info.GetElementCount();
+            if (count > blob->buffer->GetDataSize()) {
+                RSMemoryInfo mem_info = blob->buffer->GetMemoryInfo();
+                mem_info.size_ = static_cast<unsigned int>(count);
+                Buffer *buffer = Buffer::Alloc(mem_info);
+                if (buffer == nullptr) {
+                    RS_LOGE("Buffer Alloc failed\n");
+                    return RS_OUTOFMEMORY;
+                }
+                delete blob->buffer;
+                blob->buffer = buffer;
+            }
+            blob->dims = dims;
+            memcpy(blob->buffer->GetDataPtr(), value.GetTensorData<void>(),
+                   count * GetBytesSize(blob->data_type));
+            return RS_SUCCESS;
         }
 
         ErrorCode ONNXRuntimeNetWork::CreateOrUpdateBlob(Blob **dst, const char *blob_name,
@@ -194,15 +603,56 @@ namespace rayshape
             // convert data type
             blob->data_type =
                 ONNXRuntimeConfigConverter::ConvertToDataType(type_and_shape_info.GetElementType());
+
+            // 记录模型原始shape和符号维度,用于Reshape校验和输出尺寸推导
+            std::vector<int64_t> model_shape = type_and_shape_info.GetShape();
+            std::vector<const char *> symbols(model_shape.size(), nullptr);
+            if (!symbols.empty()) {
+                type_and_shape_info.GetSymbolicDimensions(symbols.data(), symbols.size());
+            }
+            std::vector<std::string> symbol_strs;
+            for (const char *symbol : symbols) {
+                symbol_strs.emplace_back(symbol != nullptr ? symbol : "");
+            }
+            if (is_input) {
+                input_model_shapes_.emplace_back(model_shape);
+                input_symbols_.emplace_back(symbol_strs);
+            } else {
+                output_model_shapes_.emplace_back(model_shape);
+                output_symbols_.emplace_back(symbol_strs);
+            }
+
             // convert shape dims
-            ret = ONNXRuntimeConfigConverter::ConvertToDims(blob->dims,
-                                                            type_and_shape_info.GetShape());
+            ret = ONNXRuntimeConfigConverter::ConvertToDims(blob->dims, model_shape);
             if (ret != RS_SUCCESS) {
                 RS_LOGE("ONNXRuntimeConfigConverter::ConvertToDims failed:%d.\n", ret);
-                ClearBlobArray();
+                free(blob);
                 return ret;
             }
 
+            // 动态维度: 输入取MaxShapes,输出先按输入推导,推导不出的置1等待试跑
+            auto max_iter = input_max_shapes_.find(blob_name);
+            if (is_input && max_iter != input_max_shapes_.end()) {
+                if (max_iter->second.size != blob->dims.size) {
+                    RS_LOGE("input:%s MaxShapes rank:%d != model rank:%d\n", blob_name,
+                            max_iter->second.size, blob->dims.size);
+                    free(blob);
+                    return RS_INVALID_MODEL;
+                }
+                blob->dims = max_iter->second;
+            } else if (!is_input) {
+                ResolveOutputDims(output_model_shapes_.size() - 1, blob->dims);
+            }
+            for (int i = 0; i < blob->dims.size; ++i) {
+                if (blob->dims.value[i] <= 0) {
+                    if (is_input) {
+                        RS_LOGW("input:%s dim[%d] is dynamic without MaxShapes, use 1\n",
+                                blob_name, i);
+                    }
+                    blob->dims.value[i] = 1;
+                }
+            }
+
             // convert data layout
             std::string layout = GetDataLayoutString(blob->dims);
             blob->data_format = ONNXRuntimeConfigConverter::ConvertToDataFormat(layout);
@@ -217,7 +667,7 @@ namespace rayshape
             ret = ConvertDeviceTypeToMemory(blob->device_type, mem_type);
             if (ret != RS_SUCCESS) {
                 RS_LOGE("ConvertDeviceTypeToMemory failed\n");
-                delete blob;
+                free(blob);
                 return ret;
             }
 
@@ -227,6 +677,7 @@ namespace rayshape
                 blob->buffer = Buffer::Alloc(mem_info);
                 if (blob->buffer == nullptr) {
                     RS_LOGE("Buffer Alloc failed\n");
+                    free(blob);
                     return RS_OUTOFMEMORY;
                 }
             }
@@ -238,6 +689,10 @@ namespace rayshape
         ErrorCode ONNXRuntimeNetWork::CreateBlobArray() {
             ErrorCode ret = RS_SUCCESS;
             ClearBlobArray();
+            input_model_shapes_.clear();
+            input_symbols_.clear();
+            output_model_shapes_.clear();
+            output_symbols_.clear();
 
             std::vector<std::string> input_names;
             std::vector<std::string> output_names;
@@ -371,14 +826,149 @@ namespace rayshape
         }
 
         ErrorCode ONNXRuntimeNetWork::Forward() {
-            Ort::RunOptions run_options;
-            session_->Run(run_options, input_names_.data(), input_tensors_.data(),
-                          input_names_.size(), output_names_.data(), output_tensors_.data(),
-                          output_names_.size());
+            try {
+                Ort::RunOptions run_options;
+                session_->Run(run_options, *io_binding_);
+
+                // 未绑定blob内存的输出由ort分配,拷贝回blob
+                bool need_copy = false;
+                for (size_t i = 0; i < output_bind_blob_.size(); ++i) {
+                    need_copy = need_copy || !output_bind_blob_[i];
+                }
+                if (need_copy) {
+                    std::vector<Ort::Value> values = io_binding_->GetOutputValues();
+                    for (size_t i = 0; i < values.size() && i < output_blob_size_; ++i) {
+                        if (!output_bind_blob_[i]) {
+                            CHECK_RET(UpdateOutputBlob(i, values[i]))
+                        }
+                    }
+                }
+            } catch (const Ort::Exception &e) {
+                RS_LOGE("onnxruntime model infer failed: %s\n", e.what());
+                return RS_MODEL_ERROR;
+            }
+
+            return RS_SUCCESS;
+        }
+
+        ErrorCode ONNXRuntimeNetWork::BindInput(size_t index, Buffer *buffer) {
+            if (index >= input_blob_size_) {
+                RS_LOGE("input index:%zu >= input size:%zu\n", index, input_blob_size_);
+                return RS_INVALID_PARAM;
+            }
+            CHECK_RET(BindBlobBuffer(input_blob_arr_[index], buffer))
+            // io_binding_按blob内存重新绑定
+            return BindBlobs();
+        }
+
+        ErrorCode ONNXRuntimeNetWork::BindOutput(size_t index, Buffer *buffer) {
+            if (index >= output_blob_size_) {
+                RS_LOGE("output index:%zu >= output size:%zu\n", index, output_blob_size_);
+                return RS_INVALID_PARAM;
+            }
+            CHECK_RET(BindBlobBuffer(output_blob_arr_[index], buffer))
+            return BindBlobs();
+        }
 
+        ErrorCode ONNXRuntimeNetWork::WarmupShapesGet(std::vector<std::map<std::string, Dims>> &shapes) {
+            shapes.clear();
+            // 动态尺寸模型在声明的最大/最小尺寸上各预热一次,最大尺寸在前以便一次分配好内存
+            if (!input_max_shapes_.empty()) {
+                shapes.push_back(input_max_shapes_);
+            }
+            if (!input_min_shapes_.empty()) {
+                shapes.push_back(input_min_shapes_);
+            }
+            return RS_SUCCESS;
+        }
+
+        ErrorCode ONNXRuntimeNetWork::PrepareAsyncValues() {
+            Ort::MemoryInfo memory_info =
+                Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeCPU);
+            async_input_names_.clear();
+            async_input_values_.clear();
+            async_output_names_.clear();
+            async_output_values_.clear();
+
+            for (size_t i = 0; i < input_blob_size_; ++i) {
+                Blob *blob = input_blob_arr_[i];
+                std::vector<int64_t> dims;
+                CHECK_RET(ONNXRuntimeConfigConverter::ConvertFromDims(dims, blob->dims));
+                ONNXTensorElementDataType dtype;
+                CHECK_RET(ONNXRuntimeConfigConverter::ConvertFromDataType(dtype, blob->data_type));
+                async_input_names_.push_back(blob->name);
+                async_input_values_.emplace_back(Ort::Value::CreateTensor(
+                    memory_info, blob->buffer->GetDataPtr(),
+                    CalculateMemorySize(blob->dims, blob->data_type), dims.data(), dims.size(),
+                    dtype));
+            }
+
+            for (size_t i = 0; i < output_blob_size_; ++i) {
+                Blob *blob = output_blob_arr_[i];
+                async_output_names_.push_back(blob->name);
+                if (!output_bind_blob_[i]) {
+                    async_output_values_.emplace_back(nullptr);
+                    continue;
+                }
+                std::vector<int64_t> dims;
+                CHECK_RET(ONNXRuntimeConfigConverter::ConvertFromDims(dims, blob->dims));
+                ONNXTensorElementDataType dtype;
+                CHECK_RET(ONNXRuntimeConfigConverter::ConvertFromDataType(dtype, blob->data_type));
+                async_output_values_.emplace_back(Ort::Value::CreateTensor(
+                    memory_info, blob->buffer->GetDataPtr(),
+                    CalculateMemorySize(blob->dims, blob->data_type), dims.data(), dims.size(),
+                    dtype));
+            }
             return RS_SUCCESS;
         }
 
+        ErrorCode ONNXRuntimeNetWork::StartForward() {
+            if (!native_async_) {
+                return Inference::StartForward();
+            }
+            try {
+                CHECK_RET(PrepareAsyncValues());
+                async_run_options_ = Ort::RunOptions();
+                session_->RunAsync(async_run_options_, async_input_names_.data(),
+                                   async_input_values_.data(), async_input_values_.size(),
+                                   async_output_names_.data(), async_output_values_.data(),
+                                   async_output_values_.size(), RunAsyncCallback, this);
+            } catch (const Ort::Exception &e) {
+                // Init时判断可用但ort仍拒绝,之后不再尝试
+                RS_LOGW("onnxruntime RunAsync unavailable: %s, use thread pool instead\n",
+                        e.what());
+                native_async_ = false;
+                async_input_values_.clear();
+                async_output_values_.clear();
+                return Inference::StartForward();
+            }
+            return RS_SUCCESS;
+        }
+
+        void ONNXRuntimeNetWork::RunAsyncCallback(void *user_data, OrtValue ** /*outputs*/,
+                                                  size_t num_outputs, OrtStatusPtr status_ptr) {
+            ONNXRuntimeNetWork *network = static_cast<ONNXRuntimeNetWork *>(user_data);
+            Ort::Status status(status_ptr);
+            ErrorCode ret = RS_SUCCESS;
+            if (!status.IsOK()) {
+                RS_LOGE("onnxruntime async infer failed: %s\n", status.GetErrorMessage().c_str());
+                ret = RS_MODEL_ERROR;
+            } else {
+                // outputs即async_output_values_,未绑定blob内存的输出拷贝回blob
+                for (size_t i = 0; i < num_outputs && i < network->output_blob_size_; ++i) {
+                    if (!network->output_bind_blob_[i]) {
+                        ret = network->UpdateOutputBlob(i, network->async_output_values_[i]);
+                        if (ret != RS_SUCCESS) {
+                            break;
+                        }
+                    }
+                }
+            }
+            network->async_input_values_.clear();
+            network->async_output_values_.clear();
+            network->FinishForward(ret);
+        }
+
         ErrorCode ONNXRuntimeNetWork::InputBlobsGet(const Blob ***blob_arr, size_t *blob_size) {
             if (blob_arr == nullptr || blob_size == nullptr) {
                 RS_LOGE("blob_arr:%p or blob_size:%p is nullptr\n", blob_arr, blob_size);
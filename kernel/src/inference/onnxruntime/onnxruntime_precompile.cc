@@ -0,0 +1,86 @@
+#include "inference/onnxruntime/onnxruntime_precompile.h"
+
+#include "inference/onnxruntime/onnxruntime_config_converter.h"
+#include "inference/onnxruntime/onnxruntime_env.h"
+#include "base/logger.h"
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+namespace rayshape
+{
+    namespace onnxruntime
+    {
+        ErrorCode ONNXModelPrecompile(ONNXModel *model, const std::string &opt_level,
+                                      const std::string &work_path) {
+            if (model == nullptr || model->bin_buf_.empty() || work_path.empty()) {
+                RS_LOGE("model is nullptr/empty or work_path is empty!\n");
+                return RS_INVALID_PARAM;
+            }
+            if (model->optimized_) {
+                RS_LOGE("onnx model is already optimized with level:%s\n",
+                        model->optimized_level_.c_str());
+                return RS_INVALID_PARAM;
+            }
+
+            GraphOptimizationLevel level = GraphOptimizationLevel::ORT_ENABLE_ALL;
+            ErrorCode ret = ONNXRuntimeConfigConverter::ConvertToGraphOptLevel(level, opt_level);
+            RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "onnx precompile opt level is invalid.");
+            if (level == GraphOptimizationLevel::ORT_DISABLE_ALL) {
+                RS_LOGE("onnx precompile opt level can not be disable\n");
+                return RS_INVALID_PARAM_VALUE;
+            }
+
+            std::shared_ptr<Ort::Env> env = ONNXRuntimeEnv::Get();
+            if (env == nullptr) {
+                RS_LOGE("Init env failed!\n");
+                return RS_MODEL_ERROR;
+            }
+
+            std::basic_string<ORTCHAR_T> ort_work_path(work_path.begin(), work_path.end());
+            try {
+                // 执行后端与ONNXRuntimeNetWork::CreateSession保持一致
+                Ort::SessionOptions options;
+                if (ONNXRuntimeEnv::IsGlobalThreadPool()) {
+                    options.DisablePerSessionThreads();
+                }
+                options.SetGraphOptimizationLevel(level);
+                options.SetOptimizedModelFilePath(ort_work_path.c_str());
+                options.AddConfigEntry(kOrtSessionOptionsConfigSaveModelFormat, "ORT");
+#ifdef RS_ONNXRUNTIME_PROVIDER_CUDA
+                OrtCUDAProviderOptions cuda_options;
+                options.AppendExecutionProvider_CUDA(cuda_options);
+#endif
+                Ort::Session session(*env, model->bin_buf_.data(), model->bin_buf_.size(), options);
+            } catch (const Ort::Exception &e) {
+                RS_LOGE("onnxruntime offline optimize failed: %s\n", e.what());
+                std::remove(work_path.c_str());
+                return RS_MODEL_ERROR;
+            }
+
+            std::string ort_buf;
+            {
+                std::ifstream ifs(work_path, std::ios::binary);
+                if (!ifs.good()) {
+                    RS_LOGE("read optimized model:%s failed\n", work_path.c_str());
+                    return RS_MODEL_ERROR;
+                }
+                ort_buf.assign(std::istreambuf_iterator<char>(ifs),
+                               std::istreambuf_iterator<char>());
+            }
+            std::remove(work_path.c_str());
+            if (ort_buf.empty()) {
+                RS_LOGE("optimized model:%s is empty\n", work_path.c_str());
+                return RS_MODEL_ERROR;
+            }
+
+            RS_LOGD("onnx model optimized offline, level:%s size:%zu -> %zu\n", opt_level.c_str(),
+                    model->bin_buf_.size(), ort_buf.size());
+            model->bin_buf_ = std::move(ort_buf);
+            model->optimized_ = true;
+            model->optimized_level_ = opt_level;
+            model->optimized_version_ = Ort::GetVersionString();
+            return RS_SUCCESS;
+        }
+    } // namespace onnxruntime
+} // namespace rayshape
@@ -0,0 +1,27 @@
+#include "inference/openvino/openvino_core.h"
+
+#include "base/logger.h"
+
+namespace rayshape
+{
+    namespace inference
+    {
+        namespace openvino
+        {
+            std::shared_ptr<ov::Core> OpenVINOCore::Get() {
+                static std::once_flag once;
+                static std::shared_ptr<ov::Core> core = nullptr;
+                std::call_once(once, []() {
+                    try {
+                        core = std::make_shared<ov::Core>();
+                        RS_LOGD("openvino shared core created, version:%s\n",
+                                ov::get_openvino_version().buildNumber);
+                    } catch (const ov::Exception &e) {
+                        RS_LOGE("create openvino core failed: %s\n", e.what());
+                    }
+                });
+                return core;
+            }
+        } // namespace openvino
+    } // namespace inference
+} // namespace rayshape
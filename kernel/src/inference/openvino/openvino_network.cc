@@ -2,8 +2,11 @@
 
 #include "inference/openvino/openvino_blob_converter.h"
 #include "inference/openvino/openvino_config_converter.h"
+#include "inference/openvino/openvino_core.h"
+#include "inference/precision.h"
 #include "model/openvino/openvino_model.h"
 #include "utils/blob_utils.h"
+#include "utils/debug_utils.h"
 #include "base/logger.h"
 #include <string>
 #include <vector>
@@ -26,6 +29,7 @@ namespace rayshape
         OpenVinoNetWork::OpenVinoNetWork(InferenceType type) : Inference(type) {}
 
         OpenVinoNetWork::~OpenVinoNetWork() {
+            Wait();
             ClearBlobArray();
         }
 
@@ -44,6 +48,7 @@ namespace rayshape
                 device_name_ = "GPU";
             }
             num_threads_ = runtime->num_thread_;
+            precision_ = runtime->precision_;
 
             auto openvino_model = dynamic_cast<const OpenVINOModel *>(model);
             if (openvino_model == nullptr) {
@@ -65,6 +70,11 @@ namespace rayshape
                     break;
                 }
 
+                if ((ret = ParsePrecision(json_handle, precision_)) != RS_SUCCESS) {
+                    RS_LOGE("ParsePrecision failed:%d!\n", ret);
+                    break;
+                }
+
                 RSJsonObject root_obj = RSJsonRootGet(json_handle);
                 RSJsonObject network_config_obj = RSJsonObjectGet(root_obj, "NetworkConfig");
                 RSJsonObject cache_dir_obj = RSJsonObjectGet(network_config_obj, "CachePath");
@@ -73,7 +83,8 @@ namespace rayshape
                     || strlen(cache_dir) > MAX_BLOB_NAME) {
                     RS_LOGE("BuilderConfig CachePath is empty or > MAX_BLOB_NAME:%d!\n",
                             MAX_BLOB_NAME);
-                    return RS_INVALID_PARAM;
+                    ret = RS_INVALID_PARAM;
+                    break;
                 }
                 if ((ret = InitWithMemoryContent(openvino_model->xml_content_,
                                                  openvino_model->bin_content_, cache_dir))
@@ -82,6 +93,9 @@ namespace rayshape
                     break;
                 }
 
+                // 有匹配的预编译blob时直接import,Reshape()中跳过compile_model
+                ImportCompiledModel(openvino_model);
+
                 if ((ret = Reshape()) != RS_SUCCESS) {
                     RS_LOGE("Reshape failed:%d!\n", ret);
                     break;
@@ -103,6 +117,37 @@ namespace rayshape
 
         void OpenVinoNetWork::DeInit() {}
 
+        std::shared_ptr<Inference> OpenVinoNetWork::Clone() {
+            if (model_ == nullptr || !compiled_model_) {
+                RS_LOGE("openvino model is not compiled, can not clone\n");
+                return nullptr;
+            }
+
+            // 共享compiled_model_,每个实例只独占一个infer request
+            auto network = std::make_shared<OpenVinoNetWork>(type_);
+            network->device_type_ = device_type_;
+            network->num_threads_ = num_threads_;
+            network->precision_ = precision_;
+            network->device_name_ = device_name_;
+            network->core_ = core_;
+            network->compile_config_ = compile_config_;
+            network->model_ = model_;
+            network->compiled_model_ = compiled_model_;
+            network->input_min_shapes_ = input_min_shapes_;
+            network->input_max_shapes_ = input_max_shapes_;
+            try {
+                network->infer_request_ = compiled_model_.create_infer_request();
+            } catch (const ov::Exception &e) {
+                RS_LOGE("openvino create infer request failed: %s\n", e.what());
+                return nullptr;
+            }
+            if (network->CreateBlobArray() != RS_SUCCESS) {
+                RS_LOGE("openvino clone CreateBlobArray failed\n");
+                return nullptr;
+            }
+            return network;
+        }
+
         ErrorCode OpenVinoNetWork::InitWithMemoryContent(const std::string &xml_content,
                                                          const std::string &bin_content,
                                                          const std::string &cache_dir) {
@@ -111,11 +156,20 @@ namespace rayshape
             RS_LOGD("OpenVINO model initialization from memory content\n");
 
             try {
-                // Initialize OpenVINO Core if not already done
+                // 共享进程级core,属性在compile_model时按模型传入
                 if (core_ == nullptr) {
-                    core_ = std::make_unique<ov::Core>();
-                    core_->set_property(ov::cache_dir(cache_dir));
+                    core_ = OpenVINOCore::Get();
+                    if (core_ == nullptr) {
+                        RS_LOGE("OpenVINO core is not available\n");
+                        return RS_MODEL_ERROR;
+                    }
+                }
+                compile_config_.clear();
+                compile_config_.emplace(ov::cache_dir.name(), cache_dir);
+                if (num_threads_ > 0) {
+                    compile_config_.emplace(ov::inference_num_threads.name(), num_threads_);
                 }
+                InferencePrecisionSet();
 
                 // Create a tensor from binary content
                 ov::Tensor weights_tensor;
@@ -182,42 +236,47 @@ namespace rayshape
                 RS_LOGE("key ModelConfig's value is empty!\n");
                 return RS_INVALID_PARAM;
             }
-            RSJsonObject max_shapes_arr = RSJsonObjectGet(model_obj, "MaxShapes");
-            if (max_shapes_arr == nullptr) {
-                return RS_SUCCESS;
-            }
-
-            //
-            unsigned int size = RSJsonArraySize(max_shapes_arr);
-            for (unsigned int i = 0; i < size; i++) {
-                RSJsonObject shape_obj = RSJsonArrayAt(max_shapes_arr, i);
-                RSJsonObject name_obj = RSJsonObjectGet(shape_obj, "name");
-                const char *name = RSJsonStringGet(name_obj);
-                if (name == nullptr || strlen(name) <= 0 || strlen(name) > MAX_BLOB_NAME) {
-                    RS_LOGE("InputMaxShape Name is empty or > MAX_DIMS_NAME:%d!\n", MAX_BLOB_NAME);
-                    return RS_INVALID_MODEL;
-                }
-                // 获取维度对象
-                RSJsonObject dims_arr = RSJsonObjectGet(shape_obj, "dims");
-                if (dims_arr == nullptr) {
-                    RS_LOGE("InputMaxShape Dims is Error!\n");
-                    return RS_INVALID_MODEL;
-                }
-                // 获取维度的size
-                unsigned int dims_size = RSJsonArraySize(dims_arr);
-                if (dims_size <= 0 || dims_size > MAX_DIMS_SIZE) {
-                    RS_LOGE("InputMaxShape Dims size:%d is empty or > MAX_DIMS_SIZE:%d!\n",
-                            dims_size, MAX_DIMS_SIZE);
-                    return RS_INVALID_MODEL;
+            // MaxShapes用于编译动态模型,MinShapes只用于预热
+            const char *keys[] = {"MinShapes", "MaxShapes"};
+            std::map<std::string, Dims> *shapes[] = {&input_min_shapes_, &input_max_shapes_};
+            for (int k = 0; k < 2; ++k) {
+                RSJsonObject shapes_arr = RSJsonObjectGet(model_obj, keys[k]);
+                if (shapes_arr == nullptr) {
+                    continue;
                 }
 
-                Dims dims;
-                dims.size = dims_size;
+                unsigned int size = RSJsonArraySize(shapes_arr);
+                for (unsigned int i = 0; i < size; i++) {
+                    RSJsonObject shape_obj = RSJsonArrayAt(shapes_arr, i);
+                    RSJsonObject name_obj = RSJsonObjectGet(shape_obj, "name");
+                    const char *name = RSJsonStringGet(name_obj);
+                    if (name == nullptr || strlen(name) <= 0 || strlen(name) > MAX_BLOB_NAME) {
+                        RS_LOGE("%s Name is empty or > MAX_DIMS_NAME:%d!\n", keys[k],
+                                MAX_BLOB_NAME);
+                        return RS_INVALID_MODEL;
+                    }
+                    // 获取维度对象
+                    RSJsonObject dims_arr = RSJsonObjectGet(shape_obj, "dims");
+                    if (dims_arr == nullptr) {
+                        RS_LOGE("%s Dims is Error!\n", keys[k]);
+                        return RS_INVALID_MODEL;
+                    }
+                    // 获取维度的size
+                    unsigned int dims_size = RSJsonArraySize(dims_arr);
+                    if (dims_size <= 0 || dims_size > MAX_DIMS_SIZE) {
+                        RS_LOGE("%s Dims size:%d is empty or > MAX_DIMS_SIZE:%d!\n", keys[k],
+                                dims_size, MAX_DIMS_SIZE);
+                        return RS_INVALID_MODEL;
+                    }
+
+                    Dims dims;
+                    dims.size = dims_size;
 
-                for (unsigned int j = 0; j < dims_size; j++) {
-                    dims.value[j] = RSJsonIntGet(RSJsonArrayAt(dims_arr, j), 0);
+                    for (unsigned int j = 0; j < dims_size; j++) {
+                        dims.value[j] = RSJsonIntGet(RSJsonArrayAt(dims_arr, j), 0);
+                    }
+                    (*shapes[k])[name] = dims;
                 }
-                input_max_shapes_[name] = dims;
             }
 
             return RS_SUCCESS;
@@ -234,7 +293,7 @@ namespace rayshape
             // dynamic_model need to reshape
             bool reshape_flag = false;
             // std::map<std::string, ov::PartialShape> ov_shape_w;
-            std::map<ov::Output<ov::Node>, ov::PartialShape> ov_shape_map;
+            std::map<std::string, ov::PartialShape> ov_shape_map;
             for (int i = 0; i < dims_size; ++i) {
                 const char *name = name_arr[i];
                 const Dims *dims = &dims_arr[i];
@@ -267,18 +326,23 @@ namespace rayshape
                     }
 
                     // ov_shape_w[name] = ov::PartialShape(ov_dims);
-                    ov_shape_map[input] = ov::PartialShape(ov_dims);
+                    ov_shape_map[name] = ov::PartialShape(ov_dims);
                     reshape_flag = true;
                 }
             }
             // model_->input()
             if (reshape_flag) {
                 try {
+                    // model_被Clone出的实例共享时,先复制一份再reshape,避免影响其他实例
+                    if (model_.use_count() > 1) {
+                        model_ = model_->clone();
+                    }
                     // 重新编译模型
                     model_->reshape(ov_shape_map);
                     // 设置新的形状
                     compiled_model_ = core_->compile_model(
-                        model_, device_name_); // 可根据 device_type_ 动态选择设备
+                        model_, device_name_,
+                        compile_config_); // 可根据 device_type_ 动态选择设备
                     infer_request_ = compiled_model_.create_infer_request();
                     CreateBlobArray();
                 } catch (const ov::Exception &e) {
@@ -310,8 +374,12 @@ namespace rayshape
                 model_->reshape(ov_shape);
             }
             // 完成多个最大输入的reshape
+            if (compiled_model_) {
+                return ret; // 已从预编译blob import
+            }
             try {
-                compiled_model_ = core_->compile_model(model_, device_name_); // 是否要reset
+                compiled_model_ =
+                    core_->compile_model(model_, device_name_, compile_config_); // 是否要reset
                 infer_request_ = compiled_model_.create_infer_request();
             } catch (const ov::Exception &e) {
                 RS_LOGE("compile openvino model failed: %s\n", e.what());
@@ -320,6 +388,113 @@ namespace rayshape
             return ret;
         }
 
+        void OpenVinoNetWork::InferencePrecisionSet() {
+            if (precision_ == Precision::AUTO || precision_ == Precision::NORMAL) {
+                return; // 由设备决定,如CPU在AMX/avx512_bf16上默认bf16
+            }
+
+            bool support_bf16 = false;
+            bool support_fp16 = false;
+            try {
+                std::vector<std::string> capabilities =
+                    core_->get_property(device_name_, ov::device::capabilities);
+                for (const auto &capability : capabilities) {
+                    support_bf16 |= capability == ov::device::capability::BF16;
+                    support_fp16 |= capability == ov::device::capability::FP16;
+                }
+            } catch (const ov::Exception &e) {
+                RS_LOGW("get openvino device:%s capabilities failed: %s\n", device_name_.c_str(),
+                        e.what());
+            }
+
+            ov::element::Type inference_precision = ov::element::f32;
+            if (precision_ == Precision::BF16 || precision_ == Precision::LOW) {
+                if (support_bf16) {
+                    inference_precision = ov::element::bf16;
+                } else if (precision_ == Precision::LOW && support_fp16) {
+                    inference_precision = ov::element::f16;
+                }
+            } else if (precision_ == Precision::FP16 && support_fp16) {
+                inference_precision = ov::element::f16;
+            }
+            if (inference_precision == ov::element::f32 && precision_ != Precision::HIGH) {
+                RS_LOGW("openvino device:%s does not support precision:%s, fallback to f32\n",
+                        device_name_.c_str(), PrecisionToString(precision_));
+            }
+
+            compile_config_[ov::hint::inference_precision.name()] = inference_precision;
+            RS_LOGD("openvino inference precision:%s\n",
+                    inference_precision.get_type_name().c_str());
+        }
+
+        std::string OpenVinoNetWork::CompiledDeviceGet() {
+            std::string device = device_name_;
+            try {
+                // 同一设备类型的不同型号(如CPU指令集)编译结果不通用,带上完整名称
+                device += ":" + core_->get_property(device_name_, ov::device::full_name);
+            } catch (const ov::Exception &e) {
+                RS_LOGW("get openvino device:%s full name failed: %s\n", device_name_.c_str(),
+                        e.what());
+            }
+            // 推理精度会固化在编译结果中
+            device += ":";
+            device += PrecisionToString(precision_);
+            return device;
+        }
+
+        bool OpenVinoNetWork::ImportCompiledModel(const OpenVINOModel *model) {
+            compiled_model_ = ov::CompiledModel();
+            if (model->compiled_blob_.empty()) {
+                return false;
+            }
+            std::string device = CompiledDeviceGet();
+            std::string version = ov::get_openvino_version().buildNumber;
+            if (model->compiled_device_ != device || model->compiled_version_ != version) {
+                RS_LOGI("precompiled blob(%s, %s) mismatch runtime(%s, %s), compile online\n",
+                        model->compiled_device_.c_str(), model->compiled_version_.c_str(),
+                        device.c_str(), version.c_str());
+                return false;
+            }
+
+            // cache_dir只对compile_model有意义
+            ov::AnyMap import_config = compile_config_;
+            import_config.erase(ov::cache_dir.name());
+            try {
+                std::istringstream blob_stream(model->compiled_blob_, std::ios::binary);
+                compiled_model_ = core_->import_model(blob_stream, device_name_, import_config);
+                infer_request_ = compiled_model_.create_infer_request();
+            } catch (const ov::Exception &e) {
+                RS_LOGW("import precompiled openvino blob failed, compile online: %s\n",
+                        e.what());
+                compiled_model_ = ov::CompiledModel();
+                return false;
+            }
+            RS_LOGD("openvino model imported from precompiled blob, size:%zu\n",
+                    model->compiled_blob_.size());
+            return true;
+        }
+
+        ErrorCode OpenVinoNetWork::CompiledModelExport(OpenVINOModel *model) {
+            if (model == nullptr || !compiled_model_) {
+                RS_LOGE("openvino model is not compiled, can not export\n");
+                return RS_INVALID_PARAM;
+            }
+            try {
+                std::ostringstream blob_stream(std::ios::binary);
+                compiled_model_.export_model(blob_stream);
+                model->compiled_blob_ = blob_stream.str();
+            } catch (const ov::Exception &e) {
+                RS_LOGE("export openvino compiled model failed: %s\n", e.what());
+                return RS_MODEL_ERROR;
+            }
+            model->compiled_device_ = CompiledDeviceGet();
+            model->compiled_version_ = ov::get_openvino_version().buildNumber;
+            RS_LOGD("openvino compiled model exported, device:%s version:%s size:%zu\n",
+                    model->compiled_device_.c_str(), model->compiled_version_.c_str(),
+                    model->compiled_blob_.size());
+            return RS_SUCCESS;
+        }
+
         ErrorCode OpenVinoNetWork::CreateBlobArray() {
             ErrorCode ret = RS_SUCCESS;
             ClearBlobArray();
@@ -426,30 +601,33 @@ namespace rayshape
             }
         }
 
-        ErrorCode OpenVinoNetWork::Forward() {
+        ErrorCode OpenVinoNetWork::SetInputTensors() {
             ErrorCode ret = RS_SUCCESS;
-            try {
-                for (size_t i = 0; i < input_blob_size_; ++i) {
-                    Blob *blob = input_blob_arr_[i];
-                    Buffer *blob_buffer = blob->buffer;
-                    bool need_set_input = blob_buffer->GetExternalFlag();
-                    if (!need_set_input) {
-                        const char *name = blob->name;
-                        std::shared_ptr<ov::Tensor> ov_tensor =
-                            OpenvinoBlobConverter::ConvertFromBlob(ret, blob);
-                        if (ov_tensor == nullptr || ret != RS_SUCCESS) {
-                            // log todo
-                            return ret;
-                        }
-                        infer_request_.set_tensor(name, *(ov_tensor.get()));
+            for (size_t i = 0; i < input_blob_size_; ++i) {
+                Blob *blob = input_blob_arr_[i];
+                Buffer *blob_buffer = blob->buffer;
+                bool need_set_input = blob_buffer->GetExternalFlag();
+                if (!need_set_input) {
+                    const char *name = blob->name;
+                    std::shared_ptr<ov::Tensor> ov_tensor =
+                        OpenvinoBlobConverter::ConvertFromBlob(ret, blob);
+                    if (ov_tensor == nullptr || ret != RS_SUCCESS) {
+                        RS_LOGE("convert input blob:%s to ov tensor failed\n", name);
+                        return ret;
                     }
+                    infer_request_.set_tensor(name, *(ov_tensor.get()));
                 }
+            }
+            return ret;
+        }
+
+        ErrorCode OpenVinoNetWork::Forward() {
+            ErrorCode ret = RS_SUCCESS;
+            try {
+                ret = SetInputTensors();
+                RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "openvino set input tensors failed.");
                 // 同步推理
                 infer_request_.infer();
-
-                // forward
-                // infer_request_.start_async();
-                // infer_request_.wait();
             } catch (const ov::Exception &e) {
                 printf("openvino model infer failed: %s\n", e.what());
                 return RS_MODEL_ERROR;
@@ -458,6 +636,80 @@ namespace rayshape
             return ret;
         }
 
+        ErrorCode OpenVinoNetWork::StartForward() {
+            ErrorCode ret = RS_SUCCESS;
+            try {
+                ret = SetInputTensors();
+                RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "openvino set input tensors failed.");
+                // 回调在openvino内部线程执行,输出已写入绑定的blob
+                infer_request_.set_callback([this](std::exception_ptr exception) {
+                    ErrorCode status = RS_SUCCESS;
+                    if (exception) {
+                        try {
+                            std::rethrow_exception(exception);
+                        } catch (const std::exception &e) {
+                            RS_LOGE("openvino async infer failed: %s\n", e.what());
+                            status = RS_MODEL_ERROR;
+                        }
+                    }
+                    FinishForward(status);
+                });
+                infer_request_.start_async();
+            } catch (const ov::Exception &e) {
+                RS_LOGE("openvino start async infer failed: %s\n", e.what());
+                return RS_MODEL_ERROR;
+            }
+
+            return ret;
+        }
+
+        ErrorCode OpenVinoNetWork::BindBlobTensor(Blob *blob, Buffer *buffer) {
+            CHECK_RET(BindBlobBuffer(blob, buffer))
+            // 外部buffer的blob在Forward中不再重复set_tensor
+            ErrorCode ret = RS_SUCCESS;
+            std::shared_ptr<ov::Tensor> ov_tensor =
+                OpenvinoBlobConverter::ConvertFromBlob(ret, blob);
+            if (ov_tensor == nullptr || ret != RS_SUCCESS) {
+                RS_LOGE("convert blob:%s to ov tensor failed\n", blob->name);
+                return ret != RS_SUCCESS ? ret : RS_INVALID_MODEL;
+            }
+            try {
+                infer_request_.set_tensor(blob->name, *ov_tensor);
+            } catch (const ov::Exception &e) {
+                RS_LOGE("openvino bind blob:%s failed: %s\n", blob->name, e.what());
+                return RS_MODEL_ERROR;
+            }
+            return RS_SUCCESS;
+        }
+
+        ErrorCode OpenVinoNetWork::BindInput(size_t index, Buffer *buffer) {
+            if (index >= input_blob_size_) {
+                RS_LOGE("input index:%zu >= input size:%zu\n", index, input_blob_size_);
+                return RS_INVALID_PARAM;
+            }
+            return BindBlobTensor(input_blob_arr_[index], buffer);
+        }
+
+        ErrorCode OpenVinoNetWork::BindOutput(size_t index, Buffer *buffer) {
+            if (index >= output_blob_size_) {
+                RS_LOGE("output index:%zu >= output size:%zu\n", index, output_blob_size_);
+                return RS_INVALID_PARAM;
+            }
+            return BindBlobTensor(output_blob_arr_[index], buffer);
+        }
+
+        ErrorCode OpenVinoNetWork::WarmupShapesGet(std::vector<std::map<std::string, Dims>> &shapes) {
+            shapes.clear();
+            // 动态尺寸模型在声明的最大/最小尺寸上各预热一次,最大尺寸在前以便一次分配好内存
+            if (!input_max_shapes_.empty()) {
+                shapes.push_back(input_max_shapes_);
+            }
+            if (!input_min_shapes_.empty()) {
+                shapes.push_back(input_min_shapes_);
+            }
+            return RS_SUCCESS;
+        }
+
         ErrorCode OpenVinoNetWork::InputBlobsGet(const Blob ***blob_arr, size_t *blob_size) {
             if (blob_arr == nullptr || blob_size == nullptr) {
                 RS_LOGE("blob_arr:%p or blob_size:%p is nullptr\n", blob_arr, blob_size);
@@ -0,0 +1,29 @@
+#include "inference/openvino/openvino_precompile.h"
+
+#include "inference/openvino/openvino_network.h"
+#include "base/logger.h"
+
+namespace rayshape
+{
+    namespace inference
+    {
+        namespace openvino
+        {
+            ErrorCode OpenVINOModelPrecompile(OpenVINOModel *model, const CustomRuntime *runtime) {
+                if (model == nullptr || runtime == nullptr) {
+                    RS_LOGE("model or runtime is nullptr!\n");
+                    return RS_INVALID_PARAM;
+                }
+                // 去掉旧的blob,保证走在线编译
+                model->compiled_blob_.clear();
+                model->compiled_device_.clear();
+                model->compiled_version_.clear();
+
+                OpenVinoNetWork network(InferenceType::OPENVINO);
+                ErrorCode ret = network.Init(model, runtime);
+                RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "openvino precompile init failed.");
+                return network.CompiledModelExport(model);
+            }
+        } // namespace openvino
+    } // namespace inference
+} // namespace rayshape
@@ -0,0 +1,80 @@
+#include "inference/precision.h"
+#include "base/logger.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+namespace rayshape
+{
+    namespace inference
+    {
+        ErrorCode ConvertToPrecision(Precision &dst, const std::string &src) {
+            std::string lower = src;
+            std::transform(lower.begin(), lower.end(), lower.begin(),
+                           [](unsigned char c) { return (char)std::tolower(c); });
+            if (lower == "auto") {
+                dst = Precision::AUTO;
+            } else if (lower == "normal") {
+                dst = Precision::NORMAL;
+            } else if (lower == "high" || lower == "fp32") {
+                dst = Precision::HIGH;
+            } else if (lower == "low") {
+                dst = Precision::LOW;
+            } else if (lower == "bf16") {
+                dst = Precision::BF16;
+            } else if (lower == "fp16" || lower == "f16") {
+                dst = Precision::FP16;
+            } else {
+                RS_LOGE("Unsupported Precision: %s\n", src.c_str());
+                return RS_INVALID_PARAM_VALUE;
+            }
+            return RS_SUCCESS;
+        }
+
+        const char *PrecisionToString(Precision src) {
+            switch (src) {
+            case Precision::AUTO:
+                return "auto";
+            case Precision::NORMAL:
+                return "normal";
+            case Precision::HIGH:
+                return "high";
+            case Precision::LOW:
+                return "low";
+            case Precision::BF16:
+                return "bf16";
+            case Precision::FP16:
+                return "fp16";
+            default:
+                return "unknown";
+            }
+        }
+
+        ErrorCode ParsePrecision(const utils::RSJsonHandle json_handle, Precision &precision) {
+            utils::RSJsonObject root_obj = utils::RSJsonRootGet(json_handle);
+            utils::RSJsonObject network_obj = utils::RSJsonObjectGet(root_obj, "NetworkConfig");
+            if (network_obj == nullptr) {
+                return RS_SUCCESS;
+            }
+            // 未配置Precision(或为空串)时保持原值
+            utils::RSJsonObject precision_obj = utils::RSJsonObjectGet(network_obj, "Precision");
+            if (precision_obj == nullptr) {
+                return RS_SUCCESS;
+            }
+            const char *value = utils::RSJsonStringGet(precision_obj);
+            if (strlen(value) == 0) {
+                return RS_SUCCESS;
+            }
+            Precision json_precision = Precision::AUTO;
+            ErrorCode ret = ConvertToPrecision(json_precision, value);
+            RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "NetworkConfig Precision is invalid.");
+            // 调用方在CustomRuntime中显式指定的精度优先
+            if (precision == Precision::AUTO) {
+                precision = json_precision;
+            }
+            return RS_SUCCESS;
+        }
+
+    } // namespace inference
+} // namespace rayshape
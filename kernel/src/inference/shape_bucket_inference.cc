@@ -0,0 +1,684 @@
+#include "inference/shape_bucket_inference.h"
+
+#include "utils/memory_size_info.h"
+#include "utils/blob_utils.h"
+#include "base/logger.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace rayshape::utils;
+
+namespace rayshape
+{
+    namespace inference
+    {
+        static bool IsSameDims(const Dims &lhs, const Dims &rhs) {
+            if (lhs.size != rhs.size) {
+                return false;
+            }
+            for (int i = 0; i < lhs.size; ++i) {
+                if (lhs.value[i] != rhs.value[i]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // 按最内层连续维度做memcpy,拷贝一个extent大小的n维块
+        static void CopyBox(const char *src, const Dims &src_dims, const Dims &src_offset,
+                            char *dst, const Dims &dst_dims, const Dims &dst_offset,
+                            const Dims &extent, size_t elem_size) {
+            int rank = extent.size;
+            size_t src_stride[MAX_DIMS_SIZE];
+            size_t dst_stride[MAX_DIMS_SIZE];
+            src_stride[rank - 1] = elem_size;
+            dst_stride[rank - 1] = elem_size;
+            for (int i = rank - 2; i >= 0; --i) {
+                src_stride[i] = src_stride[i + 1] * src_dims.value[i + 1];
+                dst_stride[i] = dst_stride[i + 1] * dst_dims.value[i + 1];
+            }
+
+            size_t row_bytes = extent.value[rank - 1] * elem_size;
+            size_t rows = 1;
+            for (int i = 0; i < rank - 1; ++i) {
+                rows *= extent.value[i];
+            }
+
+            int index[MAX_DIMS_SIZE] = {0};
+            for (size_t r = 0; r < rows; ++r) {
+                size_t src_pos = src_offset.value[rank - 1] * elem_size;
+                size_t dst_pos = dst_offset.value[rank - 1] * elem_size;
+                for (int i = 0; i < rank - 1; ++i) {
+                    src_pos += (index[i] + src_offset.value[i]) * src_stride[i];
+                    dst_pos += (index[i] + dst_offset.value[i]) * dst_stride[i];
+                }
+                memcpy(dst + dst_pos, src + src_pos, row_bytes);
+
+                for (int i = rank - 2; i >= 0; --i) {
+                    if (++index[i] < extent.value[i]) {
+                        break;
+                    }
+                    index[i] = 0;
+                }
+            }
+        }
+
+        static void FillBlob(Blob *blob, int value) {
+            void *data = blob->buffer->GetDataPtr();
+            size_t count = CalculateDims(blob->dims);
+            if (value == 0) {
+                memset(data, 0, count * GetBytesSize(blob->data_type));
+                return;
+            }
+            switch (blob->data_type) {
+            case DataType::FLOAT:
+                std::fill_n(static_cast<float *>(data), count, static_cast<float>(value));
+                break;
+            case DataType::INT8:
+                std::fill_n(static_cast<int8_t *>(data), count, static_cast<int8_t>(value));
+                break;
+            case DataType::UINT8:
+                std::fill_n(static_cast<uint8_t *>(data), count, static_cast<uint8_t>(value));
+                break;
+            case DataType::INT32:
+                std::fill_n(static_cast<int32_t *>(data), count, static_cast<int32_t>(value));
+                break;
+            case DataType::INT64:
+                std::fill_n(static_cast<int64_t *>(data), count, static_cast<int64_t>(value));
+                break;
+            case DataType::UINT32:
+                std::fill_n(static_cast<uint32_t *>(data), count, static_cast<uint32_t>(value));
+                break;
+            default:
+                RS_LOGW("data_type:%d not support pad value:%d, pad with 0\n",
+                        (int)blob->data_type, value);
+                memset(data, 0, count * GetBytesSize(blob->data_type));
+                break;
+            }
+        }
+
+        static ErrorCode CheckBoxCopy(const Blob *src, const Blob *dst) {
+            if (src == nullptr || dst == nullptr || src->buffer == nullptr
+                || dst->buffer == nullptr) {
+                RS_LOGE("src:%p or dst:%p blob is invalid.\n", src, dst);
+                return RS_INVALID_PARAM;
+            }
+            if (src->data_type != dst->data_type || src->dims.size != dst->dims.size
+                || src->dims.size <= 0) {
+                RS_LOGE("src blob data_type:%d,rank:%d;dst blob data_type:%d,rank:%d.\n",
+                        (int)src->data_type, src->dims.size, (int)dst->data_type, dst->dims.size);
+                return RS_INVALID_PARAM;
+            }
+            if (src->buffer->GetDataPtr() == nullptr || dst->buffer->GetDataPtr() == nullptr) {
+                RS_LOGE("src or dst blob data is null.\n");
+                return RS_INVALID_PARAM;
+            }
+            return RS_SUCCESS;
+        }
+
+        ErrorCode ParseShapeBuckets(const RSJsonHandle json_handle, ShapeBucketPolicy &policy) {
+            policy.buckets_.clear();
+
+            RSJsonObject root_obj = RSJsonRootGet(json_handle);
+            RSJsonObject model_obj = RSJsonObjectGet(root_obj, "ModelConfig");
+            if (model_obj == nullptr) {
+                return RS_SUCCESS;
+            }
+            RSJsonObject bucket_obj = RSJsonObjectGet(model_obj, "ShapeBuckets");
+            if (bucket_obj == nullptr) {
+                return RS_SUCCESS;
+            }
+
+            // 未配置PadMode时默认pad
+            RSJsonObject pad_mode_obj = RSJsonObjectGet(bucket_obj, "PadMode");
+            const char *pad_mode = pad_mode_obj != nullptr ? RSJsonStringGet(pad_mode_obj) : "";
+            if (strlen(pad_mode) == 0 || strcmp(pad_mode, "pad") == 0) {
+                policy.pad_mode_ = BucketPadMode::PAD;
+            } else if (strcmp(pad_mode, "letterbox") == 0) {
+                policy.pad_mode_ = BucketPadMode::LETTERBOX;
+            } else {
+                RS_LOGE("Unsupported ShapeBuckets PadMode: %s\n", pad_mode);
+                return RS_INVALID_PARAM;
+            }
+            policy.pad_value_ = RSJsonIntGet(RSJsonObjectGet(bucket_obj, "PadValue"), 0);
+
+            RSJsonObject shapes_arr = RSJsonObjectGet(bucket_obj, "Shapes");
+            if (shapes_arr == nullptr) {
+                RS_LOGE("key ShapeBuckets's Shapes is empty!\n");
+                return RS_INVALID_PARAM;
+            }
+            unsigned int size = RSJsonArraySize(shapes_arr);
+            for (unsigned int i = 0; i < size; i++) {
+                RSJsonObject shape_obj = RSJsonArrayAt(shapes_arr, i);
+                const char *name = RSJsonStringGet(RSJsonObjectGet(shape_obj, "name"));
+                if (name == nullptr || strlen(name) <= 0 || strlen(name) > MAX_BLOB_NAME) {
+                    RS_LOGE("ShapeBuckets Name is empty or > MAX_BLOB_NAME:%d!\n", MAX_BLOB_NAME);
+                    return RS_INVALID_MODEL;
+                }
+                RSJsonObject dims_list = RSJsonObjectGet(shape_obj, "dims");
+                unsigned int bucket_size = RSJsonArraySize(dims_list);
+                if (dims_list == nullptr || bucket_size <= 0) {
+                    RS_LOGE("ShapeBuckets %s dims is empty!\n", name);
+                    return RS_INVALID_MODEL;
+                }
+                std::vector<Dims> buckets;
+                for (unsigned int j = 0; j < bucket_size; j++) {
+                    RSJsonObject dims_arr = RSJsonArrayAt(dims_list, j);
+                    unsigned int dims_size = RSJsonArraySize(dims_arr);
+                    if (dims_size <= 0 || dims_size > MAX_DIMS_SIZE) {
+                        RS_LOGE("ShapeBuckets Dims size:%d is empty or > MAX_DIMS_SIZE:%d!\n",
+                                dims_size, MAX_DIMS_SIZE);
+                        return RS_INVALID_MODEL;
+                    }
+                    Dims dims;
+                    dims.size = dims_size;
+                    for (unsigned int k = 0; k < dims_size; k++) {
+                        dims.value[k] = RSJsonIntGet(RSJsonArrayAt(dims_arr, k), 0);
+                        if (dims.value[k] <= 0) {
+                            RS_LOGE("ShapeBuckets %s dims value must be > 0!\n", name);
+                            return RS_INVALID_MODEL;
+                        }
+                    }
+                    buckets.emplace_back(dims);
+                }
+                policy.buckets_[name] = buckets;
+            }
+
+            return RS_SUCCESS;
+        }
+
+        ErrorCode SelectShapeBucket(const std::vector<Dims> &buckets, const Dims &dims,
+                                    Dims &bucket) {
+            const Dims *best = nullptr;
+            size_t best_volume = 0;
+            for (const auto &candidate : buckets) {
+                if (candidate.size != dims.size) {
+                    continue;
+                }
+                bool fit = true;
+                for (int i = 0; i < dims.size; ++i) {
+                    if (dims.value[i] > candidate.value[i]) {
+                        fit = false;
+                        break;
+                    }
+                }
+                size_t volume = CalculateDims(candidate);
+                if (fit && (best == nullptr || volume < best_volume)) {
+                    best = &candidate;
+                    best_volume = volume;
+                }
+            }
+            if (best == nullptr) {
+                return RS_INVALID_PARAM_VALUE;
+            }
+            bucket = *best;
+            return RS_SUCCESS;
+        }
+
+        void ComputeBucketOffset(BucketPadMode mode, DataFormat data_format, const Dims &dims,
+                                 const Dims &bucket, Dims &offset) {
+            offset.size = dims.size;
+            for (int i = 0; i < dims.size; ++i) {
+                offset.value[i] = 0;
+            }
+            if (mode != BucketPadMode::LETTERBOX || dims.size < 2) {
+                return;
+            }
+            int h_axis = dims.size - 2;
+            if ((data_format == DataFormat::NHWC || data_format == DataFormat::NHWC4)
+                && dims.size == 4) {
+                h_axis = 1;
+            }
+            for (int i = h_axis; i < h_axis + 2; ++i) {
+                offset.value[i] = (bucket.value[i] - dims.value[i]) / 2;
+            }
+        }
+
+        ErrorCode PadBlobToBucket(const Blob *src, Blob *dst, const Dims &offset, int pad_value) {
+            ErrorCode ret = CheckBoxCopy(src, dst);
+            if (ret != RS_SUCCESS) {
+                return ret;
+            }
+            for (int i = 0; i < src->dims.size; ++i) {
+                if (offset.value[i] + src->dims.value[i] > dst->dims.value[i]) {
+                    RS_LOGE("blob:%s dim[%d]:%d + offset:%d > bucket:%d\n", src->name, i,
+                            src->dims.value[i], offset.value[i], dst->dims.value[i]);
+                    return RS_INVALID_PARAM_VALUE;
+                }
+            }
+
+            if (!IsSameDims(src->dims, dst->dims)) {
+                FillBlob(dst, pad_value);
+            }
+            Dims zero = {src->dims.size, {0}};
+            CopyBox(static_cast<const char *>(src->buffer->GetDataPtr()), src->dims, zero,
+                    static_cast<char *>(dst->buffer->GetDataPtr()), dst->dims, offset, src->dims,
+                    GetBytesSize(src->data_type));
+            return RS_SUCCESS;
+        }
+
+        ErrorCode CropBlobFromBucket(const Blob *src, Blob *dst, const Dims &offset) {
+            ErrorCode ret = CheckBoxCopy(src, dst);
+            if (ret != RS_SUCCESS) {
+                return ret;
+            }
+            for (int i = 0; i < dst->dims.size; ++i) {
+                if (offset.value[i] + dst->dims.value[i] > src->dims.value[i]) {
+                    RS_LOGE("blob:%s dim[%d]:%d + offset:%d > bucket:%d\n", src->name, i,
+                            dst->dims.value[i], offset.value[i], src->dims.value[i]);
+                    return RS_INVALID_PARAM_VALUE;
+                }
+            }
+
+            Dims zero = {dst->dims.size, {0}};
+            CopyBox(static_cast<const char *>(src->buffer->GetDataPtr()), src->dims, offset,
+                    static_cast<char *>(dst->buffer->GetDataPtr()), dst->dims, zero, dst->dims,
+                    GetBytesSize(src->data_type));
+            return RS_SUCCESS;
+        }
+
+        // 容量不足时按need重新分配blob,否则只修改dims
+        static ErrorCode EnsureBlob(Blob **blob, const Blob *like, const Dims &dims,
+                                    const Dims &capacity) {
+            if (*blob != nullptr && (*blob)->buffer->GetDataSize() >= CalculateDims(dims)) {
+                (*blob)->dims = dims;
+                return RS_SUCCESS;
+            }
+            Blob *new_blob = BlobAlloc(DeviceType::CPU, like->data_type, like->data_format,
+                                       like->name, &capacity);
+            if (new_blob == nullptr) {
+                RS_LOGE("BlobAlloc %s failed\n", like->name);
+                return RS_OUTOFMEMORY;
+            }
+            new_blob->dims = dims;
+            if (*blob != nullptr) {
+                BlobFree(*blob);
+            }
+            *blob = new_blob;
+            return RS_SUCCESS;
+        }
+
+        ShapeBucketInference::ShapeBucketInference(InferenceType type) : Inference(type) {
+            inference_ = CreateInference(type);
+        }
+
+        ShapeBucketInference::~ShapeBucketInference() {
+            Wait();
+            ClearBlobArray();
+        }
+
+        ErrorCode ShapeBucketInference::Init(const Model *model, const CustomRuntime *runtime) {
+            ErrorCode ret = RS_SUCCESS;
+
+            if (inference_ == nullptr) {
+                RS_LOGE("inference type:%d is not registered!\n", (int)type_);
+                return RS_INVALID_PARAM;
+            }
+            if (model == nullptr || runtime == nullptr) {
+                RS_LOGE("model or runtime is nullptr!\n");
+                return RS_INVALID_PARAM;
+            }
+
+            const std::string *cfg_str = GetModelConfig(model);
+            if (cfg_str != nullptr && !cfg_str->empty()) {
+                RSJsonHandle json_handle = nullptr;
+                if ((ret = RSJsonCreate(*cfg_str, &json_handle)) != RS_SUCCESS) {
+                    RS_LOGE("RSJsonCreate failed:%d\n", ret);
+                    return ret;
+                }
+                ret = ParseShapeBuckets(json_handle, policy_);
+                RSJsonDestory(&json_handle);
+                if (ret != RS_SUCCESS) {
+                    RS_LOGE("ParseShapeBuckets failed:%d!\n", ret);
+                    return ret;
+                }
+            }
+
+            if ((ret = inference_->Init(model, runtime)) != RS_SUCCESS) {
+                RS_LOGE("inference Init failed:%d!\n", ret);
+                return ret;
+            }
+
+            return CreateBlobArray();
+        }
+
+        void ShapeBucketInference::DeInit() {
+            ClearBlobArray();
+            if (inference_ != nullptr) {
+                inference_->DeInit();
+            }
+        }
+
+        ErrorCode ShapeBucketInference::CreateBlobArray() {
+            ClearBlobArray();
+
+            const Blob **inner_blobs = nullptr;
+            size_t inner_size = 0;
+            ErrorCode ret = inference_->InputBlobsGet(&inner_blobs, &inner_size);
+            RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "inference InputBlobsGet failed.");
+
+            for (size_t i = 0; i < inner_size; ++i) {
+                const Blob *inner = inner_blobs[i];
+                auto iter = policy_.buckets_.find(inner->name);
+                if (iter == policy_.buckets_.end()) {
+                    continue;
+                }
+                // 按最大的桶分配,之后切换桶不再重新申请内存
+                Dims capacity = inner->dims;
+                for (const auto &bucket : iter->second) {
+                    if (CalculateDims(bucket) > CalculateDims(capacity)) {
+                        capacity = bucket;
+                    }
+                }
+                Blob *blob = nullptr;
+                if ((ret = EnsureBlob(&blob, inner, inner->dims, capacity)) != RS_SUCCESS) {
+                    ClearBlobArray();
+                    return ret;
+                }
+                bucket_input_blobs_[inner->name] = blob;
+                input_buckets_[inner->name] = inner->dims;
+                input_offsets_[inner->name] = Dims{inner->dims.size, {0}};
+            }
+
+            for (const auto &it : policy_.buckets_) {
+                if (bucket_input_blobs_.find(it.first) == bucket_input_blobs_.end()) {
+                    RS_LOGW("ShapeBuckets input:%s not found in model inputs\n", it.first.c_str());
+                }
+            }
+
+            return UpdateInputBlobArray();
+        }
+
+        ErrorCode ShapeBucketInference::UpdateInputBlobArray() {
+            const Blob **inner_blobs = nullptr;
+            size_t inner_size = 0;
+            ErrorCode ret = inference_->InputBlobsGet(&inner_blobs, &inner_size);
+            RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "inference InputBlobsGet failed.");
+
+            input_blobs_.clear();
+            for (size_t i = 0; i < inner_size; ++i) {
+                auto iter = bucket_input_blobs_.find(inner_blobs[i]->name);
+                input_blobs_.emplace_back(iter != bucket_input_blobs_.end()
+                                              ? iter->second
+                                              : const_cast<Blob *>(inner_blobs[i]));
+            }
+
+            const Blob **inner_outputs = nullptr;
+            ret = inference_->OutputBlobsGet(&inner_outputs, &inner_size);
+            RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "inference OutputBlobsGet failed.");
+
+            output_blobs_.clear();
+            for (size_t i = 0; i < inner_size; ++i) {
+                output_blobs_.emplace_back(const_cast<Blob *>(inner_outputs[i]));
+            }
+            return RS_SUCCESS;
+        }
+
+        void ShapeBucketInference::ClearBlobArray() {
+            for (auto &it : bucket_input_blobs_) {
+                BlobFree(it.second);
+            }
+            bucket_input_blobs_.clear();
+            for (auto &it : crop_output_blobs_) {
+                BlobFree(it.second);
+            }
+            crop_output_blobs_.clear();
+            input_buckets_.clear();
+            input_offsets_.clear();
+            input_blobs_.clear();
+            output_blobs_.clear();
+        }
+
+        ErrorCode ShapeBucketInference::Reshape(const char **name_arr, const Dims *dims_arr,
+                                                size_t dims_size) {
+            ErrorCode ret = RS_SUCCESS;
+
+            if (name_arr == nullptr || dims_arr == nullptr) {
+                RS_LOGE("Invalid input parameters for Reshape.\n");
+                return RS_INVALID_PARAM;
+            }
+            if (bucket_input_blobs_.empty()) {
+                ret = inference_->Reshape(name_arr, dims_arr, dims_size);
+                if (ret == RS_SUCCESS) {
+                    ret = UpdateInputBlobArray();
+                }
+                return ret;
+            }
+
+            // 只把和内部推理引擎当前尺寸不同的输入交给它reshape
+            std::vector<const char *> inner_names;
+            std::vector<Dims> inner_dims;
+            for (size_t i = 0; i < dims_size; ++i) {
+                const char *name = name_arr[i];
+                if (name == nullptr) {
+                    RS_LOGE("Input name at index %zu is null.\n", i);
+                    return RS_INVALID_PARAM;
+                }
+                Dims target = dims_arr[i];
+                auto iter = bucket_input_blobs_.find(name);
+                if (iter != bucket_input_blobs_.end()) {
+                    Dims bucket;
+                    if (SelectShapeBucket(policy_.buckets_[name], dims_arr[i], bucket)
+                        != RS_SUCCESS) {
+                        RS_LOGE("input:%s no ShapeBuckets fits the request shape\n", name);
+                        return RS_INVALID_PARAM_VALUE;
+                    }
+                    Blob *blob = iter->second;
+                    if ((ret = EnsureBlob(&iter->second, blob, dims_arr[i], bucket))
+                        != RS_SUCCESS) {
+                        return ret;
+                    }
+                    ComputeBucketOffset(policy_.pad_mode_, iter->second->data_format, dims_arr[i],
+                                        bucket, input_offsets_[name]);
+                    input_buckets_[name] = bucket;
+                    target = bucket;
+                }
+
+                Blob *inner = nullptr;
+                if ((ret = inference_->InputBlobGet(name, &inner)) != RS_SUCCESS) {
+                    return ret;
+                }
+                if (!IsSameDims(inner->dims, target)) {
+                    inner_names.emplace_back(name);
+                    inner_dims.emplace_back(target);
+                }
+            }
+
+            if (!inner_names.empty()) {
+                ret = inference_->Reshape(inner_names.data(), inner_dims.data(), inner_names.size());
+                if (ret != RS_SUCCESS) {
+                    RS_LOGE("inference Reshape to bucket failed:%d\n", ret);
+                    return ret;
+                }
+            }
+            return UpdateInputBlobArray();
+        }
+
+        ErrorCode ShapeBucketInference::Forward() {
+            ErrorCode ret = RS_SUCCESS;
+
+            for (const auto &it : bucket_input_blobs_) {
+                Blob *inner = nullptr;
+                if ((ret = inference_->InputBlobGet(it.first.c_str(), &inner)) != RS_SUCCESS) {
+                    return ret;
+                }
+                ret = PadBlobToBucket(it.second, inner, input_offsets_[it.first],
+                                      policy_.pad_value_);
+                RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "PadBlobToBucket failed.");
+            }
+
+            if ((ret = inference_->Forward()) != RS_SUCCESS) {
+                return ret;
+            }
+
+            if (bucket_input_blobs_.empty()) {
+                return UpdateInputBlobArray();
+            }
+            return CropOutputs();
+        }
+
+        ErrorCode ShapeBucketInference::CropOutputs() {
+            const Blob **inner_outputs = nullptr;
+            size_t inner_size = 0;
+            ErrorCode ret = inference_->OutputBlobsGet(&inner_outputs, &inner_size);
+            RS_RETURN_ON_NEQ(ret, RS_SUCCESS, "inference OutputBlobsGet failed.");
+
+            output_blobs_.clear();
+            for (size_t i = 0; i < inner_size; ++i) {
+                const Blob *inner = inner_outputs[i];
+                Dims crop_dims = inner->dims;
+                Dims crop_offset = {inner->dims.size, {0}};
+                bool need_crop = false;
+                bool can_crop = true;
+
+                // 以同维度的分桶输入为参照,按输出/桶的整数比例换算实际尺寸
+                for (const auto &it : bucket_input_blobs_) {
+                    const Dims &bucket = input_buckets_[it.first];
+                    const Dims &dims = it.second->dims;
+                    const Dims &offset = input_offsets_[it.first];
+                    if (bucket.size != inner->dims.size || IsSameDims(bucket, dims)) {
+                        continue;
+                    }
+                    for (int d = 0; d < bucket.size && can_crop; ++d) {
+                        int out = inner->dims.value[d];
+                        if (bucket.value[d] == dims.value[d]) {
+                            continue;
+                        }
+                        if (out <= bucket.value[d] && bucket.value[d] % out == 0) {
+                            int stride = bucket.value[d] / out;
+                            crop_dims.value[d] = (dims.value[d] + stride - 1) / stride;
+                            crop_offset.value[d] = offset.value[d] / stride;
+                        } else if (out % bucket.value[d] == 0) {
+                            int scale = out / bucket.value[d];
+                            crop_dims.value[d] = dims.value[d] * scale;
+                            crop_offset.value[d] = offset.value[d] * scale;
+                        } else {
+                            can_crop = false;
+                        }
+                    }
+                    need_crop = can_crop;
+                    break;
+                }
+
+                if (!need_crop) {
+                    output_blobs_.emplace_back(const_cast<Blob *>(inner));
+                    continue;
+                }
+                Blob *&blob = crop_output_blobs_[inner->name];
+                if ((ret = EnsureBlob(&blob, inner, crop_dims, inner->dims)) != RS_SUCCESS) {
+                    return ret;
+                }
+                if ((ret = CropBlobFromBucket(inner, blob, crop_offset)) != RS_SUCCESS) {
+                    RS_LOGE("CropBlobFromBucket output:%s failed:%d\n", inner->name, ret);
+                    return ret;
+                }
+                output_blobs_.emplace_back(blob);
+            }
+            return RS_SUCCESS;
+        }
+
+        ErrorCode ShapeBucketInference::WarmupShapesGet(
+            std::vector<std::map<std::string, Dims>> &shapes) {
+            shapes.clear();
+            if (policy_.buckets_.empty()) {
+                return inference_->WarmupShapesGet(shapes);
+            }
+
+            size_t bucket_count = 0;
+            for (const auto &it : policy_.buckets_) {
+                bucket_count = std::max(bucket_count, it.second.size());
+            }
+            for (size_t k = 0; k < bucket_count; ++k) {
+                std::map<std::string, Dims> shape;
+                for (const auto &it : policy_.buckets_) {
+                    shape[it.first] = it.second[std::min(k, it.second.size() - 1)];
+                }
+                shapes.push_back(shape);
+            }
+            return RS_SUCCESS;
+        }
+
+        ErrorCode ShapeBucketInference::BucketOffsetGet(const char *input_name, Dims *bucket,
+                                                        Dims *offset) {
+            if (input_name == nullptr || bucket == nullptr || offset == nullptr) {
+                RS_LOGE("input_name, bucket or offset is nullptr\n");
+                return RS_INVALID_PARAM;
+            }
+            auto iter = input_buckets_.find(input_name);
+            if (iter == input_buckets_.end()) {
+                RS_LOGE("input:%s has no ShapeBuckets\n", input_name);
+                return RS_INVALID_PARAM;
+            }
+            *bucket = iter->second;
+            *offset = input_offsets_[input_name];
+            return RS_SUCCESS;
+        }
+
+        ErrorCode ShapeBucketInference::InputBlobsGet(const Blob ***blob_arr, size_t *blob_size) {
+            if (blob_arr == nullptr || blob_size == nullptr) {
+                RS_LOGE("blob_arr:%p or blob_size:%p is nullptr\n", blob_arr, blob_size);
+                return RS_INVALID_PARAM;
+            }
+            if (input_blobs_.empty()) {
+                RS_LOGE("input blobs is empty\n");
+                return RS_INVALID_MODEL;
+            }
+            *blob_arr = (const Blob **)input_blobs_.data();
+            *blob_size = input_blobs_.size();
+            return RS_SUCCESS;
+        }
+
+        ErrorCode ShapeBucketInference::OutputBlobsGet(const Blob ***blob_arr, size_t *blob_size) {
+            if (blob_arr == nullptr || blob_size == nullptr) {
+                RS_LOGE("blob_arr:%p or blob_size:%p is nullptr\n", blob_arr, blob_size);
+                return RS_INVALID_PARAM;
+            }
+            if (output_blobs_.empty()) {
+                RS_LOGE("output blobs is empty\n");
+                return RS_INVALID_MODEL;
+            }
+            *blob_arr = (const Blob **)output_blobs_.data();
+            *blob_size = output_blobs_.size();
+            return RS_SUCCESS;
+        }
+
+        ErrorCode ShapeBucketInference::InputBlobGet(const char *input_name, Blob **blob) {
+            if (blob == nullptr || input_blobs_.empty()) {
+                RS_LOGE("blob:%p is nullptr or input blobs is empty\n", blob);
+                return RS_INVALID_MODEL;
+            }
+            int index = -1;
+            *blob = FindBlobAndIndexByName(input_blobs_.data(), input_blobs_.size(), input_name,
+                                           &index);
+            if (*blob == nullptr) {
+                RS_LOGE("Not find Blob name:%s\n", input_name != nullptr ? input_name : "");
+                return RS_INVALID_PARAM;
+            }
+            return RS_SUCCESS;
+        }
+
+        ErrorCode ShapeBucketInference::OutputBlobGet(const char *output_name, const Blob **blob) {
+            if (blob == nullptr || output_blobs_.empty()) {
+                RS_LOGE("blob:%p is nullptr or output blobs is empty\n", blob);
+                return RS_INVALID_MODEL;
+            }
+            int index = -1;
+            Blob *find_blob = FindBlobAndIndexByName(output_blobs_.data(), output_blobs_.size(),
+                                                     output_name, &index);
+            if (find_blob == nullptr) {
+                RS_LOGE("Not find Blob name:%s\n", output_name != nullptr ? output_name : "");
+                return RS_INVALID_PARAM;
+            }
+            *blob = find_blob;
+            return RS_SUCCESS;
+        }
+
+        std::shared_ptr<Inference> CreateShapeBucketInference(InferenceType type) {
+            if (GetGlobalInferenceCreatorMap().count(type) <= 0) {
+                return nullptr;
+            }
+            return std::make_shared<ShapeBucketInference>(type);
+        }
+
+    } // namespace inference
+} // namespace rayshape
@@ -24,6 +24,7 @@ namespace rayshape
         TensorRTNetWork::TensorRTNetWork(InferenceType type) : Inference(type) {}
 
         TensorRTNetWork::~TensorRTNetWork() {
+            Wait();
             ClearBlobArray();
             if (stream_) {
                 cudaStreamDestroy(stream_);
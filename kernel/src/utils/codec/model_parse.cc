@@ -77,8 +77,7 @@ namespace rayshape
             std::istringstream iss(std::string(model_data.begin(), model_data.end()),
                                    std::ios::binary);
             ModelCodec model_codec;
-            cereal::BinaryInputArchive ia(iss);
-            ia(model_codec);
+            ModelCodecLoad(iss, model_codec);
 
             if (model_codec.model_ == nullptr) {
                 RS_LOGE("Parsed model is null from file: %s\n", filename.c_str());
@@ -137,8 +136,7 @@ namespace rayshape
             std::istringstream iss(std::string(model_data.begin(), model_data.end()),
                                    std::ios::binary);
             ModelCodec model_codec;
-            cereal::BinaryInputArchive ia(iss);
-            ia(model_codec);
+            ModelCodecLoad(iss, model_codec);
 
             if (model_codec.model_ == nullptr) {
                 RS_LOGE("Parsed model is null from memory buffer\n");
@@ -111,6 +111,16 @@ namespace rayshape  //rayshape
     // 不允许使用继承成员
     ErrorCode ClassificationInfer::Init() {
         ErrorCode ret = RS_SUCCESS;
+        if (inference_pool_ != nullptr) {
+            // 共享池中的编译模型,不再单独加载
+            ret = inference_pool_->Acquire(inference_);
+            if (ret != RS_SUCCESS) {
+                RS_LOGE("Failed to acquire inference from pool.\n");
+                return ret;
+            }
+            return InitBlobRing();
+        }
+
         std::string model_path = "D:/Program/rayshape_deploy/model/breast_thyroid/rsm/checkpoint-best-openvino.rsm";
 
         auto model = LoadModel(model_path);  //模型路径不正确
@@ -135,6 +145,11 @@ namespace rayshape  //rayshape
             return ret;
         }
 
+        ret = InitBlobRing();
+        if (ret != RS_SUCCESS) {
+            return ret;
+        }
+
         // 手动创建边？
         //  获取模型输入输出的描述
         //  inference_
@@ -147,8 +162,33 @@ namespace rayshape  //rayshape
         return RS_SUCCESS;
     }
 
+    ErrorCode ClassificationInfer::InitBlobRing() {
+        if (blob_ring_depth_ <= 0) {
+            return RS_SUCCESS;
+        }
+        blob_ring_ = std::make_shared<inference::BlobRing>();
+        ErrorCode ret = blob_ring_->Init(inference_.get(), blob_ring_depth_);
+        if (ret != RS_SUCCESS) {
+            RS_LOGE("Failed to init blob ring.\n");
+            blob_ring_ = nullptr;
+        }
+        return ret;
+    }
+
     ErrorCode ClassificationInfer::DeInit() {
         ErrorCode ret = RS_SUCCESS;
+        if (blob_ring_ != nullptr) {
+            // 已交给下游的输出buffer在其析构前仍然有效
+            blob_ring_->DeInit();
+            blob_ring_ = nullptr;
+        }
+        if (inference_pool_ != nullptr) {
+            if (inference_ != nullptr) {
+                ret = inference_pool_->Release(inference_);
+                inference_ = nullptr;
+            }
+            return ret;
+        }
         inference_->DeInit();
 
         return ret;
@@ -160,6 +200,32 @@ namespace rayshape  //rayshape
         return RS_SUCCESS;
     }
 
+    ErrorCode ClassificationInfer::SetInferencePool(
+        std::shared_ptr<inference::InferencePool> pool) {
+        inference_pool_ = pool;
+
+        return RS_SUCCESS;
+    }
+
+    ErrorCode ClassificationInfer::Warmup() {
+        if (inference_ == nullptr) {
+            RS_LOGE("inference is not initialized.\n");
+            return RS_INVALID_MODEL;
+        }
+        ErrorCode ret = inference_->Warmup();
+        if (ret != RS_SUCCESS) {
+            RS_LOGE("Failed to warmup inference.\n");
+        }
+
+        return ret;
+    }
+
+    ErrorCode ClassificationInfer::SetBlobRingDepth(int depth) {
+        blob_ring_depth_ = depth;
+
+        return RS_SUCCESS;
+    }
+
     ErrorCode ClassificationInfer::Run() {
         ErrorCode ret = RS_SUCCESS;
         std::vector<cv::Mat *> mats; // 只有一个输入,自己在node的run中确定
@@ -172,11 +238,31 @@ namespace rayshape  //rayshape
         // Blob *input_blob = nullptr;
         inference_input_names_ = {"inputs"}; //暂时先定死由自己定义.
         std::vector<Blob *> input_blobs(inference_input_names_.size(), nullptr);
+        int slot = -1;
+        if (blob_ring_ != nullptr) {
+            // 等待一组空闲槽位,下游还持有所有槽位的输出时在这里形成背压
+            ret = blob_ring_->Acquire(&slot);
+            if (ret != RS_SUCCESS) {
+                RS_LOGE("Failed to acquire blob ring slot.\n");
+                return ret;
+            }
+        }
         int i = 0;
         for (const std::string &str : inference_input_names_) {
-            ret = inference_->InputBlobGet(str.c_str(), &input_blobs[i++]);
+            if (blob_ring_ != nullptr) {
+                size_t index = 0;
+                ret = inference_->InputIndexGet(str.c_str(), &index);
+                if (ret == RS_SUCCESS) {
+                    ret = blob_ring_->InputBlobGet(slot, index, &input_blobs[i++]);
+                }
+            } else {
+                ret = inference_->InputBlobGet(str.c_str(), &input_blobs[i++]);
+            }
             if (ret != RS_SUCCESS) {
                 RS_LOGE("Failed to get input blob.\n");
+                if (slot >= 0) {
+                    blob_ring_->Release(slot);
+                }
                 return ret;
             }
         }
@@ -186,6 +272,9 @@ namespace rayshape  //rayshape
             ret = MatToBlob(*mat, input_blobs[i]);
             if (ret != RS_SUCCESS) {
                 RS_LOGE("Failed to convert mat to blob.\n");
+                if (slot >= 0) {
+                    blob_ring_->Release(slot);
+                }
                 return ret;
             }
         }
@@ -194,11 +283,29 @@ namespace rayshape  //rayshape
         ret = inference_->Forward(); // inference需要保留推理输入输出命名的接口和私有属性
         if (ret != RS_SUCCESS) {
             RS_LOGE("inference forward failed.\n");
+            if (slot >= 0) {
+                blob_ring_->Release(slot);
+            }
             return ret;
         }
+        std::string output_name = "outputs";
+        if (blob_ring_ != nullptr) {
+            // 输出随数据包销毁归还槽位,下一帧写入其他槽位,无需拷贝
+            size_t index = 0;
+            Buffer *output_buffer = nullptr;
+            ret = inference_->OutputIndexGet(output_name.c_str(), &index);
+            if (ret == RS_SUCCESS) {
+                output_buffer = blob_ring_->OutputBufferShare(slot, index);
+            }
+            blob_ring_->Release(slot);
+            if (output_buffer == nullptr) {
+                RS_LOGE("Failed to share output buffer.\n");
+                return ret != RS_SUCCESS ? ret : RS_OUTOFMEMORY;
+            }
+            return outputs_[0]->SetBuff(output_buffer, false);
+        }
         // Get output /gain
         const Blob *output_blob = nullptr;
-        std::string output_name = "outputs";
         ret = inference_->OutputBlobGet(output_name.c_str(), &output_blob);
         if (ret != RS_SUCCESS) {
             RS_LOGE("Failed to get output blob: %d\n", ret);
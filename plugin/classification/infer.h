@@ -8,6 +8,8 @@
 
 #include "dag/node.h"
 #include "inference/inference.h"
+#include "inference/inference_pool.h"
+#include "inference/blob_ring.h"
 /*单个分类模型的推理节点定义*/
 namespace rayshape
 {
@@ -29,13 +31,26 @@ namespace rayshape
         virtual ErrorCode DeInit();
         // 设置推理类型 似乎用构造函数就可以
         virtual ErrorCode SetInferenceType(InferenceType inference_type);
+        // 多个并行副本节点共享同一个已Init的推理池,Init时从池中取一个实例,DeInit时归还
+        virtual ErrorCode SetInferencePool(std::shared_ptr<inference::InferencePool> pool);
+        // 输入输出槽位数,>0时输出buffer直接交给下游,下游消费完才复用,流水线模式下各级可重叠;需在Init前设置.
+        // 固定边的数据包保留到下一帧写入才释放,此时深度至少为2
+        virtual ErrorCode SetBlobRingDepth(int depth);
 
         virtual ErrorCode Run() override; // 重载推理调度
+        // 用合成输入在模型声明的各尺寸上预热推理引擎
+        virtual ErrorCode Warmup() override;
+
+    private:
+        ErrorCode InitBlobRing();
 
     private:
         InferenceType type_ = InferenceType::NONE;
 
         std::shared_ptr<inference::Inference> inference_ = nullptr;
+        std::shared_ptr<inference::InferencePool> inference_pool_ = nullptr;
+        int blob_ring_depth_ = 0;
+        std::shared_ptr<inference::BlobRing> blob_ring_ = nullptr;
 
         std::set<std::string> inference_input_names_;
         std::set<std::string> inference_output_names_;
@@ -0,0 +1,104 @@
+#include "inference/batching_inference.h"
+#include "fake_inference.h"
+#include "gtest/gtest.h"
+
+using namespace rayshape;
+using namespace rayshape::inference;
+
+TEST(BatchingInferenceTest, ParseBatchPolicy) {
+    std::string cfg =
+        R"({"NetworkConfig": {"BatchConfig": {"MaxBatchSize": 4, "MaxQueueDelayUs": 500}}})";
+    utils::RSJsonHandle json_handle = nullptr;
+    ASSERT_EQ(utils::RSJsonCreate(cfg, &json_handle), RS_SUCCESS);
+    BatchPolicy policy;
+    EXPECT_EQ(ParseBatchPolicy(json_handle, policy), RS_SUCCESS);
+    EXPECT_EQ(policy.max_batch_size_, 4);
+    EXPECT_EQ(policy.max_queue_delay_us_, 500);
+    utils::RSJsonDestory(&json_handle);
+
+    ASSERT_EQ(utils::RSJsonCreate(std::string(R"({"NetworkConfig": {"BatchConfig": {
+        "MaxBatchSize": 0}}})"),
+                                  &json_handle),
+              RS_SUCCESS);
+    EXPECT_EQ(ParseBatchPolicy(json_handle, policy), RS_INVALID_PARAM_VALUE);
+    utils::RSJsonDestory(&json_handle);
+
+    // no NetworkConfig: keep defaults
+    ASSERT_EQ(utils::RSJsonCreate(std::string(R"({"ModelConfig": {}})"), &json_handle),
+              RS_SUCCESS);
+    BatchPolicy defaults;
+    EXPECT_EQ(ParseBatchPolicy(json_handle, defaults), RS_SUCCESS);
+    EXPECT_EQ(defaults.max_batch_size_, BatchPolicy().max_batch_size_);
+    utils::RSJsonDestory(&json_handle);
+}
+
+TEST(BatchingInferenceTest, ConcurrentForwardIsBatched) {
+    // batch维动态的假后端, 单个请求的形状为{1, 2}
+    auto fake = std::make_shared<test::FakeInference>(InferenceType::NONE, Dims{2, {1, 2}});
+    BatchingInference batching(fake);
+    test::FakeModel model;
+    CustomRuntime runtime;
+    ASSERT_EQ(batching.Init(&model, &runtime), RS_SUCCESS);
+
+    const int thread_num = 8;
+    std::vector<std::thread> threads;
+    std::vector<int> errors(thread_num, 0);
+    for (int t = 0; t < thread_num; ++t) {
+        threads.emplace_back([&, t]() {
+            Blob *input = nullptr;
+            if (batching.InputBlobGet("in", &input) != RS_SUCCESS) {
+                errors[t]++;
+                return;
+            }
+            float *in = static_cast<float *>(input->buffer->GetDataPtr());
+            in[0] = static_cast<float>(t);
+            in[1] = static_cast<float>(t + 100);
+            if (batching.Forward() != RS_SUCCESS) {
+                errors[t]++;
+                return;
+            }
+            const Blob *output = nullptr;
+            batching.OutputBlobGet("out", &output);
+            const float *out = static_cast<const float *>(output->buffer->GetDataPtr());
+            if (output->dims.value[0] != 1 || out[0] != 2.0f * t || out[1] != 2.0f * (t + 100)) {
+                errors[t]++;
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    for (int t = 0; t < thread_num; ++t) {
+        EXPECT_EQ(errors[t], 0) << "thread " << t;
+    }
+
+    BatchStatistics stats;
+    ASSERT_EQ(batching.StatisticsGet(&stats), RS_SUCCESS);
+    EXPECT_EQ(stats.request_count_, static_cast<uint64_t>(thread_num));
+    EXPECT_LE(stats.max_batch_size_, 8);
+    EXPECT_EQ(stats.batch_count_, fake->forward_batches_.size());
+    batching.DeInit();
+}
+
+TEST(BatchingInferenceTest, ForwardAsyncUsesCallerSlot) {
+    auto fake = std::make_shared<test::FakeInference>(InferenceType::NONE, Dims{2, {1, 2}});
+    BatchingInference batching(fake);
+    test::FakeModel model;
+    CustomRuntime runtime;
+    ASSERT_EQ(batching.Init(&model, &runtime), RS_SUCCESS);
+
+    Blob *input = nullptr;
+    ASSERT_EQ(batching.InputBlobGet("in", &input), RS_SUCCESS);
+    float *in = static_cast<float *>(input->buffer->GetDataPtr());
+    in[0] = 1.0f;
+    in[1] = 3.0f;
+    EXPECT_EQ(batching.ForwardAsync().get(), RS_SUCCESS);
+    EXPECT_EQ(batching.Wait(), RS_SUCCESS);
+
+    const Blob *output = nullptr;
+    ASSERT_EQ(batching.OutputBlobGet("out", &output), RS_SUCCESS);
+    const float *out = static_cast<const float *>(output->buffer->GetDataPtr());
+    EXPECT_EQ(out[0], 2.0f);
+    EXPECT_EQ(out[1], 6.0f);
+    batching.DeInit();
+}
@@ -0,0 +1,111 @@
+#include "inference/blob_ring.h"
+#include "fake_inference.h"
+#include "gtest/gtest.h"
+
+using namespace rayshape;
+using namespace rayshape::inference;
+
+namespace
+{
+    ErrorCode RunSlot(BlobRing &ring, Inference &inference, float value, int *slot) {
+        ErrorCode ret = ring.Acquire(slot, 0);
+        if (ret != RS_SUCCESS) {
+            return ret;
+        }
+        Blob *input = nullptr;
+        ring.InputBlobGet(*slot, 0, &input);
+        float *data = static_cast<float *>(input->buffer->GetDataPtr());
+        for (int i = 0; i < 4; ++i) {
+            data[i] = value;
+        }
+        return inference.Forward();
+    }
+} // namespace
+
+TEST(BlobRingTest, OutputsSurviveUntilReleased) {
+    // 绑定调用方内存的假后端: out = in * 2
+    test::FakeInference inference;
+    BlobRing ring;
+    ASSERT_EQ(ring.Init(&inference, 2), RS_SUCCESS);
+    EXPECT_EQ(ring.Depth(), 2);
+
+    int slot0 = -1;
+    int slot1 = -1;
+    ASSERT_EQ(RunSlot(ring, inference, 1.0f, &slot0), RS_SUCCESS);
+    Buffer *out0 = ring.OutputBufferShare(slot0, 0);
+    ASSERT_NE(out0, nullptr);
+    EXPECT_EQ(ring.Release(slot0), RS_SUCCESS);
+
+    ASSERT_EQ(RunSlot(ring, inference, 3.0f, &slot1), RS_SUCCESS);
+    EXPECT_NE(slot0, slot1);
+    Buffer *out1 = ring.OutputBufferShare(slot1, 0);
+    EXPECT_EQ(ring.Release(slot1), RS_SUCCESS);
+
+    // 两个槽位都被下游持有,第三帧拿不到槽位,第一帧输出未被覆盖
+    int slot2 = -1;
+    EXPECT_EQ(ring.Acquire(&slot2, 0), RS_INFERENCE_TIMEOUT);
+    EXPECT_EQ(ring.IdleSize(), 0);
+    EXPECT_EQ(static_cast<float *>(out0->GetDataPtr())[0], 2.0f);
+    EXPECT_EQ(static_cast<float *>(out1->GetDataPtr())[0], 6.0f);
+
+    // 下游释放后槽位回收
+    delete out0;
+    EXPECT_EQ(ring.IdleSize(), 1);
+    ASSERT_EQ(RunSlot(ring, inference, 5.0f, &slot2), RS_SUCCESS);
+    EXPECT_EQ(slot2, slot0);
+    EXPECT_EQ(static_cast<float *>(out1->GetDataPtr())[0], 6.0f);
+    ring.Release(slot2);
+    delete out1;
+    EXPECT_EQ(ring.IdleSize(), 2);
+}
+
+TEST(BlobRingTest, AcquireWaitsForDownstream) {
+    test::FakeInference inference;
+    BlobRing ring;
+    ASSERT_EQ(ring.Init(&inference, 1), RS_SUCCESS);
+
+    int slot = -1;
+    ASSERT_EQ(RunSlot(ring, inference, 1.0f, &slot), RS_SUCCESS);
+    Buffer *out = ring.OutputBufferShare(slot, 0);
+    ring.Release(slot);
+
+    std::thread consumer([out]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        delete out;
+    });
+    // 阻塞到消费者释放输出
+    EXPECT_EQ(ring.Acquire(&slot, -1), RS_SUCCESS);
+    ring.Release(slot);
+    consumer.join();
+
+    // buffer可以晚于ring释放
+    ASSERT_EQ(ring.Acquire(&slot, 0), RS_SUCCESS);
+    out = ring.OutputBufferShare(slot, 0);
+    ring.Release(slot);
+    ring.DeInit();
+    EXPECT_NE(out->GetDataPtr(), nullptr);
+    delete out;
+}
+
+TEST(BlobRingTest, DoubleReleaseIsRejected) {
+    test::FakeInference inference;
+    BlobRing ring;
+    ASSERT_EQ(ring.Init(&inference, 1), RS_SUCCESS);
+
+    int slot = -1;
+    ASSERT_EQ(ring.Acquire(&slot, 0), RS_SUCCESS);
+    EXPECT_EQ(ring.Release(slot), RS_SUCCESS);
+    EXPECT_EQ(ring.Release(slot), RS_INVALID_PARAM);
+    // 重复Release不影响槽位回收
+    EXPECT_EQ(ring.IdleSize(), 1);
+    ASSERT_EQ(ring.Acquire(&slot, 0), RS_SUCCESS);
+
+    // 下游仍持有输出时,生产者也只能归还一次
+    Buffer *out = ring.OutputBufferShare(slot, 0);
+    ASSERT_NE(out, nullptr);
+    EXPECT_EQ(ring.Release(slot), RS_SUCCESS);
+    EXPECT_EQ(ring.Release(slot), RS_INVALID_PARAM);
+    EXPECT_EQ(ring.IdleSize(), 0);
+    delete out;
+    EXPECT_EQ(ring.IdleSize(), 1);
+}
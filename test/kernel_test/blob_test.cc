@@ -1,4 +1,5 @@
 #include "memory_manager/blob.h"
+#include "utils/blob_utils.h"
 #include "gtest/gtest.h"
 
 using namespace rayshape;
@@ -58,4 +59,32 @@ TEST(BlobTest, BlobFreeTest) {
     }
 
     EXPECT_EQ(BlobFree(blob), RS_INVALID_PARAM);
-}
\ No newline at end of file
+}
+TEST(BlobTest, BindBlobBufferTest) {
+    Dims dims{2, {2, 3}};
+    Blob *blob = BlobAlloc(DeviceType::CPU, DataType::FLOAT, DataFormat::NC, "bind_blob", &dims);
+    ASSERT_NE(blob, nullptr);
+
+    // 按字节计算大小,uint8 buffer同样可以绑定
+    std::vector<float> user_data(6, 1.0f);
+    Buffer *user_buffer =
+        Buffer::Create(user_data.data(), user_data.size() * sizeof(float), MemoryType::HOST);
+    EXPECT_EQ(utils::BindBlobBuffer(blob, user_buffer), RS_SUCCESS);
+    EXPECT_EQ(blob->buffer->GetDataPtr(), user_data.data());
+    EXPECT_EQ(blob->buffer->GetDataSize(), 6u);
+    EXPECT_TRUE(blob->buffer->GetExternalFlag());
+
+    // 太小的buffer不允许绑定,原绑定不变
+    std::vector<float> small_data(5, 0.0f);
+    Buffer *small_buffer =
+        Buffer::Create(small_data.data(), small_data.size() * sizeof(float), MemoryType::HOST);
+    EXPECT_EQ(utils::BindBlobBuffer(blob, small_buffer), RS_INVALID_PARAM_VALUE);
+    EXPECT_EQ(blob->buffer->GetDataPtr(), user_data.data());
+    EXPECT_EQ(utils::BindBlobBuffer(blob, nullptr), RS_INVALID_PARAM);
+
+    // BlobFree不释放调用方内存
+    EXPECT_EQ(BlobFree(blob), RS_SUCCESS);
+    EXPECT_EQ(user_data[5], 1.0f);
+    delete user_buffer;
+    delete small_buffer;
+}
@@ -0,0 +1,133 @@
+/**
+ * @file fake_inference.h
+ * @brief 单元测试共用的假推理后端,不依赖真实推理引擎
+ */
+
+#ifndef FAKE_INFERENCE_H
+#define FAKE_INFERENCE_H
+
+#include "inference/inference.h"
+#include "utils/memory_size_info.h"
+
+namespace rayshape
+{
+    namespace test
+    {
+        /**
+         * @brief 一个float输入"in"和一个同形状的float输出"out", out = in * 2
+         * @details Forward记录每次的batch(dims[0]),Reshape按新尺寸重新分配输入输出;
+         * BindInput/BindOutput后读写调用方的内存.返回值和预热尺寸可由测试配置.
+         */
+        class FakeInference: public inference::Inference {
+        public:
+            explicit FakeInference(InferenceType type = InferenceType::NONE,
+                                   Dims dims = Dims{2, {1, 4}}) :
+                inference::Inference(type) {
+                Alloc(dims);
+            }
+            ~FakeInference() override {
+                Wait();
+                Free();
+            }
+
+            ErrorCode Init(const Model * /*model*/, const CustomRuntime * /*runtime*/) override {
+                ++init_count_;
+                return init_ret_;
+            }
+            void DeInit() override {}
+            ErrorCode Forward() override {
+                Buffer *in = bind_input_ != nullptr ? bind_input_ : input_->buffer;
+                Buffer *out = bind_output_ != nullptr ? bind_output_ : output_->buffer;
+                const float *src = static_cast<const float *>(in->GetDataPtr());
+                float *dst = static_cast<float *>(out->GetDataPtr());
+                size_t count = utils::CalculateDims(input_->dims);
+                for (size_t i = 0; i < count; ++i) {
+                    dst[i] = src[i] * 2;
+                }
+                forward_batches_.push_back(input_->dims.value[0]);
+                ++forward_count_;
+                return forward_ret_;
+            }
+            ErrorCode Reshape(const char ** /*name_arr*/, const Dims *dims_arr,
+                              size_t /*dims_size*/) override {
+                Free();
+                Alloc(dims_arr[0]);
+                ++reshape_count_;
+                return RS_SUCCESS;
+            }
+            ErrorCode InputBlobsGet(const Blob ***blob_arr, size_t *blob_size) override {
+                *blob_arr = (const Blob **)&input_;
+                *blob_size = 1;
+                return RS_SUCCESS;
+            }
+            ErrorCode OutputBlobsGet(const Blob ***blob_arr, size_t *blob_size) override {
+                *blob_arr = (const Blob **)&output_;
+                *blob_size = 1;
+                return RS_SUCCESS;
+            }
+            ErrorCode InputBlobGet(const char * /*input_name*/, Blob **blob) override {
+                *blob = input_;
+                return RS_SUCCESS;
+            }
+            ErrorCode OutputBlobGet(const char * /*output_name*/, const Blob **blob) override {
+                *blob = output_;
+                return RS_SUCCESS;
+            }
+            ErrorCode BindInput(size_t /*index*/, Buffer *buffer) override {
+                bind_input_ = buffer;
+                return RS_SUCCESS;
+            }
+            ErrorCode BindOutput(size_t /*index*/, Buffer *buffer) override {
+                bind_output_ = buffer;
+                return RS_SUCCESS;
+            }
+            ErrorCode WarmupShapesGet(std::vector<std::map<std::string, Dims>> &shapes) override {
+                if (warmup_shapes_.empty()) {
+                    return inference::Inference::WarmupShapesGet(shapes);
+                }
+                shapes = warmup_shapes_;
+                return RS_SUCCESS;
+            }
+
+            // 测试配置
+            ErrorCode init_ret_ = RS_SUCCESS;
+            ErrorCode forward_ret_ = RS_SUCCESS;
+            std::vector<std::map<std::string, Dims>> warmup_shapes_; // 为空时用基类的默认实现
+
+            // 调用记录
+            int init_count_ = 0;
+            int forward_count_ = 0;
+            int reshape_count_ = 0;
+            std::vector<int> forward_batches_;
+
+            Blob *input_ = nullptr;
+            Blob *output_ = nullptr;
+
+        private:
+            void Alloc(Dims dims) {
+                input_ = BlobAlloc(DeviceType::CPU, DataType::FLOAT, DataFormat::NC, "in", &dims);
+                output_ = BlobAlloc(DeviceType::CPU, DataType::FLOAT, DataFormat::NC, "out", &dims);
+            }
+            void Free() {
+                if (input_ != nullptr) {
+                    BlobFree(input_);
+                    BlobFree(output_);
+                }
+                input_ = nullptr;
+                output_ = nullptr;
+            }
+
+            Buffer *bind_input_ = nullptr;
+            Buffer *bind_output_ = nullptr;
+        };
+
+        class FakeModel: public Model {
+        public:
+            ModelType GetModelType() const override {
+                return ModelType::NONE;
+            }
+        };
+    } // namespace test
+} // namespace rayshape
+
+#endif // FAKE_INFERENCE_H
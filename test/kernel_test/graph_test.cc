@@ -0,0 +1,533 @@
+#include "dag/graph.h"
+#include "gtest/gtest.h"
+
+using namespace rayshape;
+using namespace rayshape::dag;
+
+namespace
+{
+    std::mutex g_order_mutex;
+
+    // 读取所有输入边的float求和,加上自身的偏置后写到输出边,并记录执行顺序
+    class AddNode: public Node {
+    public:
+        AddNode(const std::string &name, std::vector<Edge *> inputs, std::vector<Edge *> outputs,
+                float bias, std::vector<std::string> *order) :
+            Node(name, inputs, outputs), bias_(bias), order_(order) {}
+
+        ErrorCode Run() override {
+            thread_id_ = std::this_thread::get_id();
+            int running = ++running_;
+            int max_running = max_running_.load();
+            while (running > max_running
+                   && !max_running_.compare_exchange_weak(max_running, running)) {
+            }
+            if (sleep_ms_ > 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(sleep_ms_));
+            }
+            --running_;
+
+            float sum = bias_;
+            for (auto input : inputs_) {
+                Buffer *buffer = input->GetBuff(this);
+                if (buffer == nullptr) {
+                    return RS_NODE_STATU_ERROR;
+                }
+                sum += *static_cast<float *>(buffer->GetDataPtr());
+            }
+            for (auto output : outputs_) {
+                Buffer *buffer = new Buffer(sizeof(float), MemoryType::HOST);
+                *static_cast<float *>(buffer->GetDataPtr()) = sum;
+                output->SetBuff(buffer, false);
+            }
+            if (order_ != nullptr) {
+                std::lock_guard<std::mutex> lock(g_order_mutex);
+                order_->push_back(node_name_);
+            }
+            return ret_;
+        }
+
+        ErrorCode ret_ = RS_SUCCESS;
+        int sleep_ms_ = 0;
+        std::atomic<int> running_{0};
+        std::atomic<int> max_running_{0}; // 同一节点同时运行的最大个数
+        std::thread::id thread_id_;        // 最近一次运行所在的线程
+
+    private:
+        float bias_;
+        std::vector<std::string> *order_;
+    };
+
+    float OutputValue(Edge *edge) {
+        Buffer *buffer = edge->GetGraphOutputBuffer();
+        return buffer != nullptr ? *static_cast<float *>(buffer->GetDataPtr()) : -1.0f;
+    }
+
+    // 在Run里运行一个嵌套图并用Graph::Wait等待: out = inner(in)
+    class NestedNode: public Node {
+    public:
+        NestedNode(const std::string &name, std::vector<Edge *> inputs,
+                   std::vector<Edge *> outputs, Graph *inner, Edge *inner_input,
+                   Edge *inner_output) :
+            Node(name, inputs, outputs), inner_(inner), inner_input_(inner_input),
+            inner_output_(inner_output) {}
+
+        ErrorCode Run() override {
+            Buffer *buffer = inputs_[0]->GetBuff(this);
+            if (buffer == nullptr) {
+                return RS_NODE_STATU_ERROR;
+            }
+            float result = -1.0f;
+            std::future<ErrorCode> future = inner_->RunAsync(
+                [this, buffer]() { return inner_input_->SetBuff(buffer, true); },
+                [this, &result](ErrorCode /*ret*/) { result = OutputValue(inner_output_); });
+            ErrorCode ret = inner_->Wait(future);
+            if (ret != RS_SUCCESS) {
+                return ret;
+            }
+            Buffer *output = new Buffer(sizeof(float), MemoryType::HOST);
+            *static_cast<float *>(output->GetDataPtr()) = result;
+            return outputs_[0]->SetBuff(output, false);
+        }
+
+    private:
+        Graph *inner_;
+        Edge *inner_input_;
+        Edge *inner_output_;
+    };
+} // namespace
+
+TEST(GraphTest, SequentialDiamond) {
+    // in -> a -> (b, c) -> d -> out
+    Edge input("input");
+    Edge output("output");
+    Graph graph("diamond", {&input}, {&output});
+    Edge *ab = graph.CreateEdge("ab");
+    Edge *ac = graph.CreateEdge("ac");
+    Edge *bd = graph.CreateEdge("bd");
+    Edge *cd = graph.CreateEdge("cd");
+    std::vector<std::string> order;
+    // 逆序创建节点,执行顺序只由依赖决定
+    ASSERT_NE(graph.CreateNode<AddNode>("d", std::vector<Edge *>{bd, cd},
+                                        std::vector<Edge *>{&output}, 0.0f, &order),
+              nullptr);
+    ASSERT_NE(graph.CreateNode<AddNode>("c", ac, cd, 2.0f, &order), nullptr);
+    ASSERT_NE(graph.CreateNode<AddNode>("b", ab, bd, 1.0f, &order), nullptr);
+    ASSERT_NE(graph.CreateNode<AddNode>("a", std::vector<Edge *>{&input},
+                                        std::vector<Edge *>{ab, ac}, 10.0f, &order),
+              nullptr);
+    ASSERT_EQ(graph.Init(), RS_SUCCESS);
+
+    Buffer in_buffer(sizeof(float), MemoryType::HOST);
+    for (int i = 0; i < 3; ++i) {
+        order.clear();
+        *static_cast<float *>(in_buffer.GetDataPtr()) = static_cast<float>(i);
+        input.SetBuff(&in_buffer, true);
+        ASSERT_EQ(graph.Run(), RS_SUCCESS);
+        ASSERT_EQ(order.size(), 4u);
+        EXPECT_EQ(order.front(), "a");
+        EXPECT_EQ(order.back(), "d");
+        // d = (x + 10 + 1) + (x + 10 + 2)
+        EXPECT_EQ(OutputValue(&output), 2.0f * i + 23.0f);
+    }
+    EXPECT_EQ(graph.Deinit(), RS_SUCCESS);
+}
+
+TEST(GraphTest, SequentialStopsOnError) {
+    Edge input("input");
+    Edge output("output");
+    Graph graph("chain", {&input}, {&output});
+    Edge *mid = graph.CreateEdge("mid");
+    std::vector<std::string> order;
+    AddNode *first =
+        dynamic_cast<AddNode *>(graph.CreateNode<AddNode>("first", &input, mid, 1.0f, &order));
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(graph.CreateNode<AddNode>("second", mid, &output, 1.0f, &order), nullptr);
+    graph.SetParallelType(PARALLEL_TYPE_SEQUENTIAL);
+    ASSERT_EQ(graph.Init(), RS_SUCCESS);
+
+    Buffer in_buffer(sizeof(float), MemoryType::HOST);
+    *static_cast<float *>(in_buffer.GetDataPtr()) = 0.0f;
+    input.SetBuff(&in_buffer, true);
+    first->ret_ = RS_INVALID_PARAM;
+    EXPECT_EQ(graph.Run(), RS_INVALID_PARAM);
+    EXPECT_EQ(order, std::vector<std::string>{"first"});
+
+    first->ret_ = RS_SUCCESS;
+    order.clear();
+    EXPECT_EQ(graph.Run(), RS_SUCCESS);
+    EXPECT_EQ(order.size(), 2u);
+    EXPECT_EQ(OutputValue(&output), 2.0f);
+}
+
+TEST(GraphTest, TaskWideFanInOut) {
+    // in -> src -> w0..w15 -> sink -> out, 多轮运行检查每个节点每轮只执行一次
+    const int width = 16;
+    Edge input("input");
+    Edge output("output");
+    Graph graph("wide", {&input}, {&output});
+    std::vector<Edge *> src_outputs;
+    std::vector<Edge *> sink_inputs;
+    std::vector<std::string> order;
+    for (int i = 0; i < width; ++i) {
+        src_outputs.push_back(graph.CreateEdge("s" + std::to_string(i)));
+        sink_inputs.push_back(graph.CreateEdge("w" + std::to_string(i)));
+        ASSERT_NE(graph.CreateNode<AddNode>("w" + std::to_string(i), src_outputs.back(),
+                                            sink_inputs.back(), 1.0f, &order),
+                  nullptr);
+    }
+    ASSERT_NE(graph.CreateNode<AddNode>("src", std::vector<Edge *>{&input}, src_outputs, 0.0f,
+                                        &order),
+              nullptr);
+    ASSERT_NE(graph.CreateNode<AddNode>("sink", sink_inputs, std::vector<Edge *>{&output}, 0.0f,
+                                        &order),
+              nullptr);
+    graph.SetParallelType(PARALLEL_TYPE_TASK);
+    ASSERT_EQ(graph.Init(), RS_SUCCESS);
+
+    Buffer in_buffer(sizeof(float), MemoryType::HOST);
+    for (int i = 0; i < 50; ++i) {
+        order.clear();
+        *static_cast<float *>(in_buffer.GetDataPtr()) = static_cast<float>(i);
+        input.SetBuff(&in_buffer, true);
+        ASSERT_EQ(graph.Run(), RS_SUCCESS);
+        ASSERT_EQ(order.size(), static_cast<size_t>(width + 2));
+        EXPECT_EQ(order.front(), "src");
+        EXPECT_EQ(order.back(), "sink");
+        EXPECT_EQ(OutputValue(&output), width * (i + 1.0f));
+    }
+}
+
+TEST(GraphTest, TaskStopsOnError) {
+    Edge input("input");
+    Edge output("output");
+    Graph graph("chain", {&input}, {&output});
+    Edge *mid = graph.CreateEdge("mid");
+    std::vector<std::string> order;
+    AddNode *first =
+        dynamic_cast<AddNode *>(graph.CreateNode<AddNode>("first", &input, mid, 1.0f, &order));
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(graph.CreateNode<AddNode>("second", mid, &output, 1.0f, &order), nullptr);
+    graph.SetParallelType(PARALLEL_TYPE_TASK);
+    ASSERT_EQ(graph.Init(), RS_SUCCESS);
+
+    Buffer in_buffer(sizeof(float), MemoryType::HOST);
+    *static_cast<float *>(in_buffer.GetDataPtr()) = 0.0f;
+    input.SetBuff(&in_buffer, true);
+    first->ret_ = RS_INVALID_PARAM;
+    EXPECT_EQ(graph.Run(), RS_INVALID_PARAM);
+    EXPECT_EQ(order, std::vector<std::string>{"first"});
+
+    // 失败不影响下一轮
+    first->ret_ = RS_SUCCESS;
+    order.clear();
+    EXPECT_EQ(graph.Run(), RS_SUCCESS);
+    EXPECT_EQ(order.size(), 2u);
+    EXPECT_EQ(OutputValue(&output), 2.0f);
+}
+
+TEST(GraphTest, TaskChainStaysOnWorker) {
+    // 链上每个后继都是唯一就绪的节点,应在前驱的线程上接着执行
+    const int length = 6;
+    Edge input("input");
+    Edge output("output");
+    Graph graph("chain", {&input}, {&output});
+    std::vector<AddNode *> nodes;
+    Edge *prev = &input;
+    for (int i = 0; i < length; ++i) {
+        Edge *next = i + 1 < length ? graph.CreateEdge("e" + std::to_string(i)) : &output;
+        nodes.push_back(dynamic_cast<AddNode *>(
+            graph.CreateNode<AddNode>("n" + std::to_string(i), prev, next, 1.0f, nullptr)));
+        ASSERT_NE(nodes.back(), nullptr);
+        prev = next;
+    }
+    graph.SetParallelType(PARALLEL_TYPE_TASK);
+    ASSERT_EQ(graph.Init(), RS_SUCCESS);
+
+    Buffer in_buffer(sizeof(float), MemoryType::HOST);
+    *static_cast<float *>(in_buffer.GetDataPtr()) = 0.0f;
+    for (int i = 0; i < 20; ++i) {
+        input.SetBuff(&in_buffer, true);
+        ASSERT_EQ(graph.Run(), RS_SUCCESS);
+        EXPECT_EQ(OutputValue(&output), static_cast<float>(length));
+        for (int k = 1; k < length; ++k) {
+            EXPECT_EQ(nodes[k]->thread_id_, nodes[0]->thread_id_);
+        }
+    }
+}
+
+TEST(GraphTest, TaskCriticalPathFirst) {
+    // src -> a0 -> a1 -> sink, src -> b0 -> sink; src在本线程上接着执行剩余路径最长的后继
+    Edge input("input");
+    Edge output("output");
+    Graph graph("critical", {&input}, {&output});
+    Edge *src_a = graph.CreateEdge("src_a");
+    Edge *src_b = graph.CreateEdge("src_b");
+    Edge *a0_a1 = graph.CreateEdge("a0_a1");
+    Edge *a1_sink = graph.CreateEdge("a1_sink");
+    Edge *b0_sink = graph.CreateEdge("b0_sink");
+    AddNode *src = dynamic_cast<AddNode *>(graph.CreateNode<AddNode>(
+        "src", std::vector<Edge *>{&input}, std::vector<Edge *>{src_a, src_b}, 0.0f, nullptr));
+    AddNode *a0 =
+        dynamic_cast<AddNode *>(graph.CreateNode<AddNode>("a0", src_a, a0_a1, 1.0f, nullptr));
+    AddNode *a1 =
+        dynamic_cast<AddNode *>(graph.CreateNode<AddNode>("a1", a0_a1, a1_sink, 1.0f, nullptr));
+    AddNode *b0 =
+        dynamic_cast<AddNode *>(graph.CreateNode<AddNode>("b0", src_b, b0_sink, 1.0f, nullptr));
+    ASSERT_NE(graph.CreateNode<AddNode>("sink", std::vector<Edge *>{a1_sink, b0_sink},
+                                        std::vector<Edge *>{&output}, 0.0f, nullptr),
+              nullptr);
+    ASSERT_TRUE(src != nullptr && a0 != nullptr && a1 != nullptr && b0 != nullptr);
+    a0->sleep_ms_ = 1;
+    a1->sleep_ms_ = 1;
+    b0->sleep_ms_ = 10;
+    graph.SetParallelType(PARALLEL_TYPE_TASK);
+    ASSERT_EQ(graph.Init(), RS_SUCCESS);
+
+    Buffer in_buffer(sizeof(float), MemoryType::HOST);
+    *static_cast<float *>(in_buffer.GetDataPtr()) = 0.0f;
+    input.SetBuff(&in_buffer, true);
+    // 未测量耗时前按节点个数,a分支更长
+    ASSERT_EQ(graph.Run(), RS_SUCCESS);
+    EXPECT_EQ(a0->thread_id_, src->thread_id_);
+    EXPECT_EQ(OutputValue(&output), 3.0f);
+
+    // 耗时的滑动平均收敛后b分支更长
+    for (int i = 0; i < 20; ++i) {
+        input.SetBuff(&in_buffer, true);
+        ASSERT_EQ(graph.Run(), RS_SUCCESS);
+    }
+    EXPECT_EQ(b0->thread_id_, src->thread_id_);
+    EXPECT_EQ(OutputValue(&output), 3.0f);
+}
+
+TEST(GraphTest, TaskNestedWait) {
+    // 外层图的节点等待内层图: in -> first -> nested(inner: a -> b) -> out
+    Edge inner_input("inner_input");
+    Edge inner_output("inner_output");
+    Graph inner("inner", {&inner_input}, {&inner_output});
+    Edge *inner_mid = inner.CreateEdge("inner_mid");
+    ASSERT_NE(inner.CreateNode<AddNode>("a", &inner_input, inner_mid, 1.0f, nullptr), nullptr);
+    ASSERT_NE(inner.CreateNode<AddNode>("b", inner_mid, &inner_output, 10.0f, nullptr), nullptr);
+    inner.SetParallelType(PARALLEL_TYPE_TASK);
+    ASSERT_EQ(inner.Init(), RS_SUCCESS);
+
+    Edge input("input");
+    Edge output("output");
+    Graph graph("outer", {&input}, {&output});
+    Edge *mid = graph.CreateEdge("mid");
+    ASSERT_NE(graph.CreateNode<AddNode>("first", &input, mid, 100.0f, nullptr), nullptr);
+    ASSERT_NE(graph.CreateNode<NestedNode>("nested", mid, &output, &inner, &inner_input,
+                                           &inner_output),
+              nullptr);
+    graph.SetParallelType(PARALLEL_TYPE_TASK);
+    ASSERT_EQ(graph.Init(), RS_SUCCESS);
+
+    Buffer in_buffer(sizeof(float), MemoryType::HOST);
+    for (int i = 0; i < 20; ++i) {
+        *static_cast<float *>(in_buffer.GetDataPtr()) = static_cast<float>(i);
+        input.SetBuff(&in_buffer, true);
+        ASSERT_EQ(graph.Run(), RS_SUCCESS);
+        EXPECT_EQ(OutputValue(&output), i + 111.0f);
+    }
+    std::future<ErrorCode> future = graph.RunAsync([&input, &in_buffer]() {
+        return input.SetBuff(&in_buffer, true);
+    });
+    EXPECT_EQ(graph.Wait(future), RS_SUCCESS);
+    EXPECT_EQ(OutputValue(&output), 130.0f);
+}
+
+TEST(GraphTest, TaskRunAsyncInFlight) {
+    Edge input("input");
+    Edge output("output");
+    Graph graph("async", {&input}, {&output});
+    Edge *mid = graph.CreateEdge("mid");
+    AddNode *first =
+        dynamic_cast<AddNode *>(graph.CreateNode<AddNode>("first", &input, mid, 1.0f, nullptr));
+    AddNode *second =
+        dynamic_cast<AddNode *>(graph.CreateNode<AddNode>("second", mid, &output, 10.0f, nullptr));
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(second, nullptr);
+    first->sleep_ms_ = 20;
+    second->sleep_ms_ = 20;
+    graph.SetParallelType(PARALLEL_TYPE_TASK);
+    ASSERT_EQ(graph.SetMaxInFlight(0), RS_INVALID_PARAM_VALUE);
+    ASSERT_EQ(graph.SetMaxInFlight(3), RS_SUCCESS);
+    ASSERT_EQ(graph.Init(), RS_SUCCESS);
+    EXPECT_EQ(graph.SetMaxInFlight(2), RS_DAG_STATU_ERROR);
+
+    const int frames = 12;
+    std::vector<Buffer *> inputs;
+    std::vector<float> results(frames, -1.0f);
+    std::vector<std::future<ErrorCode>> futures;
+    for (int i = 0; i < frames; ++i) {
+        Buffer *buffer = new Buffer(sizeof(float), MemoryType::HOST);
+        *static_cast<float *>(buffer->GetDataPtr()) = static_cast<float>(i);
+        inputs.push_back(buffer);
+        futures.push_back(graph.RunAsync(
+            [&input, buffer]() { return input.SetBuff(buffer, true); },
+            [&output, &results, i](ErrorCode ret) {
+                if (ret == RS_SUCCESS) {
+                    results[i] = OutputValue(&output);
+                }
+            }));
+    }
+    for (int i = 0; i < frames; ++i) {
+        EXPECT_EQ(futures[i].get(), RS_SUCCESS);
+        // 每轮读到的都是自己那一帧的结果
+        EXPECT_EQ(results[i], i + 11.0f);
+    }
+    // 多轮重叠运行,但不超过在途上限
+    EXPECT_GT(first->max_running_.load(), 1);
+    EXPECT_LE(first->max_running_.load(), 3);
+    EXPECT_TRUE(graph.Synchronize());
+
+    // 输入回调失败时本轮不运行
+    EXPECT_EQ(graph.RunAsync([]() { return RS_INVALID_PARAM; }).get(), RS_INVALID_PARAM);
+    for (auto buffer : inputs) {
+        delete buffer;
+    }
+}
+
+TEST(GraphTest, PipelineLongChain) {
+    // 40个节点的链,共享线程池的线程数远少于节点数
+    const int depth = 40;
+    const int frames = 30;
+    Edge input("input");
+    Edge output("output");
+    Graph graph("pipeline", {&input}, {&output});
+    std::vector<AddNode *> nodes;
+    Edge *prev = &input;
+    for (int i = 0; i < depth; ++i) {
+        Edge *next = i + 1 == depth ? &output : graph.CreateEdge("e" + std::to_string(i));
+        nodes.push_back(dynamic_cast<AddNode *>(
+            graph.CreateNode<AddNode>("n" + std::to_string(i), prev, next, 1.0f, nullptr)));
+        ASSERT_NE(nodes.back(), nullptr);
+        prev = next;
+    }
+    nodes[depth / 2]->sleep_ms_ = 2;
+    graph.SetParallelType(PARALLEL_TYPE_PIPELINE);
+    ASSERT_EQ(graph.Init(), RS_SUCCESS);
+
+    for (int i = 0; i < frames; ++i) {
+        Buffer *buffer = new Buffer(sizeof(float), MemoryType::HOST);
+        *static_cast<float *>(buffer->GetDataPtr()) = static_cast<float>(i);
+        ASSERT_EQ(input.SetBuff(buffer, false), RS_SUCCESS);
+        ASSERT_EQ(graph.Run(), RS_SUCCESS);
+    }
+    ASSERT_TRUE(graph.Synchronize());
+    // 每个节点按顺序处理,输出与输入一一对应
+    for (int i = 0; i < frames; ++i) {
+        EXPECT_EQ(OutputValue(&output), i + static_cast<float>(depth));
+    }
+    for (auto node : nodes) {
+        EXPECT_EQ(node->max_running_.load(), 1);
+        EXPECT_EQ(node->GetRunCompletedSize(), static_cast<size_t>(frames));
+    }
+    EXPECT_EQ(graph.Deinit(), RS_SUCCESS);
+}
+
+TEST(GraphTest, PipelineKeepLatest) {
+    // 下游慢于输入时只处理最新的帧,同步不等被丢掉的帧
+    const int frames = 50;
+    Edge input("input");
+    Edge output("output");
+    Graph graph("pipeline", {&input}, {&output});
+    Edge *mid = graph.CreateEdge("mid");
+    ASSERT_NE(graph.CreateNode<AddNode>("first", &input, mid, 1.0f, nullptr), nullptr);
+    AddNode *second =
+        dynamic_cast<AddNode *>(graph.CreateNode<AddNode>("second", mid, &output, 1.0f, nullptr));
+    ASSERT_NE(second, nullptr);
+    second->sleep_ms_ = 2;
+    graph.SetParallelType(PARALLEL_TYPE_PIPELINE);
+    ASSERT_EQ(graph.SetQueueMaxSize(0), RS_INVALID_PARAM_VALUE);
+    ASSERT_EQ(graph.SetQueueMaxSize(4), RS_SUCCESS);
+    ASSERT_EQ(graph.SetOverflowPolicy(QUEUE_OVERFLOW_KEEP_LATEST), RS_SUCCESS);
+    // 边单独设置的优先,输出边保留全部结果
+    ASSERT_EQ(output.SetOverflowPolicy(QUEUE_OVERFLOW_BLOCK), RS_SUCCESS);
+    ASSERT_EQ(graph.Init(), RS_SUCCESS);
+    EXPECT_EQ(graph.SetOverflowPolicy(QUEUE_OVERFLOW_BLOCK), RS_DAG_STATU_ERROR);
+
+    for (int i = 0; i < frames; ++i) {
+        Buffer *buffer = new Buffer(sizeof(float), MemoryType::HOST);
+        *static_cast<float *>(buffer->GetDataPtr()) = static_cast<float>(i);
+        ASSERT_EQ(input.SetBuff(buffer, false), RS_SUCCESS);
+        ASSERT_EQ(graph.Run(), RS_SUCCESS);
+    }
+    ASSERT_TRUE(graph.Synchronize());
+
+    // 输出按帧序递增,最后一帧不会被丢
+    std::vector<float> values;
+    for (float value = OutputValue(&output); value >= 0.0f; value = OutputValue(&output)) {
+        values.push_back(value);
+    }
+    ASSERT_FALSE(values.empty());
+    EXPECT_EQ(values.back(), frames - 1 + 2.0f);
+    for (size_t i = 1; i < values.size(); ++i) {
+        EXPECT_GT(values[i], values[i - 1]);
+    }
+    EXPECT_EQ(values.size(), second->GetRunCompletedSize());
+    EXPECT_EQ(static_cast<int64_t>(values.size()) + input.GetDroppedSize() + mid->GetDroppedSize(),
+              frames);
+    EXPECT_EQ(graph.Deinit(), RS_SUCCESS);
+}
+
+TEST(GraphTest, PipelineReplicas) {
+    // 慢节点的多个副本同时处理连续的帧,输出仍按输入顺序
+    const int frames = 40;
+    const int replicas = 4;
+    Edge input("input");
+    Edge output("output");
+    Graph graph("pipeline", {&input}, {&output});
+    Edge *mid = graph.CreateEdge("mid");
+    Edge *mid2 = graph.CreateEdge("mid2");
+    ASSERT_NE(graph.CreateNode<AddNode>("first", &input, mid, 1.0f, nullptr), nullptr);
+    AddNode *slow =
+        dynamic_cast<AddNode *>(graph.CreateNode<AddNode>("slow", mid, mid2, 1.0f, nullptr));
+    ASSERT_NE(slow, nullptr);
+    ASSERT_NE(graph.CreateNode<AddNode>("last", mid2, &output, 1.0f, nullptr), nullptr);
+    slow->sleep_ms_ = 2;
+    ASSERT_EQ(slow->SetReplicaSize(replicas), RS_SUCCESS);
+    graph.SetParallelType(PARALLEL_TYPE_PIPELINE);
+    ASSERT_EQ(graph.Init(), RS_SUCCESS);
+    EXPECT_EQ(slow->SetReplicaSize(2), RS_NODE_STATU_ERROR);
+
+    for (int i = 0; i < frames; ++i) {
+        Buffer *buffer = new Buffer(sizeof(float), MemoryType::HOST);
+        *static_cast<float *>(buffer->GetDataPtr()) = static_cast<float>(i);
+        ASSERT_EQ(input.SetBuff(buffer, false), RS_SUCCESS);
+        ASSERT_EQ(graph.Run(), RS_SUCCESS);
+    }
+    ASSERT_TRUE(graph.Synchronize());
+    for (int i = 0; i < frames; ++i) {
+        EXPECT_EQ(OutputValue(&output), i + 3.0f);
+    }
+    EXPECT_EQ(slow->GetRunCompletedSize(), static_cast<size_t>(frames));
+    EXPECT_LE(slow->max_running_.load(), replicas);
+    EXPECT_EQ(graph.Deinit(), RS_SUCCESS);
+}
+
+TEST(GraphTest, PipelineStopsOnError) {
+    Edge input("input");
+    Edge output("output");
+    Graph graph("pipeline", {&input}, {&output});
+    Edge *mid = graph.CreateEdge("mid");
+    AddNode *first =
+        dynamic_cast<AddNode *>(graph.CreateNode<AddNode>("first", &input, mid, 1.0f, nullptr));
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(graph.CreateNode<AddNode>("second", mid, &output, 1.0f, nullptr), nullptr);
+    first->ret_ = RS_INVALID_PARAM;
+    graph.SetParallelType(PARALLEL_TYPE_PIPELINE);
+    ASSERT_EQ(graph.Init(), RS_SUCCESS);
+
+    for (int i = 0; i < 3; ++i) {
+        Buffer *buffer = new Buffer(sizeof(float), MemoryType::HOST);
+        *static_cast<float *>(buffer->GetDataPtr()) = static_cast<float>(i);
+        input.SetBuff(buffer, false);
+        graph.Run();
+    }
+    // 失败后停止调度,同步不会一直等下游收不到的帧
+    EXPECT_FALSE(graph.Synchronize());
+    EXPECT_EQ(first->GetRunCompletedSize(), 1u);
+    EXPECT_EQ(graph.Deinit(), RS_SUCCESS);
+}
@@ -0,0 +1,81 @@
+#include "inference/inference.h"
+#include "fake_inference.h"
+#include "gtest/gtest.h"
+
+using namespace rayshape;
+using namespace rayshape::inference;
+
+namespace
+{
+    // 没有原生异步接口的假后端, Forward阻塞到release_为true, 用于验证默认线程池实现
+    class FakeAsyncInference: public test::FakeInference {
+    public:
+        ~FakeAsyncInference() override {
+            // 先等后台Forward结束, 再析构mutex_/cond_
+            Wait();
+        }
+
+        ErrorCode Forward() override {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cond_.wait(lock, [this]() { return release_; });
+            }
+            return test::FakeInference::Forward();
+        }
+
+        void Release() {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                release_ = true;
+            }
+            cond_.notify_all();
+        }
+
+        std::mutex mutex_;
+        std::condition_variable cond_;
+        bool release_ = false;
+    };
+} // namespace
+
+TEST(InferenceAsyncTest, CallbackAndWait) {
+    FakeAsyncInference inference;
+    inference.Release();
+
+    std::atomic<int> callback_count(0);
+    ErrorCode callback_ret = RS_UNKNOWN;
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_EQ(inference.ForwardAsync([&](ErrorCode ret) {
+            callback_ret = ret;
+            ++callback_count;
+        }),
+                  RS_SUCCESS);
+        // Wait返回时回调已执行完
+        EXPECT_EQ(inference.Wait(), RS_SUCCESS);
+        EXPECT_EQ(callback_count.load(), i + 1);
+        EXPECT_EQ(callback_ret, RS_SUCCESS);
+    }
+    EXPECT_EQ(inference.forward_count_, 10);
+}
+
+TEST(InferenceAsyncTest, Future) {
+    FakeAsyncInference inference;
+    inference.forward_ret_ = RS_MODEL_ERROR;
+    std::future<ErrorCode> future = inference.ForwardAsync();
+    inference.Release();
+    EXPECT_EQ(future.get(), RS_MODEL_ERROR);
+    EXPECT_EQ(inference.Wait(), RS_MODEL_ERROR);
+}
+
+TEST(InferenceAsyncTest, BusyWhilePending) {
+    FakeAsyncInference inference;
+    ASSERT_EQ(inference.ForwardAsync(nullptr), RS_SUCCESS);
+    EXPECT_EQ(inference.ForwardAsync(nullptr), RS_INFERENCE_BUSY);
+    EXPECT_EQ(inference.ForwardAsync().get(), RS_INFERENCE_BUSY);
+
+    inference.Release();
+    EXPECT_EQ(inference.Wait(), RS_SUCCESS);
+    EXPECT_EQ(inference.forward_count_, 1);
+    // 完成后可再次提交
+    EXPECT_EQ(inference.ForwardAsync().get(), RS_SUCCESS);
+    EXPECT_EQ(inference.forward_count_, 2);
+}
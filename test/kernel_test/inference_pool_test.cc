@@ -0,0 +1,92 @@
+#include "inference/inference_pool.h"
+#include "fake_inference.h"
+#include "gtest/gtest.h"
+
+using namespace rayshape;
+using namespace rayshape::inference;
+
+namespace
+{
+    // 统计所有实例的Init次数
+    class CountingInference: public test::FakeInference {
+    public:
+        CountingInference(InferenceType type) : test::FakeInference(type) {}
+
+        ErrorCode Init(const Model *model, const CustomRuntime *runtime) override {
+            ++total_init_count_;
+            return test::FakeInference::Init(model, runtime);
+        }
+
+        static int total_init_count_;
+    };
+    int CountingInference::total_init_count_ = 0;
+
+    class FakeCloneInference: public CountingInference {
+    public:
+        FakeCloneInference(InferenceType type) : CountingInference(type) {}
+
+        std::shared_ptr<Inference> Clone() override {
+            ++clone_count_;
+            return std::make_shared<FakeCloneInference>(type_);
+        }
+
+        static int clone_count_;
+    };
+    int FakeCloneInference::clone_count_ = 0;
+
+    // 仓库中没有CoreML/NCNN后端,借用这两个类型注册假后端
+    TypeInferenceRegister<TypeInferenceCreator<FakeCloneInference>>
+        g_fake_clone_register(InferenceType::COREML);
+    TypeInferenceRegister<TypeInferenceCreator<CountingInference>>
+        g_fake_register(InferenceType::NCNN);
+} // namespace
+
+TEST(InferencePoolTest, InitSharesCompiledModel) {
+    test::FakeModel model;
+    CustomRuntime runtime;
+    CountingInference::total_init_count_ = 0;
+    FakeCloneInference::clone_count_ = 0;
+
+    InferencePool pool(InferenceType::COREML);
+    ASSERT_EQ(pool.Init(&model, &runtime, 4), RS_SUCCESS);
+    EXPECT_EQ(pool.Size(), 4u);
+    EXPECT_EQ(pool.IdleSize(), 4u);
+    EXPECT_EQ(CountingInference::total_init_count_, 1);
+    EXPECT_EQ(FakeCloneInference::clone_count_, 3);
+
+    // 不支持Clone的后端每个实例单独Init
+    CountingInference::total_init_count_ = 0;
+    InferencePool fallback_pool(InferenceType::NCNN);
+    ASSERT_EQ(fallback_pool.Init(&model, &runtime, 3), RS_SUCCESS);
+    EXPECT_EQ(CountingInference::total_init_count_, 3);
+
+    EXPECT_EQ(pool.Init(&model, &runtime, 0), RS_INVALID_PARAM);
+}
+
+TEST(InferencePoolTest, AcquireRelease) {
+    test::FakeModel model;
+    CustomRuntime runtime;
+    InferencePool pool(InferenceType::COREML);
+    ASSERT_EQ(pool.Init(&model, &runtime, 2), RS_SUCCESS);
+
+    std::shared_ptr<Inference> a, b, c;
+    ASSERT_EQ(pool.Acquire(a), RS_SUCCESS);
+    ASSERT_EQ(pool.Acquire(b), RS_SUCCESS);
+    EXPECT_NE(a, b);
+    EXPECT_EQ(pool.IdleSize(), 0u);
+    EXPECT_EQ(pool.Acquire(c, 10), RS_INFERENCE_TIMEOUT);
+
+    // 其他线程归还后阻塞的Acquire被唤醒
+    std::thread releaser([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        pool.Release(a);
+    });
+    ASSERT_EQ(pool.Acquire(c), RS_SUCCESS);
+    releaser.join();
+    EXPECT_EQ(c, a);
+
+    EXPECT_EQ(pool.Release(b), RS_SUCCESS);
+    EXPECT_EQ(pool.Release(b), RS_INVALID_PARAM);
+    EXPECT_EQ(pool.Release(c), RS_SUCCESS);
+    EXPECT_EQ(pool.IdleSize(), 2u);
+}
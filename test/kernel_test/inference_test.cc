@@ -1,5 +1,6 @@
 #include "gtest/gtest.h"
 #include "inference/inference.h"
+#include "fake_inference.h"
 
 using namespace rayshape;
 using namespace rayshape::inference;
@@ -52,3 +53,24 @@ TEST(InferenceFactoryTest, CreateInvalidType) {
 //        EXPECT_EQ(inference, nullptr) << "Expected null for invalid type: " << param.type;
 //    }
 //}
+
+TEST(InferenceWarmupTest, DeclaredShapesAndRestore) {
+    test::FakeInference inference;
+    // 声明了最大/最小两个预热尺寸
+    inference.warmup_shapes_ = {{{"in", Dims{2, {8, 4}}}}, {{"in", Dims{2, {1, 4}}}},
+                                {{"in", Dims{2, {8, 4}}}}};
+    EXPECT_EQ(inference.Warmup(2), RS_SUCCESS);
+    // 重复的尺寸只预热一次
+    EXPECT_EQ(inference.forward_batches_, (std::vector<int>{8, 8, 1, 1}));
+    // 当前尺寸与最后一个预热尺寸相同,不需要恢复
+    EXPECT_EQ(inference.reshape_count_, 2);
+    EXPECT_EQ(inference.input_->dims.value[0], 1);
+
+    inference.forward_batches_.clear();
+    std::vector<std::map<std::string, Dims>> shapes = {{{"in", Dims{2, {4, 4}}}}};
+    EXPECT_EQ(inference.Warmup(1, shapes), RS_SUCCESS);
+    EXPECT_EQ(inference.forward_batches_, (std::vector<int>{4}));
+    EXPECT_EQ(inference.input_->dims.value[0], 1);
+
+    EXPECT_EQ(inference.Warmup(0), RS_INVALID_PARAM);
+}
@@ -0,0 +1,101 @@
+#include "utils/codec/model_serialize.h"
+#include "gtest/gtest.h"
+
+#include <sstream>
+
+using namespace rayshape;
+
+namespace
+{
+    // 按旧版本pack_models的布局手工写出ModelCodec: 多态类型id和类型名, unique_ptr有效标记, 模型字段
+    template <typename... Fields>
+    std::string LegacyArchive(const std::string &type_name, Fields &&...fields) {
+        std::ostringstream oss(std::ios::binary);
+        cereal::BinaryOutputArchive archive(oss);
+        archive(std::uint32_t(0x80000001), type_name, std::uint8_t(1));
+        archive(std::forward<Fields>(fields)...);
+        return oss.str();
+    }
+
+    std::unique_ptr<Model> RoundTrip(std::unique_ptr<Model> model) {
+        std::ostringstream oss(std::ios::binary);
+        ModelCodec save_codec(std::move(model));
+        ModelCodecSave(oss, save_codec);
+
+        std::istringstream iss(oss.str(), std::ios::binary);
+        ModelCodec load_codec;
+        ModelCodecLoad(iss, load_codec);
+        return std::move(load_codec.model_);
+    }
+} // namespace
+
+#ifdef ENABLE_OPENVINO_MODEL
+TEST(ModelSerializeTest, OpenVINOLegacyArchive) {
+    std::istringstream iss(LegacyArchive("rayshape::OpenVINOModel", std::string("{}"),
+                                         std::string("<xml/>"), std::string("bin")),
+                           std::ios::binary);
+    ModelCodec codec;
+    ModelCodecLoad(iss, codec);
+    auto model = dynamic_cast<OpenVINOModel *>(codec.model_.get());
+    ASSERT_NE(model, nullptr);
+    EXPECT_EQ(model->cfg_str_, "{}");
+    EXPECT_EQ(model->xml_content_, "<xml/>");
+    EXPECT_EQ(model->bin_content_, "bin");
+    EXPECT_TRUE(model->compiled_blob_.empty());
+}
+
+TEST(ModelSerializeTest, OpenVINORoundTrip) {
+    std::unique_ptr<OpenVINOModel> model(new OpenVINOModel("<xml/>", "bin"));
+    model->compiled_blob_ = "blob";
+    model->compiled_device_ = "CPU";
+    model->compiled_version_ = "2024.0";
+    auto loaded = RoundTrip(std::move(model));
+    auto openvino_model = dynamic_cast<OpenVINOModel *>(loaded.get());
+    ASSERT_NE(openvino_model, nullptr);
+    EXPECT_EQ(openvino_model->bin_content_, "bin");
+    EXPECT_EQ(openvino_model->compiled_blob_, "blob");
+    EXPECT_EQ(openvino_model->compiled_device_, "CPU");
+    EXPECT_EQ(openvino_model->compiled_version_, "2024.0");
+}
+#endif
+
+#ifdef ENABLE_ONNX_MODEL
+TEST(ModelSerializeTest, ONNXLegacyArchive) {
+    std::istringstream iss(LegacyArchive("rayshape::ONNXModel", std::string("{}"),
+                                         std::string("onnx")),
+                           std::ios::binary);
+    ModelCodec codec;
+    ModelCodecLoad(iss, codec);
+    auto model = dynamic_cast<ONNXModel *>(codec.model_.get());
+    ASSERT_NE(model, nullptr);
+    EXPECT_EQ(model->cfg_str_, "{}");
+    EXPECT_EQ(model->bin_buf_, "onnx");
+    EXPECT_FALSE(model->optimized_);
+}
+
+TEST(ModelSerializeTest, ONNXRoundTrip) {
+    std::unique_ptr<ONNXModel> model(new ONNXModel("ort"));
+    model->optimized_ = true;
+    model->optimized_level_ = "all";
+    model->optimized_version_ = "1.17.0";
+    auto loaded = RoundTrip(std::move(model));
+    auto onnx_model = dynamic_cast<ONNXModel *>(loaded.get());
+    ASSERT_NE(onnx_model, nullptr);
+    EXPECT_EQ(onnx_model->bin_buf_, "ort");
+    EXPECT_TRUE(onnx_model->optimized_);
+    EXPECT_EQ(onnx_model->optimized_level_, "all");
+    EXPECT_EQ(onnx_model->optimized_version_, "1.17.0");
+
+    // 旧版本加载器只读ModelCodec, 忽略扩展段
+    std::ostringstream oss(std::ios::binary);
+    ModelCodec save_codec(std::unique_ptr<Model>(new ONNXModel("ort")));
+    ModelCodecSave(oss, save_codec);
+    std::istringstream iss(oss.str(), std::ios::binary);
+    ModelCodec load_codec;
+    cereal::BinaryInputArchive archive(iss);
+    archive(load_codec);
+    auto legacy_loaded = dynamic_cast<ONNXModel *>(load_codec.model_.get());
+    ASSERT_NE(legacy_loaded, nullptr);
+    EXPECT_EQ(legacy_loaded->bin_buf_, "ort");
+}
+#endif
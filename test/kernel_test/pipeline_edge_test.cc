@@ -0,0 +1,281 @@
+#include "dag/edge.h"
+#include "dag/node.h"
+#include "dag/util.h"
+#include "gtest/gtest.h"
+
+using namespace rayshape;
+using namespace rayshape::dag;
+
+namespace
+{
+    class EmptyNode: public Node {
+    public:
+        explicit EmptyNode(const std::string &name) : Node(name) {}
+        ErrorCode Run() override {
+            return RS_SUCCESS;
+        }
+    };
+
+    // 构建一条流水线边,producer为nullptr时为图输入边
+    void BuildEdge(Edge &edge, Node *producer, std::vector<Node *> consumers) {
+        edge.SetParallelType(PARALLEL_TYPE_PIPELINE);
+        if (producer != nullptr) {
+            std::vector<Node *> producers = {producer};
+            edge.IncreaseProducers(producers);
+        }
+        edge.IncreaseConsumers(consumers);
+        edge.Construct();
+    }
+
+    Buffer *CreateValue(int64_t value) {
+        Buffer *buffer = new Buffer(sizeof(int64_t), MemoryType::HOST);
+        *static_cast<int64_t *>(buffer->GetDataPtr()) = value;
+        return buffer;
+    }
+
+    int64_t Value(Buffer *buffer) {
+        return buffer != nullptr ? *static_cast<int64_t *>(buffer->GetDataPtr()) : -1;
+    }
+} // namespace
+
+TEST(PipelineEdgeTest, MultiConsumerWrapAround) {
+    // 远多于槽位数的数据包,两个消费者都按顺序收到全部数据包
+    const int frames = 1000;
+    EmptyNode a("a");
+    EmptyNode b("b");
+    Edge edge("edge");
+    BuildEdge(edge, nullptr, {&a, &b});
+
+    auto consume = [&edge](Node *node, std::vector<int64_t> *values) {
+        for (int i = 0; i < frames; ++i) {
+            ASSERT_EQ(edge.Update(node), EdgeUpdateFlag::Complete);
+            values->push_back(Value(edge.GetBuff(node)));
+        }
+    };
+    std::vector<int64_t> values_a;
+    std::vector<int64_t> values_b;
+    std::thread thread_a(consume, &a, &values_a);
+    std::thread thread_b(consume, &b, &values_b);
+    for (int i = 0; i < frames; ++i) {
+        ASSERT_EQ(edge.SetBuff(CreateValue(i), false), RS_SUCCESS);
+    }
+    thread_a.join();
+    thread_b.join();
+
+    ASSERT_EQ(values_a.size(), static_cast<size_t>(frames));
+    for (int i = 0; i < frames; ++i) {
+        EXPECT_EQ(values_a[i], i);
+        EXPECT_EQ(values_b[i], i);
+    }
+}
+
+TEST(PipelineEdgeTest, BackPressureAndTerminate) {
+    EmptyNode consumer("consumer");
+    Edge edge("edge");
+    BuildEdge(edge, nullptr, {&consumer});
+    EXPECT_FALSE(edge.IsReadable(&consumer));
+
+    // 默认深度16,另留一个槽位给消费者正在使用的数据包,写满后不可写
+    for (int i = 0; i < 17; ++i) {
+        ASSERT_TRUE(edge.IsWritable());
+        ASSERT_EQ(edge.SetBuff(CreateValue(i), false), RS_SUCCESS);
+    }
+    EXPECT_FALSE(edge.IsWritable());
+    EXPECT_TRUE(edge.IsReadable(&consumer));
+
+    // 取走第一个还不释放槽位(消费者正在用),取走第二个时释放第一个
+    ASSERT_EQ(edge.Update(&consumer), EdgeUpdateFlag::Complete);
+    EXPECT_EQ(Value(edge.GetBuff(&consumer)), 0);
+    EXPECT_FALSE(edge.IsWritable());
+
+    std::atomic<bool> written(false);
+    std::thread producer([&edge, &written]() {
+        edge.SetBuff(CreateValue(17), false); // 阻塞到消费者释放槽位
+        written = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_FALSE(written.load());
+    ASSERT_EQ(edge.Update(&consumer), EdgeUpdateFlag::Complete);
+    EXPECT_EQ(Value(edge.GetBuff(&consumer)), 1);
+    producer.join();
+    EXPECT_TRUE(written.load());
+    EXPECT_FALSE(edge.IsWritable());
+
+    for (int i = 2; i <= 17; ++i) {
+        ASSERT_EQ(edge.Update(&consumer), EdgeUpdateFlag::Complete);
+        EXPECT_EQ(Value(edge.GetBuff(&consumer)), i);
+    }
+
+    // 环空时阻塞的消费者被终止唤醒
+    std::thread waiter([&edge, &consumer]() {
+        EXPECT_EQ(edge.Update(&consumer), EdgeUpdateFlag::Terminate);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_TRUE(edge.RequestTerminate());
+    waiter.join();
+}
+
+TEST(PipelineEdgeTest, GraphOutputGrows) {
+    // 没有消费者的图输出边写满时扩容,不阻塞生产者
+    EmptyNode producer("producer");
+    Edge edge("output");
+    BuildEdge(edge, &producer, {});
+    const int frames = 100;
+    for (int i = 0; i < frames; ++i) {
+        ASSERT_TRUE(edge.IsWritable());
+        ASSERT_EQ(edge.SetBuff(CreateValue(i), false), RS_SUCCESS);
+        EXPECT_EQ(Value(edge.GetBuff(&producer)), i);
+        if (i == frames / 2) {
+            EXPECT_EQ(Value(edge.GetGraphOutputBuffer()), 0);
+        }
+    }
+    for (int i = 1; i < frames; ++i) {
+        EXPECT_EQ(Value(edge.GetGraphOutputBuffer()), i);
+    }
+    EXPECT_EQ(edge.GetGraphOutputBuffer(), nullptr);
+}
+
+TEST(PipelineEdgeTest, DropNewest) {
+    // 写满后丢掉新数据,生产者不阻塞
+    EmptyNode consumer("consumer");
+    Edge edge("edge");
+    ASSERT_EQ(edge.SetQueueMaxSize(0), RS_INVALID_PARAM_VALUE);
+    ASSERT_EQ(edge.SetQueueMaxSize(4), RS_SUCCESS);
+    ASSERT_EQ(edge.SetOverflowPolicy(QUEUE_OVERFLOW_DROP_NEWEST), RS_SUCCESS);
+    BuildEdge(edge, nullptr, {&consumer});
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_TRUE(edge.IsWritable());
+        ASSERT_EQ(edge.SetBuff(CreateValue(i), false), RS_SUCCESS);
+    }
+    EXPECT_EQ(edge.GetDroppedSize(), 5);
+    for (int i = 0; i < 5; ++i) {
+        ASSERT_EQ(edge.Update(&consumer), EdgeUpdateFlag::Complete);
+        EXPECT_EQ(Value(edge.GetBuff(&consumer)), i);
+    }
+    EXPECT_FALSE(edge.IsReadable(&consumer));
+}
+
+TEST(PipelineEdgeTest, DropOldest) {
+    // 每个消费者最多留4个未消费的数据包,多出的最旧的被跳过
+    EmptyNode a("a");
+    EmptyNode b("b");
+    Edge edge("edge");
+    ASSERT_EQ(edge.SetQueueMaxSize(4), RS_SUCCESS);
+    ASSERT_EQ(edge.SetOverflowPolicy(QUEUE_OVERFLOW_DROP_OLDEST), RS_SUCCESS);
+    BuildEdge(edge, nullptr, {&a, &b});
+    ASSERT_EQ(edge.SetBuff(CreateValue(0), false), RS_SUCCESS);
+    ASSERT_EQ(edge.Update(&a), EdgeUpdateFlag::Complete);
+    EXPECT_EQ(Value(edge.GetBuff(&a)), 0);
+    for (int i = 1; i < 9; ++i) {
+        ASSERT_EQ(edge.SetBuff(CreateValue(i), false), RS_SUCCESS);
+    }
+    EXPECT_EQ(edge.GetDroppedSize(), 5);
+
+    // a持有的数据包在跳过后仍有效
+    EXPECT_EQ(Value(edge.GetBuff(&a)), 0);
+    for (int i = 5; i < 9; ++i) {
+        ASSERT_EQ(edge.Update(&a), EdgeUpdateFlag::Complete);
+        EXPECT_EQ(Value(edge.GetBuff(&a)), i);
+        ASSERT_EQ(edge.Update(&b), EdgeUpdateFlag::Complete);
+        EXPECT_EQ(Value(edge.GetBuff(&b)), i);
+    }
+    EXPECT_FALSE(edge.IsReadable(&a));
+    EXPECT_FALSE(edge.IsReadable(&b));
+}
+
+TEST(PipelineEdgeTest, KeepLatest) {
+    // 消费者慢时只拿到最新的数据包,持有的数据包不被覆盖
+    EmptyNode consumer("consumer");
+    Edge edge("edge");
+    ASSERT_EQ(edge.SetOverflowPolicy(QUEUE_OVERFLOW_KEEP_LATEST), RS_SUCCESS);
+    BuildEdge(edge, nullptr, {&consumer});
+    // 图的默认设置不覆盖边单独设置的策略
+    ASSERT_EQ(edge.SetDefaultQueue(16, QUEUE_OVERFLOW_BLOCK), RS_SUCCESS);
+    ASSERT_EQ(edge.SetBuff(CreateValue(0), false), RS_SUCCESS);
+    ASSERT_EQ(edge.Update(&consumer), EdgeUpdateFlag::Complete);
+    for (int round = 1; round <= 3; ++round) {
+        for (int i = 1; i <= 100; ++i) {
+            EXPECT_TRUE(edge.IsWritable());
+            ASSERT_EQ(edge.SetBuff(CreateValue(round * 1000 + i), false), RS_SUCCESS);
+        }
+        EXPECT_EQ(Value(edge.GetBuff(&consumer)), round == 1 ? 0 : (round - 1) * 1000 + 100);
+        ASSERT_EQ(edge.Update(&consumer), EdgeUpdateFlag::Complete);
+        EXPECT_EQ(Value(edge.GetBuff(&consumer)), round * 1000 + 100);
+        EXPECT_FALSE(edge.IsReadable(&consumer));
+    }
+    EXPECT_EQ(edge.GetDroppedSize(), 3 * 99);
+}
+
+TEST(PipelineEdgeTest, KeepLatestConcurrent) {
+    // 生产者远快于消费者,消费者收到的序号递增且最后一个数据包不丢
+    const int frames = 20000;
+    EmptyNode consumer("consumer");
+    Edge edge("edge");
+    ASSERT_EQ(edge.SetOverflowPolicy(QUEUE_OVERFLOW_KEEP_LATEST), RS_SUCCESS);
+    BuildEdge(edge, nullptr, {&consumer});
+    std::vector<int64_t> values;
+    std::thread thread([&edge, &consumer, &values]() {
+        while (values.empty() || values.back() != frames - 1) {
+            if (edge.Update(&consumer) != EdgeUpdateFlag::Complete) {
+                return;
+            }
+            values.push_back(Value(edge.GetBuff(&consumer)));
+        }
+    });
+    for (int i = 0; i < frames; ++i) {
+        ASSERT_EQ(edge.SetBuff(CreateValue(i), false), RS_SUCCESS);
+    }
+    thread.join();
+    ASSERT_FALSE(values.empty());
+    EXPECT_EQ(values.back(), frames - 1);
+    for (size_t i = 1; i < values.size(); ++i) {
+        EXPECT_GT(values[i], values[i - 1]);
+    }
+    EXPECT_EQ(edge.GetDroppedSize() + static_cast<int64_t>(values.size()), frames);
+}
+
+TEST(PipelineEdgeTest, Replicas) {
+    // 多副本生产者的写入按提交顺序可读,多副本消费者的每个副本各自持有数据包
+    EmptyNode producer("producer");
+    EmptyNode consumer("consumer");
+    ASSERT_EQ(producer.SetReplicaSize(0), RS_INVALID_PARAM_VALUE);
+    ASSERT_EQ(producer.SetReplicaSize(2), RS_SUCCESS);
+    ASSERT_EQ(consumer.SetReplicaSize(2), RS_SUCCESS);
+    Edge edge("edge");
+    BuildEdge(edge, &producer, {&consumer});
+
+    edge.BeginReplicaWrite();
+    edge.BeginReplicaWrite();
+    {
+        RunSlotGuard guard(1);
+        ASSERT_EQ(edge.SetBuff(CreateValue(1), false), RS_SUCCESS);
+        EXPECT_EQ(Value(edge.GetBuff(&producer)), 1);
+    }
+    {
+        RunSlotGuard guard(0);
+        ASSERT_EQ(edge.SetBuff(CreateValue(0), false), RS_SUCCESS);
+        EXPECT_EQ(Value(edge.GetBuff(&producer)), 0);
+    }
+    // 暂存的数据提交前不可读
+    EXPECT_FALSE(edge.IsReadable(&consumer));
+    edge.EndReplicaWrite(0, true);
+    edge.EndReplicaWrite(1, true);
+
+    for (int slot = 0; slot < 2; ++slot) {
+        RunSlotGuard guard(slot);
+        ASSERT_EQ(edge.Update(&consumer), EdgeUpdateFlag::Complete);
+    }
+    for (int slot = 0; slot < 2; ++slot) {
+        RunSlotGuard guard(slot);
+        EXPECT_EQ(Value(edge.GetBuff(&consumer)), slot);
+    }
+
+    // 运行失败时丢掉暂存的数据
+    edge.BeginReplicaWrite();
+    {
+        RunSlotGuard guard(1);
+        ASSERT_EQ(edge.SetBuff(CreateValue(5), false), RS_SUCCESS);
+    }
+    edge.EndReplicaWrite(1, false);
+    EXPECT_FALSE(edge.IsReadable(&consumer));
+}
@@ -0,0 +1,66 @@
+#include "inference/precision.h"
+#include "gtest/gtest.h"
+
+using namespace rayshape;
+using namespace rayshape::inference;
+using namespace rayshape::utils;
+
+TEST(PrecisionTest, ConvertToPrecision) {
+    Precision precision = Precision::AUTO;
+    EXPECT_EQ(ConvertToPrecision(precision, "BF16"), RS_SUCCESS);
+    EXPECT_EQ(precision, Precision::BF16);
+    EXPECT_EQ(ConvertToPrecision(precision, "fp16"), RS_SUCCESS);
+    EXPECT_EQ(precision, Precision::FP16);
+    EXPECT_EQ(ConvertToPrecision(precision, "fp32"), RS_SUCCESS);
+    EXPECT_EQ(precision, Precision::HIGH);
+    EXPECT_EQ(ConvertToPrecision(precision, "int4"), RS_INVALID_PARAM_VALUE);
+    EXPECT_EQ(precision, Precision::HIGH);
+
+    for (Precision p : {Precision::AUTO, Precision::NORMAL, Precision::HIGH, Precision::LOW,
+                        Precision::BF16, Precision::FP16}) {
+        Precision parsed = Precision::AUTO;
+        EXPECT_EQ(ConvertToPrecision(parsed, PrecisionToString(p)), RS_SUCCESS);
+        EXPECT_EQ(parsed, p);
+    }
+}
+
+TEST(PrecisionTest, ParsePrecision) {
+    RSJsonHandle json_handle = nullptr;
+    ASSERT_EQ(RSJsonCreate(std::string(R"({"NetworkConfig": {"Precision": "bf16"}})"),
+                           &json_handle),
+              RS_SUCCESS);
+    Precision precision = Precision::AUTO;
+    EXPECT_EQ(ParsePrecision(json_handle, precision), RS_SUCCESS);
+    EXPECT_EQ(precision, Precision::BF16);
+    RSJsonDestory(&json_handle);
+
+    // CustomRuntime中显式指定的精度优先
+    ASSERT_EQ(RSJsonCreate(std::string(R"({"NetworkConfig": {"Precision": "bf16"}})"),
+                           &json_handle),
+              RS_SUCCESS);
+    precision = Precision::HIGH;
+    EXPECT_EQ(ParsePrecision(json_handle, precision), RS_SUCCESS);
+    EXPECT_EQ(precision, Precision::HIGH);
+    RSJsonDestory(&json_handle);
+
+    // 未声明时保持原值
+    ASSERT_EQ(RSJsonCreate(std::string(R"({"ModelConfig": {}})"), &json_handle), RS_SUCCESS);
+    precision = Precision::AUTO;
+    EXPECT_EQ(ParsePrecision(json_handle, precision), RS_SUCCESS);
+    EXPECT_EQ(precision, Precision::AUTO);
+    RSJsonDestory(&json_handle);
+
+    // 有NetworkConfig但没有Precision时也保持原值
+    ASSERT_EQ(RSJsonCreate(std::string(R"({"NetworkConfig": {"NumThreads": 4}})"), &json_handle),
+              RS_SUCCESS);
+    precision = Precision::AUTO;
+    EXPECT_EQ(ParsePrecision(json_handle, precision), RS_SUCCESS);
+    EXPECT_EQ(precision, Precision::AUTO);
+    RSJsonDestory(&json_handle);
+
+    ASSERT_EQ(RSJsonCreate(std::string(R"({"NetworkConfig": {"Precision": "int4"}})"),
+                           &json_handle),
+              RS_SUCCESS);
+    EXPECT_EQ(ParsePrecision(json_handle, precision), RS_INVALID_PARAM_VALUE);
+    RSJsonDestory(&json_handle);
+}
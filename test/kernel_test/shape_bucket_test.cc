@@ -0,0 +1,87 @@
+#include "inference/shape_bucket_inference.h"
+#include "utils/json_utils.h"
+#include "gtest/gtest.h"
+
+using namespace rayshape;
+using namespace rayshape::inference;
+using namespace rayshape::utils;
+
+TEST(ShapeBucketTest, ParseShapeBuckets) {
+    std::string cfg = R"({"ModelConfig": {"ShapeBuckets": {"PadMode": "letterbox", "PadValue": 114,
+        "Shapes": [{"name": "images", "dims": [[1, 3, 320, 320], [1, 3, 640, 640]]}]}}})";
+    RSJsonHandle json_handle = nullptr;
+    ASSERT_EQ(RSJsonCreate(cfg, &json_handle), RS_SUCCESS);
+
+    ShapeBucketPolicy policy;
+    EXPECT_EQ(ParseShapeBuckets(json_handle, policy), RS_SUCCESS);
+    EXPECT_EQ(policy.pad_mode_, BucketPadMode::LETTERBOX);
+    EXPECT_EQ(policy.pad_value_, 114);
+    ASSERT_EQ(policy.buckets_["images"].size(), 2u);
+    EXPECT_EQ(policy.buckets_["images"][1].value[3], 640);
+    RSJsonDestory(&json_handle);
+
+    // no PadMode: default pad
+    ASSERT_EQ(RSJsonCreate(std::string(R"({"ModelConfig": {"ShapeBuckets": {
+        "Shapes": [{"name": "images", "dims": [[1, 3, 320, 320]]}]}}})"),
+                           &json_handle),
+              RS_SUCCESS);
+    policy.pad_mode_ = BucketPadMode::LETTERBOX;
+    EXPECT_EQ(ParseShapeBuckets(json_handle, policy), RS_SUCCESS);
+    EXPECT_EQ(policy.pad_mode_, BucketPadMode::PAD);
+    ASSERT_EQ(policy.buckets_["images"].size(), 1u);
+    RSJsonDestory(&json_handle);
+
+    // no ShapeBuckets: empty policy
+    ASSERT_EQ(RSJsonCreate(std::string(R"({"ModelConfig": {}})"), &json_handle), RS_SUCCESS);
+    EXPECT_EQ(ParseShapeBuckets(json_handle, policy), RS_SUCCESS);
+    EXPECT_TRUE(policy.buckets_.empty());
+    RSJsonDestory(&json_handle);
+}
+
+TEST(ShapeBucketTest, SelectShapeBucket) {
+    std::vector<Dims> buckets = {{4, {1, 3, 640, 640}}, {4, {1, 3, 320, 320}}};
+    Dims bucket;
+
+    EXPECT_EQ(SelectShapeBucket(buckets, Dims{4, {1, 3, 300, 200}}, bucket), RS_SUCCESS);
+    EXPECT_EQ(bucket.value[2], 320);
+
+    EXPECT_EQ(SelectShapeBucket(buckets, Dims{4, {1, 3, 321, 100}}, bucket), RS_SUCCESS);
+    EXPECT_EQ(bucket.value[2], 640);
+
+    EXPECT_EQ(SelectShapeBucket(buckets, Dims{4, {1, 3, 641, 100}}, bucket),
+              RS_INVALID_PARAM_VALUE);
+}
+
+TEST(ShapeBucketTest, PadAndCropRoundTrip) {
+    Dims dims{4, {1, 2, 3, 5}};
+    Dims bucket{4, {1, 2, 8, 8}};
+    Blob *src = BlobAlloc(DeviceType::CPU, DataType::FLOAT, DataFormat::NCHW, "src", &dims);
+    Blob *padded = BlobAlloc(DeviceType::CPU, DataType::FLOAT, DataFormat::NCHW, "pad", &bucket);
+    Blob *crop = BlobAlloc(DeviceType::CPU, DataType::FLOAT, DataFormat::NCHW, "crop", &dims);
+
+    float *src_data = static_cast<float *>(src->buffer->GetDataPtr());
+    for (int i = 0; i < 2 * 3 * 5; ++i) {
+        src_data[i] = static_cast<float>(i + 1);
+    }
+
+    Dims offset;
+    ComputeBucketOffset(BucketPadMode::LETTERBOX, DataFormat::NCHW, dims, bucket, offset);
+    EXPECT_EQ(offset.value[1], 0);
+    EXPECT_EQ(offset.value[2], 2);
+    EXPECT_EQ(offset.value[3], 1);
+
+    EXPECT_EQ(PadBlobToBucket(src, padded, offset, 7), RS_SUCCESS);
+    float *pad_data = static_cast<float *>(padded->buffer->GetDataPtr());
+    EXPECT_EQ(pad_data[0], 7.0f);
+    EXPECT_EQ(pad_data[2 * 8 + 1], 1.0f);
+
+    EXPECT_EQ(CropBlobFromBucket(padded, crop, offset), RS_SUCCESS);
+    float *crop_data = static_cast<float *>(crop->buffer->GetDataPtr());
+    for (int i = 0; i < 2 * 3 * 5; ++i) {
+        EXPECT_EQ(crop_data[i], src_data[i]);
+    }
+
+    BlobFree(src);
+    BlobFree(padded);
+    BlobFree(crop);
+}
@@ -0,0 +1,84 @@
+#include "thread_pool/thread_pool.h"
+#include "gtest/gtest.h"
+
+using namespace rayshape;
+using namespace rayshape::threadpool;
+
+TEST(ThreadPoolTest, PriorityQueueOrder) {
+    SafePriorityQueue<int> queue;
+    const int priorities[] = {1, 5, 3, 5, 0};
+    for (int i = 0; i < 5; ++i) {
+        int value = i;
+        ASSERT_TRUE(queue.TryPush(std::move(value), priorities[i]));
+    }
+    // 优先级高的先出,同优先级先进先出
+    std::vector<int> order;
+    int value = -1;
+    while (queue.TryPop(value)) {
+        order.push_back(value);
+    }
+    EXPECT_EQ(order, (std::vector<int>{1, 3, 2, 0, 4}));
+    EXPECT_FALSE(queue.TrySteal(value));
+}
+
+TEST(ThreadPoolTest, PriorityTasksFirst) {
+    ThreadPool pool(1);
+    ASSERT_EQ(pool.Init(), RS_SUCCESS);
+    EXPECT_FALSE(pool.IsWorkerThread());
+
+    // 先占住唯一的线程,再提交普通任务和带优先级的任务
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::future<void> blocker = pool.Commit([released] { released.wait(); });
+    std::mutex mutex;
+    std::vector<int> order;
+    std::vector<std::future<void>> futures;
+    auto record = [&mutex, &order](int value) {
+        std::lock_guard<std::mutex> lock(mutex);
+        order.push_back(value);
+    };
+    futures.push_back(pool.Commit([record] { record(0); }));
+    futures.push_back(pool.Commit([record] { record(1); }, 1));
+    futures.push_back(pool.Commit([record] { record(3); }, 3));
+    futures.push_back(pool.Commit([record] { record(2); }, 2));
+    release.set_value();
+    blocker.get();
+    for (auto &future : futures) {
+        future.get();
+    }
+    EXPECT_EQ(order, (std::vector<int>{3, 2, 1, 0}));
+
+    // 工作线程上本地提交
+    bool is_worker = false;
+    pool.CommitLocal([&pool, &is_worker] { is_worker = pool.IsWorkerThread(); }, 1).get();
+    EXPECT_TRUE(is_worker);
+    pool.DeInit();
+}
+
+TEST(ThreadPoolTest, HelpingWait) {
+    ThreadPool pool(1);
+    ASSERT_EQ(pool.Init(), RS_SUCCESS);
+
+    // 唯一的线程被占住,等待方自己执行提交的任务
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::future<void> blocker = pool.Commit([released] { released.wait(); });
+    std::thread::id caller = std::this_thread::get_id();
+    std::thread::id runner;
+    std::future<int> future = pool.Commit([&runner] {
+        runner = std::this_thread::get_id();
+        return 7;
+    });
+    EXPECT_EQ(pool.Wait(future), 7);
+    EXPECT_EQ(runner, caller);
+    release.set_value();
+    pool.Wait(blocker);
+
+    // 工作线程里等待嵌套提交的任务,直接get会死锁
+    std::future<int> outer = pool.Commit([&pool] {
+        std::future<int> inner = pool.CommitLocal([] { return 1; });
+        return pool.Wait(inner) + 1;
+    });
+    EXPECT_EQ(outer.get(), 2);
+    pool.DeInit();
+}
@@ -0,0 +1,297 @@
+/**
+ * @file main.cpp
+ * @brief Pipeline edge benchmark main entry point
+ * @details 用若干条流水线边串成一条链,每一跳一个线程: Update取数据包后把buffer转发到下一条边.
+ * latency模式一次只有一帧在链上,统计每一跳的空载时延;throughput模式源端尽快写入,
+ * 统计满载吞吐和端到端时延.不依赖模型,直接测量边本身的开销.
+ * @copyright (c) .
+ */
+
+#include "dag/edge.h"
+#include "dag/node.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace rayshape;
+using namespace rayshape::dag;
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief Command line arguments
+ */
+struct BenchArgs {
+    int hops = 4;          // 链上边的条数
+    int frames = 100000;   // 吞吐模式的帧数
+    int iterations = 2000; // 时延模式的帧数
+    int warmup = 100;
+};
+
+/**
+ * @brief Result of one benchmark mode
+ */
+struct BenchResult {
+    double fps = 0.0;
+    double mean_us = 0.0; // 每一跳
+    double p50_us = 0.0;
+    double p99_us = 0.0;
+};
+
+/**
+ * @brief 转发节点,只用来标识边的生产者和消费者
+ */
+class HopNode: public Node {
+public:
+    explicit HopNode(const std::string &name) : Node(name) {}
+    ErrorCode Run() override {
+        return RS_SUCCESS;
+    }
+};
+
+/**
+ * @brief 边和节点组成的链: source -> e0 -> n0 -> e1 -> n1 ... -> e[hops-1] -> n[hops-1]
+ */
+class EdgeChain {
+public:
+    explicit EdgeChain(int hops) {
+        for (int i = 0; i < hops; ++i) {
+            edges_.emplace_back(new Edge("e" + std::to_string(i)));
+            nodes_.emplace_back(new HopNode("n" + std::to_string(i)));
+        }
+        for (int i = 0; i < hops; ++i) {
+            Edge *edge = edges_[i].get();
+            edge->SetParallelType(PARALLEL_TYPE_PIPELINE);
+            std::vector<Node *> consumers = {nodes_[i].get()};
+            edge->IncreaseConsumers(consumers);
+            if (i > 0) {
+                std::vector<Node *> producers = {nodes_[i - 1].get()};
+                edge->IncreaseProducers(producers);
+            }
+            edge->Construct();
+        }
+    }
+
+    /**
+     * @brief 每一跳一个线程转发frames帧,最后一跳回调on_receive
+     */
+    template <typename Func>
+    void Start(int frames, Func on_receive) {
+        int hops = static_cast<int>(edges_.size());
+        for (int i = 0; i < hops; ++i) {
+            threads_.emplace_back([this, i, hops, frames, on_receive]() {
+                Edge *input = edges_[i].get();
+                Node *node = nodes_[i].get();
+                for (int f = 0; f < frames; ++f) {
+                    if (input->Update(node) != EdgeUpdateFlag::Complete) {
+                        break;
+                    }
+                    Buffer *buffer = input->GetBuff(node);
+                    if (i + 1 < hops) {
+                        edges_[i + 1]->SetBuff(buffer, true);
+                    } else {
+                        on_receive(buffer);
+                    }
+                }
+            });
+        }
+    }
+
+    void Join() {
+        for (auto &thread : threads_) {
+            thread.join();
+        }
+        threads_.clear();
+    }
+
+    Edge *Input() {
+        return edges_.front().get();
+    }
+
+private:
+    std::vector<std::unique_ptr<Edge>> edges_;
+    std::vector<std::unique_ptr<HopNode>> nodes_;
+    std::vector<std::thread> threads_;
+};
+
+/**
+ * @brief 链上可能同时存在的帧都要有独立的buffer,按帧号轮转使用
+ */
+std::vector<std::unique_ptr<Buffer>> CreateBuffers(int count) {
+    std::vector<std::unique_ptr<Buffer>> buffers;
+    for (int i = 0; i < count; ++i) {
+        buffers.emplace_back(new Buffer(sizeof(int64_t), MemoryType::HOST));
+    }
+    return buffers;
+}
+
+int64_t FrameIndex(Buffer *buffer) {
+    return *static_cast<int64_t *>(buffer->GetDataPtr());
+}
+
+void Percentile(std::vector<double> &values, BenchResult &result) {
+    if (values.empty()) {
+        return;
+    }
+    std::sort(values.begin(), values.end());
+    double sum = 0.0;
+    for (double value : values) {
+        sum += value;
+    }
+    result.mean_us = sum / values.size();
+    result.p50_us = values[values.size() / 2];
+    result.p99_us = values[std::min(values.size() - 1, values.size() * 99 / 100)];
+}
+
+/**
+ * @brief 空载时延: 上一帧到达链尾后才写入下一帧
+ */
+BenchResult RunLatency(const BenchArgs &args) {
+    int frames = args.warmup + args.iterations;
+    EdgeChain chain(args.hops);
+    std::vector<std::unique_ptr<Buffer>> buffers = CreateBuffers(2);
+    std::atomic<int64_t> received(0);
+    chain.Start(frames, [&received](Buffer *buffer) { received = FrameIndex(buffer) + 1; });
+
+    std::vector<double> latencies;
+    for (int f = 0; f < frames; ++f) {
+        Buffer *buffer = buffers[f % buffers.size()].get();
+        *static_cast<int64_t *>(buffer->GetDataPtr()) = f;
+        Clock::time_point start = Clock::now();
+        chain.Input()->SetBuff(buffer, true);
+        while (received.load() <= f) {
+            std::this_thread::yield();
+        }
+        double us = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+        if (f >= args.warmup) {
+            latencies.push_back(us / args.hops);
+        }
+    }
+    chain.Join();
+
+    BenchResult result;
+    Percentile(latencies, result);
+    return result;
+}
+
+/**
+ * @brief 满载吞吐: 源端尽快写入,边满时背压
+ */
+BenchResult RunThroughput(const BenchArgs &args) {
+    EdgeChain chain(args.hops);
+    // 每条边最多缓存队列深度+1帧,再留出每一跳正在转发的一帧
+    std::vector<std::unique_ptr<Buffer>> buffers = CreateBuffers(64 * (args.hops + 1));
+    std::vector<Clock::time_point> sent(args.frames);
+    std::vector<double> latencies(args.frames, 0.0);
+    Clock::time_point last;
+    chain.Start(args.frames, [&](Buffer *buffer) {
+        int64_t f = FrameIndex(buffer);
+        last = Clock::now();
+        latencies[f] = std::chrono::duration<double, std::micro>(last - sent[f]).count();
+    });
+
+    Clock::time_point start = Clock::now();
+    for (int f = 0; f < args.frames; ++f) {
+        Buffer *buffer = buffers[f % buffers.size()].get();
+        *static_cast<int64_t *>(buffer->GetDataPtr()) = f;
+        sent[f] = Clock::now();
+        chain.Input()->SetBuff(buffer, true);
+    }
+    chain.Join();
+
+    BenchResult result;
+    double seconds = std::chrono::duration<double>(last - start).count();
+    result.fps = seconds > 0.0 ? args.frames / seconds : 0.0;
+    for (auto &latency : latencies) {
+        latency /= args.hops;
+    }
+    Percentile(latencies, result);
+    return result;
+}
+
+/**
+ * @brief Print error message
+ */
+void PrintError(const std::string &message) {
+    std::cerr << "[ERROR] " << message << std::endl;
+}
+
+/**
+ * @brief Show help information
+ */
+void ShowHelp() {
+    std::cout << "edge_bench - per-hop latency and throughput of pipeline edges\n\n";
+    std::cout << "USAGE:\n";
+    std::cout << "  edge_bench [options]\n\n";
+    std::cout << "OPTIONS:\n";
+    std::cout << "  --hops <num>              Edges in the chain, one thread per hop (default: 4)\n";
+    std::cout << "  --frames <num>            Frames for throughput mode (default: 100000)\n";
+    std::cout << "  --iterations <num>        Frames for latency mode (default: 2000)\n";
+    std::cout << "  --warmup <num>            Latency frames not counted (default: 100)\n";
+    std::cout << "  -h, --help                Show this help\n";
+}
+
+/**
+ * @brief Parse command line arguments
+ */
+bool ParseArgs(int argc, char *argv[], BenchArgs &args) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        try {
+            if (arg == "-h" || arg == "--help") {
+                return false;
+            } else if (arg == "--hops" && has_value) {
+                args.hops = std::stoi(argv[++i]);
+            } else if (arg == "--frames" && has_value) {
+                args.frames = std::stoi(argv[++i]);
+            } else if (arg == "--iterations" && has_value) {
+                args.iterations = std::stoi(argv[++i]);
+            } else if (arg == "--warmup" && has_value) {
+                args.warmup = std::stoi(argv[++i]);
+            } else {
+                PrintError("Unknown or incomplete argument: " + arg);
+                return false;
+            }
+        } catch (const std::exception &e) {
+            PrintError("Invalid value for " + arg + ": " + e.what());
+            return false;
+        }
+    }
+    if (args.hops <= 0 || args.frames <= 0 || args.iterations <= 0 || args.warmup < 0) {
+        PrintError("hops, frames and iterations must be > 0");
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    BenchArgs args;
+    if (!ParseArgs(argc, argv, args)) {
+        ShowHelp();
+        return 1;
+    }
+
+    std::cout << "[INFO] hops: " << args.hops
+              << ", hardware threads: " << std::thread::hardware_concurrency() << std::endl;
+    BenchResult latency = RunLatency(args);
+    BenchResult throughput = RunThroughput(args);
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << std::left << std::setw(12) << "mode" << std::setw(14) << "frames/s"
+              << std::setw(16) << "hop mean(us)" << std::setw(16) << "hop p50(us)"
+              << std::setw(16) << "hop p99(us)" << std::endl;
+    std::cout << std::left << std::setw(12) << "latency" << std::setw(14) << "-"
+              << std::setw(16) << latency.mean_us << std::setw(16) << latency.p50_us
+              << std::setw(16) << latency.p99_us << std::endl;
+    std::cout << std::left << std::setw(12) << "throughput" << std::setw(14) << throughput.fps
+              << std::setw(16) << throughput.mean_us << std::setw(16) << throughput.p50_us
+              << std::setw(16) << throughput.p99_us << std::endl;
+    return 0;
+}
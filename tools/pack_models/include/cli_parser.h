@@ -64,6 +64,12 @@ namespace rayshape
             // Encryption options
             bool enable_encryption = false;
 
+            // Precompile options
+            bool enable_precompile = false;
+            rayshape::DeviceType device_type = rayshape::DeviceType::CPU;
+            int num_thread = -1;
+            std::string opt_level = "all";
+
             CommandLineArgs() = default;
         };
 
@@ -110,6 +116,13 @@ namespace rayshape
              */
             rayshape::ModelType ParseModelType(const std::string &type_str) const;
 
+            /**
+             * @brief Parse precompile target device from string
+             * @param device_str Device string
+             * @return DeviceType value
+             */
+            rayshape::DeviceType ParseDeviceType(const std::string &device_str) const;
+
             /**
              * @brief Parse command from string
              * @param command_str Command string
@@ -20,6 +20,19 @@ namespace rayshape
     namespace tools
     {
 
+        /**
+         * @brief Offline precompile options
+         *
+         * When enabled, models are compiled for the target device while packing and the
+         * compiled result is stored inside the .rsm, so loading can skip online compilation.
+         */
+        struct PrecompileConfig {
+            bool enable = false;
+            rayshape::DeviceType device_type = rayshape::DeviceType::CPU;
+            int num_thread = -1;
+            std::string opt_level = "all"; // ONNX offline graph optimization level
+        };
+
         /**
          * @brief Model serialization utility class
          *
@@ -97,6 +110,14 @@ namespace rayshape
                 return last_error_;
             }
 
+            /**
+             * @brief Set offline precompile options
+             * @param config Precompile options
+             */
+            void SetPrecompileConfig(const PrecompileConfig &config) {
+                precompile_config_ = config;
+            }
+
             /**
              * @brief Validate model file before serialization
              * @param model_path Path to model file
@@ -122,6 +143,7 @@ namespace rayshape
 
         private:
             std::string last_error_;
+            PrecompileConfig precompile_config_;
         };
 
     } // namespace tools
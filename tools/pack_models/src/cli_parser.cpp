@@ -149,6 +149,42 @@ namespace rayshape
                     }
                 } else if (arg == "--encrypt") {
                     args.enable_encryption = true;
+                } else if (arg == "--precompile") {
+                    args.enable_precompile = true;
+                } else if (arg == "--device") {
+                    if (i + 1 >= argc) {
+                        SetError("Device not specified after --device");
+                        return false;
+                    }
+                    args.device_type = ParseDeviceType(argv[++i]);
+                    if (args.device_type == rayshape::DeviceType::NONE) {
+                        SetError("Invalid device: " + std::string(argv[i]));
+                        return false;
+                    }
+                } else if (arg == "--opt-level") {
+                    if (i + 1 >= argc) {
+                        SetError("Optimization level not specified after --opt-level");
+                        return false;
+                    }
+                    args.opt_level = argv[++i];
+                    std::transform(args.opt_level.begin(), args.opt_level.end(),
+                                   args.opt_level.begin(), ::tolower);
+                    if (args.opt_level != "basic" && args.opt_level != "extended"
+                        && args.opt_level != "all") {
+                        SetError("Invalid optimization level: " + args.opt_level);
+                        return false;
+                    }
+                } else if (arg == "--threads") {
+                    if (i + 1 >= argc) {
+                        SetError("Thread num not specified after --threads");
+                        return false;
+                    }
+                    try {
+                        args.num_thread = std::stoi(argv[++i]);
+                    } catch (const std::exception &) {
+                        SetError("Invalid thread num: " + std::string(argv[i]));
+                        return false;
+                    }
                 } else if (arg[0] != '-') {
                     // Positional argument - treat as input file if no input path set
                     if (args.input_path.empty()) {
@@ -204,6 +240,16 @@ namespace rayshape
             std::cout << "  --encrypt                 Enable automatic encryption for output files\n";
             std::cout << "                            (Uses auto-generated secure keys, transparent to user)\n\n";
 
+            std::cout << "PRECOMPILE OPTIONS (serialize, OpenVINO and ONNX):\n";
+            std::cout << "  --precompile              OpenVINO: compile for target device and embed the compiled blob\n";
+            std::cout << "                            (Loaded directly when device and OpenVINO version match)\n";
+            std::cout << "                            ONNX: optimize graph offline and store ORT format model\n";
+            std::cout << "                            (Online graph optimization is skipped when loading)\n";
+            std::cout << "  --device <cpu|gpu>        Precompile target device (default: cpu, OpenVINO only)\n";
+            std::cout << "  --threads <num>           Inference thread num used for precompile (OpenVINO only)\n";
+            std::cout << "  --opt-level <level>       Offline graph optimization level: basic, extended, all\n";
+            std::cout << "                            (default: all, ONNX only; use extended for other CPUs)\n\n";
+
             std::cout << "MODEL TYPES:\n";
             std::cout << "  mnn          MNN model format\n";
             std::cout << "  openvino     OpenVINO model format\n";
@@ -221,11 +267,21 @@ namespace rayshape
                 << "  " << TOOL_NAME
                 << " serialize -t openvino --xml model.xml --bin model.bin --config config.json -o model_serialized.rsm\n\n";
 
+            std::cout << "  # Serialize OpenVINO model with precompiled CPU blob\n";
+            std::cout
+                << "  " << TOOL_NAME
+                << " serialize -t openvino --xml model.xml --bin model.bin --config config.json -o model_serialized.rsm --precompile --device cpu\n\n";
+
             std::cout << "  # Serialize ONNX model\n";
             std::cout
                 << "  " << TOOL_NAME
                 << " serialize -t onnx -i model.onnx --config config.json -o model_serialized.rsm\n\n";
 
+            std::cout << "  # Serialize ONNX model with offline graph optimization\n";
+            std::cout
+                << "  " << TOOL_NAME
+                << " serialize -t onnx -i model.onnx --config config.json -o model_serialized.rsm --precompile --opt-level extended\n\n";
+
             std::cout << "  # Serialize TensorRT model\n";
             std::cout
                 << "  " << TOOL_NAME
@@ -274,6 +330,20 @@ namespace rayshape
             return rayshape::ModelType::NONE;
         }
 
+        rayshape::DeviceType CLIParser::ParseDeviceType(const std::string &device_str) const {
+            std::string lower_device = device_str;
+            std::transform(lower_device.begin(), lower_device.end(), lower_device.begin(),
+                           ::tolower);
+
+            if (lower_device == "cpu") {
+                return rayshape::DeviceType::CPU;
+            } else if (lower_device == "gpu") {
+                return rayshape::DeviceType::INTERL_GPU;
+            }
+
+            return rayshape::DeviceType::NONE;
+        }
+
         CommandType CLIParser::ParseCommand(const std::string &command_str) const {
             if (command_str == "serialize" || command_str == "s") {
                 return CommandType::SERIALIZE;
@@ -313,6 +383,11 @@ namespace rayshape
                     SetError("Config file path required for serialize command (use --config)");
                     return false;
                 }
+                if (args.enable_precompile && args.model_type != rayshape::ModelType::OPENVINO
+                    && args.model_type != rayshape::ModelType::ONNX) {
+                    SetError("--precompile is only supported for OpenVINO and ONNX models");
+                    return false;
+                }
                 if (args.model_type == rayshape::ModelType::OPENVINO) {
                     if (args.xml_path.empty() || args.bin_path.empty()) {
                         SetError("Both XML and BIN paths required for OpenVINO models");
@@ -413,7 +488,11 @@ namespace rayshape
                 std::cout << "    --xml <path>              XML file (OpenVINO only)\n";
                 std::cout << "    --bin <path>              BIN file (OpenVINO only)\n";
                 std::cout << "    --config <path>           Configuration JSON file (required)\n";
-                std::cout << "    --encrypt                 Enable automatic encryption\n\n";
+                std::cout << "    --encrypt                 Enable automatic encryption\n";
+                std::cout << "    --precompile              Embed compiled blob (OpenVINO) or ORT format model (ONNX)\n";
+                std::cout << "    --device <cpu|gpu>        Precompile target device\n";
+                std::cout << "    --threads <num>           Precompile inference thread num\n";
+                std::cout << "    --opt-level <level>       ONNX offline optimization level\n\n";
                 break;
 
             case CommandType::DESERIALIZE:
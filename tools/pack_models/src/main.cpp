@@ -101,6 +101,16 @@ int ExecuteSerialize(const CommandLineArgs &args) {
     ModelSerializer serializer;
     bool success = false;
 
+    if (args.enable_precompile) {
+        PrecompileConfig precompile_config;
+        precompile_config.enable = true;
+        precompile_config.device_type = args.device_type;
+        precompile_config.num_thread = args.num_thread;
+        precompile_config.opt_level = args.opt_level;
+        serializer.SetPrecompileConfig(precompile_config);
+        PrintVerbose(args.verbose, "Precompile enabled, compiled blob will be embedded");
+    }
+
     auto start_time = std::chrono::high_resolution_clock::now();
 
     switch (args.model_type) {
@@ -459,6 +469,12 @@ int ExecuteDeserialize(const CommandLineArgs &args) {
             if (!ov_model->cfg_str_.empty()) {
                 std::cout << "  Config file: " << rayshape::tools::utils::FileUtils::JoinPath(args.output_path, "config.json") << std::endl;
             }
+            if (!ov_model->compiled_blob_.empty()) {
+                // 预编译blob与设备/版本绑定,不导出为文件
+                std::cout << "  Precompiled blob: " << ov_model->compiled_blob_.size() << " bytes, "
+                          << ov_model->compiled_device_ << ", OpenVINO " << ov_model->compiled_version_
+                          << std::endl;
+            }
 #else
             PrintError("OpenVINO model support not enabled in this build");
             return 1;
@@ -474,8 +490,9 @@ int ExecuteDeserialize(const CommandLineArgs &args) {
                 return 1;
             }
 
-            // Write ONNX model file
-            std::string onnx_file_path = rayshape::tools::utils::FileUtils::JoinPath(args.output_path, "model.onnx");
+            // Write ONNX model file, offline optimized model is ORT format
+            std::string onnx_file_path = rayshape::tools::utils::FileUtils::JoinPath(
+                args.output_path, onnx_model->optimized_ ? "model.ort" : "model.onnx");
             if (!rayshape::tools::utils::FileUtils::WriteFileContent(onnx_file_path, onnx_model->bin_buf_)) {
                 PrintError("Failed to write ONNX model file: " + onnx_file_path);
                 return 1;
@@ -493,6 +510,10 @@ int ExecuteDeserialize(const CommandLineArgs &args) {
 
             PrintSuccess("ONNX model deserialized successfully:");
             std::cout << "  Model file: " << onnx_file_path << std::endl;
+            if (onnx_model->optimized_) {
+                std::cout << "  Offline optimized: level " << onnx_model->optimized_level_
+                          << ", onnxruntime " << onnx_model->optimized_version_ << std::endl;
+            }
             if (!onnx_model->cfg_str_.empty()) {
                 std::cout << "  Config file: " << rayshape::tools::utils::FileUtils::JoinPath(args.output_path, "config.json") << std::endl;
             }
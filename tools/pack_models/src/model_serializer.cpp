@@ -23,6 +23,14 @@
 #include "model/openvino/openvino_model.h"
 #endif
 
+#ifdef ENABLE_OPENVINO_INFERENCE
+#include "inference/openvino/openvino_precompile.h"
+#endif
+
+#ifdef ENABLE_ONNXRUNTIME_INFERENCE
+#include "inference/onnxruntime/onnxruntime_precompile.h"
+#endif
+
 #ifdef ENABLE_ONNX_MODEL
 #include "model/onnx/onnx_model.h"
 #endif
@@ -72,8 +80,7 @@ namespace rayshape
                 // Serialize model to binary data first
                 std::ostringstream oss(std::ios::binary);
                 ModelCodec model_codec(std::move(model));
-                cereal::BinaryOutputArchive oa(oss);
-                oa(model_codec);
+                ModelCodecSave(oss, model_codec);
 
                                 std::string serialized_data = oss.str();
                 std::vector<uint8_t> model_data(serialized_data.begin(), serialized_data.end());
@@ -189,6 +196,28 @@ namespace rayshape
             try {
                 auto openvino_model = std::make_unique<OpenVINOModel>(xml_content, bin_content);
                 openvino_model->cfg_str_ = config_content;
+                if (precompile_config_.enable) {
+#ifdef ENABLE_OPENVINO_INFERENCE
+                    CustomRuntime runtime;
+                    runtime.device_type_ = precompile_config_.device_type;
+                    runtime.inference_type_ = InferenceType::OPENVINO;
+                    runtime.model_type_ = ModelType::OPENVINO;
+                    runtime.num_thread_ = precompile_config_.num_thread;
+                    ErrorCode ret = inference::openvino::OpenVINOModelPrecompile(
+                        openvino_model.get(), &runtime);
+                    if (ret != RS_SUCCESS) {
+                        SetError("Failed to precompile OpenVINO model, error code: "
+                                 + std::to_string(ret));
+                        return false;
+                    }
+                    std::cout << "Precompiled OpenVINO model for " << openvino_model->compiled_device_
+                              << " (OpenVINO " << openvino_model->compiled_version_ << "), blob size: "
+                              << openvino_model->compiled_blob_.size() << " bytes" << std::endl;
+#else
+                    SetError("OpenVINO inference is not enabled in this build, can not precompile");
+                    return false;
+#endif
+                }
                 return SerializeModelToFile(std::move(openvino_model), output_path, auto_encrypt);
             } catch (const std::exception &e) {
                 SetError("Failed to create OpenVINO model: " + std::string(e.what()));
@@ -238,6 +267,25 @@ namespace rayshape
                 auto onnx_model = std::make_unique<ONNXModel>();
                 onnx_model->bin_buf_ = model_content;
                 onnx_model->cfg_str_ = config_content;
+                if (precompile_config_.enable) {
+#ifdef ENABLE_ONNXRUNTIME_INFERENCE
+                    // onnxruntime把优化结果写到文件,放在输出文件旁边,读回后删除
+                    ErrorCode ret = onnxruntime::ONNXModelPrecompile(
+                        onnx_model.get(), precompile_config_.opt_level, output_path + ".ort.tmp");
+                    if (ret != RS_SUCCESS) {
+                        SetError("Failed to optimize ONNX model offline, error code: "
+                                 + std::to_string(ret));
+                        return false;
+                    }
+                    std::cout << "Optimized ONNX model offline (level " << onnx_model->optimized_level_
+                              << ", onnxruntime " << onnx_model->optimized_version_
+                              << "), ORT format size: " << onnx_model->bin_buf_.size() << " bytes"
+                              << std::endl;
+#else
+                    SetError("ONNXRuntime inference is not enabled in this build, can not precompile");
+                    return false;
+#endif
+                }
                 return SerializeModelToFile(std::move(onnx_model), output_path, auto_encrypt);
             } catch (const std::exception &e) {
                 SetError("Failed to create ONNX model: " + std::string(e.what()));
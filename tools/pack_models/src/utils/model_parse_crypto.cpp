@@ -177,8 +177,7 @@ namespace rayshape
                     std::istringstream iss(std::string(decrypted_data.begin(), decrypted_data.end()), std::ios::binary);
 
                     rayshape::ModelCodec model_codec;
-                    cereal::BinaryInputArchive ia(iss);
-                    ia(model_codec);
+                    rayshape::ModelCodecLoad(iss, model_codec);
 
                     if (model_codec.model_ == nullptr) {
                         SetError("Parsed model is null");
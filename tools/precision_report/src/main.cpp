@@ -0,0 +1,464 @@
+/**
+ * @file main.cpp
+ * @brief Precision report tool main entry point
+ * @details 同一个.rsm模型在多种推理精度下运行相同的输入,以high(fp32)结果为基准,
+ * 输出各精度的时延(平均/P50/P99)与精度损失(最大/平均绝对误差,余弦相似度,argmax一致率),
+ * 用于评估开启bf16/fp16的收益和代价.
+ * @copyright (c) .
+ */
+
+#include "inference/inference.h"
+#include "inference/precision.h"
+#include "model/model_manager.h"
+#include "utils/type_utils.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace rayshape;
+
+/**
+ * @brief Command line arguments
+ */
+struct ReportArgs {
+    std::string model_path;
+    InferenceType inference_type = InferenceType::NONE;
+    DeviceType device_type = DeviceType::CPU;
+    int num_thread = -1;
+    std::vector<Precision> precisions = {Precision::HIGH, Precision::NORMAL, Precision::BF16,
+                                         Precision::FP16};
+    std::vector<std::string> input_files; // raw input data, one file per model input
+    int warmup = 10;
+    int iterations = 100;
+    unsigned int seed = 2025;
+    std::string csv_path;
+};
+
+/**
+ * @brief Result of one precision run
+ */
+struct PrecisionResult {
+    Precision precision = Precision::AUTO;
+    ErrorCode ret = RS_SUCCESS;
+    double mean_ms = 0.0;
+    double p50_ms = 0.0;
+    double p99_ms = 0.0;
+    std::vector<std::vector<double>> outputs;
+
+    double max_abs_err = 0.0;
+    double mean_abs_err = 0.0;
+    double cosine = 1.0;
+    double argmax_match = 1.0;
+};
+
+/**
+ * @brief Print error message
+ */
+void PrintError(const std::string &message) {
+    std::cerr << "[ERROR] " << message << std::endl;
+}
+
+/**
+ * @brief Show help information
+ */
+void ShowHelp() {
+    std::cout << "precision_report - accuracy versus latency report for inference precisions\n\n";
+    std::cout << "USAGE:\n";
+    std::cout << "  precision_report -i <model.rsm> -t <openvino|onnxruntime|mnn> [options]\n\n";
+    std::cout << "OPTIONS:\n";
+    std::cout << "  -i, --input <path>        Serialized model file (.rsm)\n";
+    std::cout << "  -t, --type <type>         Inference type: openvino, onnxruntime, mnn\n";
+    std::cout << "  --device <cpu|gpu>        Device (default: cpu)\n";
+    std::cout << "  --threads <num>           Inference thread num\n";
+    std::cout << "  --precisions <list>       Comma separated: high,normal,low,bf16,fp16\n";
+    std::cout << "                            (default: high,normal,bf16,fp16, high is the reference)\n";
+    std::cout << "  --data <files...>         Raw input data, one file per model input (default: random)\n";
+    std::cout << "  --warmup <num>            Warmup iterations (default: 10)\n";
+    std::cout << "  --iterations <num>        Timed iterations (default: 100)\n";
+    std::cout << "  --seed <num>              Random input seed (default: 2025)\n";
+    std::cout << "  -o, --output <path>       Write report as csv\n";
+    std::cout << "  -h, --help                Show help message\n\n";
+    std::cout << "EXAMPLE:\n";
+    std::cout << "  precision_report -i model.rsm -t openvino --precisions high,bf16 --threads 8\n";
+}
+
+/**
+ * @brief Parse inference type from string
+ */
+InferenceType ParseInferenceType(const std::string &type_str) {
+    if (type_str == "openvino" || type_str == "ov") {
+        return InferenceType::OPENVINO;
+    } else if (type_str == "onnxruntime" || type_str == "ort") {
+        return InferenceType::ONNXRUNTIME;
+    } else if (type_str == "mnn") {
+        return InferenceType::MNN;
+    }
+    return InferenceType::NONE;
+}
+
+/**
+ * @brief Parse command line arguments
+ */
+bool ParseArgs(int argc, char *argv[], ReportArgs &args) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        try {
+            if (arg == "-h" || arg == "--help") {
+                return false;
+            } else if ((arg == "-i" || arg == "--input") && has_value) {
+                args.model_path = argv[++i];
+            } else if ((arg == "-t" || arg == "--type") && has_value) {
+                args.inference_type = ParseInferenceType(argv[++i]);
+            } else if (arg == "--device" && has_value) {
+                std::string device = argv[++i];
+                args.device_type = device == "gpu" ? DeviceType::INTERL_GPU : DeviceType::CPU;
+            } else if (arg == "--threads" && has_value) {
+                args.num_thread = std::stoi(argv[++i]);
+            } else if (arg == "--precisions" && has_value) {
+                args.precisions.clear();
+                std::istringstream iss(argv[++i]);
+                std::string item;
+                while (std::getline(iss, item, ',')) {
+                    Precision precision = Precision::AUTO;
+                    if (inference::ConvertToPrecision(precision, item) != RS_SUCCESS) {
+                        PrintError("Invalid precision: " + item);
+                        return false;
+                    }
+                    args.precisions.push_back(precision);
+                }
+            } else if (arg == "--data") {
+                while (i + 1 < argc && argv[i + 1][0] != '-') {
+                    args.input_files.push_back(argv[++i]);
+                }
+            } else if (arg == "--warmup" && has_value) {
+                args.warmup = std::stoi(argv[++i]);
+            } else if (arg == "--iterations" && has_value) {
+                args.iterations = std::stoi(argv[++i]);
+            } else if (arg == "--seed" && has_value) {
+                args.seed = (unsigned int)std::stoul(argv[++i]);
+            } else if ((arg == "-o" || arg == "--output") && has_value) {
+                args.csv_path = argv[++i];
+            } else {
+                PrintError("Unknown or incomplete option: " + arg);
+                return false;
+            }
+        } catch (const std::exception &) {
+            PrintError("Invalid value for option: " + arg);
+            return false;
+        }
+    }
+
+    if (args.model_path.empty() || args.inference_type == InferenceType::NONE) {
+        PrintError("Model path and inference type are required");
+        return false;
+    }
+    if (args.iterations <= 0 || args.warmup < 0) {
+        PrintError("Iterations must > 0 and warmup must >= 0");
+        return false;
+    }
+    // high(fp32)作为精度基准,总是第一个运行
+    args.precisions.erase(std::remove(args.precisions.begin(), args.precisions.end(),
+                                      Precision::HIGH),
+                          args.precisions.end());
+    args.precisions.insert(args.precisions.begin(), Precision::HIGH);
+    return true;
+}
+
+/**
+ * @brief Get blob byte size
+ */
+size_t BlobBytesGet(const Blob *blob) {
+    size_t count = 1;
+    for (int i = 0; i < blob->dims.size; ++i) {
+        count *= blob->dims.value[i] > 0 ? blob->dims.value[i] : 0;
+    }
+    return count * utils::GetBytesSize(blob->data_type);
+}
+
+/**
+ * @brief Fill input blobs with file data or seeded random data, same for every precision
+ */
+ErrorCode InputsFill(inference::Inference *inference, const ReportArgs &args) {
+    const Blob **blob_arr = nullptr;
+    size_t blob_size = 0;
+    ErrorCode ret = inference->InputBlobsGet(&blob_arr, &blob_size);
+    if (ret != RS_SUCCESS) {
+        return ret;
+    }
+    if (!args.input_files.empty() && args.input_files.size() != blob_size) {
+        PrintError("Model has " + std::to_string(blob_size) + " inputs but "
+                   + std::to_string(args.input_files.size()) + " data files are given");
+        return RS_INVALID_PARAM;
+    }
+
+    std::mt19937 rng(args.seed);
+    for (size_t i = 0; i < blob_size; ++i) {
+        Blob *blob = nullptr;
+        ret = inference->InputBlobGet(blob_arr[i]->name, &blob);
+        if (ret != RS_SUCCESS) {
+            return ret;
+        }
+        size_t bytes = BlobBytesGet(blob);
+        char *data = static_cast<char *>(blob->buffer->GetDataPtr());
+
+        if (!args.input_files.empty()) {
+            std::ifstream ifs(args.input_files[i], std::ios::binary);
+            std::string content((std::istreambuf_iterator<char>(ifs)),
+                                std::istreambuf_iterator<char>());
+            if (content.size() != bytes) {
+                PrintError("Data file " + args.input_files[i] + " size "
+                           + std::to_string(content.size()) + " != input " + blob->name
+                           + " size " + std::to_string(bytes));
+                return RS_INVALID_PARAM;
+            }
+            memcpy(data, content.data(), bytes);
+            continue;
+        }
+
+        size_t count = bytes / std::max(1u, utils::GetBytesSize(blob->data_type));
+        if (blob->data_type == DataType::FLOAT) {
+            std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+            float *ptr = reinterpret_cast<float *>(data);
+            for (size_t k = 0; k < count; ++k) {
+                ptr[k] = dist(rng);
+            }
+        } else {
+            std::uniform_int_distribution<int> dist(0, 255);
+            for (size_t k = 0; k < bytes; ++k) {
+                data[k] = (char)dist(rng);
+            }
+        }
+    }
+    return RS_SUCCESS;
+}
+
+/**
+ * @brief Copy output blobs to double for comparison, non numeric outputs are left empty
+ */
+ErrorCode OutputsCopy(inference::Inference *inference, std::vector<std::vector<double>> &outputs) {
+    const Blob **blob_arr = nullptr;
+    size_t blob_size = 0;
+    ErrorCode ret = inference->OutputBlobsGet(&blob_arr, &blob_size);
+    if (ret != RS_SUCCESS) {
+        return ret;
+    }
+    outputs.assign(blob_size, {});
+    for (size_t i = 0; i < blob_size; ++i) {
+        const Blob *blob = blob_arr[i];
+        size_t type_size = utils::GetBytesSize(blob->data_type);
+        if (type_size == 0) {
+            continue;
+        }
+        size_t count = BlobBytesGet(blob) / type_size;
+        const void *data = blob->buffer->GetDataPtr();
+        std::vector<double> &values = outputs[i];
+        values.resize(count);
+        for (size_t k = 0; k < count; ++k) {
+            switch (blob->data_type) {
+            case DataType::FLOAT:
+                values[k] = static_cast<const float *>(data)[k];
+                break;
+            case DataType::INT32:
+                values[k] = static_cast<const int32_t *>(data)[k];
+                break;
+            case DataType::INT64:
+                values[k] = (double)static_cast<const int64_t *>(data)[k];
+                break;
+            case DataType::UINT8:
+                values[k] = static_cast<const uint8_t *>(data)[k];
+                break;
+            case DataType::INT8:
+                values[k] = static_cast<const int8_t *>(data)[k];
+                break;
+            default:
+                values.clear(); // HALF等类型不参与比较
+                k = count;
+                break;
+            }
+        }
+    }
+    return RS_SUCCESS;
+}
+
+/**
+ * @brief Init inference with precision, run warmup and timed iterations
+ */
+PrecisionResult RunPrecision(const Model *model, const ReportArgs &args, Precision precision) {
+    PrecisionResult result;
+    result.precision = precision;
+
+    std::shared_ptr<inference::Inference> inference = inference::CreateInference(args.inference_type);
+    if (inference == nullptr) {
+        result.ret = RS_INVALID_PARAM;
+        return result;
+    }
+    CustomRuntime runtime;
+    runtime.device_type_ = args.device_type;
+    runtime.inference_type_ = args.inference_type;
+    runtime.model_type_ = model->GetModelType();
+    runtime.num_thread_ = args.num_thread;
+    runtime.precision_ = precision;
+    if ((result.ret = inference->Init(model, &runtime)) != RS_SUCCESS
+        || (result.ret = InputsFill(inference.get(), args)) != RS_SUCCESS) {
+        return result;
+    }
+
+    for (int i = 0; i < args.warmup; ++i) {
+        if ((result.ret = inference->Forward()) != RS_SUCCESS) {
+            return result;
+        }
+    }
+    std::vector<double> latencies;
+    latencies.reserve(args.iterations);
+    for (int i = 0; i < args.iterations; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        if ((result.ret = inference->Forward()) != RS_SUCCESS) {
+            return result;
+        }
+        auto end = std::chrono::steady_clock::now();
+        latencies.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    double sum = 0.0;
+    for (double latency : latencies) {
+        sum += latency;
+    }
+    result.mean_ms = sum / latencies.size();
+    result.p50_ms = latencies[latencies.size() / 2];
+    result.p99_ms = latencies[std::min(latencies.size() - 1, latencies.size() * 99 / 100)];
+
+    result.ret = OutputsCopy(inference.get(), result.outputs);
+    return result;
+}
+
+/**
+ * @brief Compare outputs with the fp32 reference
+ */
+void AccuracyCompare(const PrecisionResult &reference, PrecisionResult &result) {
+    double abs_err_sum = 0.0;
+    size_t count = 0;
+    double dot = 0.0;
+    double ref_norm = 0.0;
+    double norm = 0.0;
+    size_t argmax_total = 0;
+    size_t argmax_match = 0;
+    result.max_abs_err = 0.0;
+
+    for (size_t i = 0; i < reference.outputs.size() && i < result.outputs.size(); ++i) {
+        const std::vector<double> &ref = reference.outputs[i];
+        const std::vector<double> &out = result.outputs[i];
+        if (ref.empty() || ref.size() != out.size()) {
+            continue;
+        }
+        for (size_t k = 0; k < ref.size(); ++k) {
+            double err = std::fabs(ref[k] - out[k]);
+            result.max_abs_err = std::max(result.max_abs_err, err);
+            abs_err_sum += err;
+            dot += ref[k] * out[k];
+            ref_norm += ref[k] * ref[k];
+            norm += out[k] * out[k];
+        }
+        count += ref.size();
+        ++argmax_total;
+        argmax_match += std::max_element(ref.begin(), ref.end()) - ref.begin()
+                                == std::max_element(out.begin(), out.end()) - out.begin()
+                            ? 1
+                            : 0;
+    }
+
+    result.mean_abs_err = count > 0 ? abs_err_sum / count : 0.0;
+    result.cosine = (ref_norm > 0 && norm > 0) ? dot / (std::sqrt(ref_norm) * std::sqrt(norm))
+                                                : 1.0;
+    result.argmax_match = argmax_total > 0 ? (double)argmax_match / argmax_total : 1.0;
+}
+
+/**
+ * @brief Print report table and optionally write csv
+ */
+void ReportWrite(const std::vector<PrecisionResult> &results, const ReportArgs &args) {
+    const PrecisionResult &reference = results.front();
+    std::cout << std::left << std::setw(10) << "precision" << std::right << std::setw(10)
+              << "mean(ms)" << std::setw(10) << "p50(ms)" << std::setw(10) << "p99(ms)"
+              << std::setw(10) << "speedup" << std::setw(14) << "max_abs_err" << std::setw(14)
+              << "mean_abs_err" << std::setw(10) << "cosine" << std::setw(10) << "argmax"
+              << std::endl;
+
+    std::ofstream csv;
+    if (!args.csv_path.empty()) {
+        csv.open(args.csv_path);
+        csv << "precision,status,mean_ms,p50_ms,p99_ms,speedup,max_abs_err,mean_abs_err,cosine,"
+               "argmax_match\n";
+    }
+
+    for (const auto &result : results) {
+        const char *name = inference::PrecisionToString(result.precision);
+        if (result.ret != RS_SUCCESS) {
+            std::cout << std::left << std::setw(10) << name << " failed, error code: "
+                      << result.ret << std::endl;
+            if (csv.is_open()) {
+                csv << name << "," << result.ret << ",,,,,,,,\n";
+            }
+            continue;
+        }
+        double speedup = result.mean_ms > 0 ? reference.mean_ms / result.mean_ms : 0.0;
+        std::cout << std::left << std::setw(10) << name << std::right << std::fixed
+                  << std::setprecision(3) << std::setw(10) << result.mean_ms << std::setw(10)
+                  << result.p50_ms << std::setw(10) << result.p99_ms << std::setw(9)
+                  << std::setprecision(2) << speedup << "x" << std::scientific
+                  << std::setprecision(3) << std::setw(14) << result.max_abs_err << std::setw(14)
+                  << result.mean_abs_err << std::fixed << std::setprecision(5) << std::setw(10)
+                  << result.cosine << std::setprecision(3) << std::setw(10)
+                  << result.argmax_match << std::endl;
+        if (csv.is_open()) {
+            csv << name << ",0," << result.mean_ms << "," << result.p50_ms << ","
+                << result.p99_ms << "," << speedup << "," << result.max_abs_err << ","
+                << result.mean_abs_err << "," << result.cosine << "," << result.argmax_match
+                << "\n";
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    ReportArgs args;
+    if (!ParseArgs(argc, argv, args)) {
+        ShowHelp();
+        return 1;
+    }
+
+    std::unique_ptr<Model> model = LoadModel(args.model_path);
+    if (model == nullptr) {
+        PrintError("Failed to load model: " + args.model_path);
+        return 1;
+    }
+
+    std::vector<PrecisionResult> results;
+    for (Precision precision : args.precisions) {
+        std::cout << "[INFO] Running precision " << inference::PrecisionToString(precision)
+                  << "..." << std::endl;
+        results.push_back(RunPrecision(model.get(), args, precision));
+    }
+    if (results.front().ret != RS_SUCCESS) {
+        PrintError("Reference precision high failed, error code: "
+                   + std::to_string(results.front().ret));
+        return 1;
+    }
+    for (size_t i = 1; i < results.size(); ++i) {
+        if (results[i].ret == RS_SUCCESS) {
+            AccuracyCompare(results.front(), results[i]);
+        }
+    }
+
+    ReportWrite(results, args);
+    return 0;
+}
@@ -0,0 +1,371 @@
+/**
+ * @file main.cpp
+ * @brief Task scheduling benchmark main entry point
+ * @details 若干条任务链并行跑在线程池上,链上每个任务读写本链的buffer后提交下一个任务,
+ * 对比三种提交后继的方式: roundrobin(Commit轮询分配)、local(CommitLocal进当前线程队列)、
+ * continuation(第一个后继在当前线程直接执行,即ParallelTaskEngine的做法).
+ * 后继换核执行时前驱刚写的buffer要跨核取回,Linux下用perf_event统计缓存缺失.
+ * 另外测量小图(菱形4节点)PARALLEL_TYPE_TASK下Graph::Run的端到端时延.
+ * @copyright (c) .
+ */
+
+#include "dag/graph.h"
+#include "thread_pool/thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace rayshape;
+using namespace rayshape::dag;
+using namespace rayshape::threadpool;
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief Command line arguments
+ */
+struct BenchArgs {
+    int threads = 4;  // 线程池线程数
+    int chains = 8;   // 并行的任务链条数
+    int length = 64;  // 每条链的任务数
+    int kb = 256;     // 每条链buffer大小(KB),按L2大小设置
+    int rounds = 20;  // 每种方式运行的轮数
+    int warmup = 2;
+    int iterations = 20000; // 小图时延的运行次数
+};
+
+enum class SubmitMode {
+    ROUND_ROBIN,
+    LOCAL,
+    CONTINUATION,
+};
+
+/**
+ * @brief Result of one submit mode
+ */
+struct BenchResult {
+    double ms_per_round = 0.0;
+    int64_t cache_misses = -1; // < 0 表示不可用
+    int64_t l1d_misses = -1;
+};
+
+/**
+ * @brief 硬件计数器,inherit统计之后创建的线程,线程退出时计入
+ */
+class PerfCounter {
+public:
+    PerfCounter(uint32_t type, uint64_t config) {
+#ifdef __linux__
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd_ = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+
+    ~PerfCounter() {
+#ifdef __linux__
+        if (fd_ >= 0) {
+            close(fd_);
+        }
+#endif
+    }
+
+    void Start() {
+#ifdef __linux__
+        if (fd_ >= 0) {
+            ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    int64_t Stop() {
+#ifdef __linux__
+        if (fd_ >= 0) {
+            ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+            int64_t value = 0;
+            if (read(fd_, &value, sizeof(value)) == sizeof(value)) {
+                return value;
+            }
+        }
+#endif
+        return -1;
+    }
+
+private:
+    int fd_ = -1;
+};
+
+/**
+ * @brief 一轮运行: chains条链各length个任务,全部完成后唤醒等待方
+ */
+class ChainRun {
+public:
+    ChainRun(ThreadPool *pool, const BenchArgs &args, SubmitMode mode) :
+        pool_(pool), length_(args.length), mode_(mode) {
+        size_t count = static_cast<size_t>(args.kb) * 1024 / sizeof(float);
+        buffers_.resize(args.chains);
+        for (auto &buffer : buffers_) {
+            buffer.assign(count, 1.0f);
+        }
+    }
+
+    void Run() {
+        remaining_ = static_cast<int>(buffers_.size());
+        for (int chain = 0; chain < static_cast<int>(buffers_.size()); ++chain) {
+            // 首个任务从外部线程提交,几种方式都是轮询分配
+            pool_->Commit([this, chain] { Execute(chain, 0); });
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        cond_.wait(lock, [this] { return remaining_ == 0; });
+    }
+
+private:
+    void Execute(int chain, int step) {
+        while (step < length_) {
+            // 读前驱写的整块buffer再写回,后继换核时这些数据要跨核取回
+            std::vector<float> &buffer = buffers_[chain];
+            for (auto &value : buffer) {
+                value = value * 0.5f + static_cast<float>(step);
+            }
+            ++step;
+            if (step == length_) {
+                break;
+            }
+            if (mode_ == SubmitMode::CONTINUATION) {
+                continue;
+            }
+            if (mode_ == SubmitMode::LOCAL) {
+                pool_->CommitLocal([this, chain, step] { Execute(chain, step); });
+            } else {
+                pool_->Commit([this, chain, step] { Execute(chain, step); });
+            }
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--remaining_ == 0) {
+            cond_.notify_all();
+        }
+    }
+
+    ThreadPool *pool_;
+    int length_;
+    SubmitMode mode_;
+    std::vector<std::vector<float>> buffers_;
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    int remaining_ = 0;
+};
+
+BenchResult RunMode(const BenchArgs &args, SubmitMode mode) {
+    // 计数器先于线程池创建,工作线程才会被统计
+    PerfCounter cache_misses(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    PerfCounter l1d_misses(PERF_TYPE_HW_CACHE,
+                           PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                               | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+    ThreadPool pool(args.threads);
+    pool.Init();
+    ChainRun run(&pool, args, mode);
+    for (int i = 0; i < args.warmup; ++i) {
+        run.Run();
+    }
+
+    cache_misses.Start();
+    l1d_misses.Start();
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < args.rounds; ++i) {
+        run.Run();
+    }
+    double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    // 工作线程退出后继承的计数才会累加
+    pool.DeInit();
+
+    BenchResult result;
+    result.ms_per_round = ms / args.rounds;
+    result.cache_misses = cache_misses.Stop();
+    result.l1d_misses = l1d_misses.Stop();
+    return result;
+}
+
+/**
+ * @brief 空节点,只测调度开销
+ */
+class EmptyNode: public Node {
+public:
+    EmptyNode(const std::string &name, std::vector<Edge *> inputs, std::vector<Edge *> outputs) :
+        Node(name, inputs, outputs) {}
+    ErrorCode Run() override {
+        return RS_SUCCESS;
+    }
+};
+
+/**
+ * @brief 小图端到端时延: in -> src -> (left, right) -> sink -> out
+ * @param[out] p50_us p50时延
+ * @param[out] p99_us p99时延
+ */
+bool RunGraphLatency(const BenchArgs &args, double *p50_us, double *p99_us) {
+    Edge input("input");
+    Edge output("output");
+    Graph graph("diamond", {&input}, {&output});
+    Edge *src_left = graph.CreateEdge("src_left");
+    Edge *src_right = graph.CreateEdge("src_right");
+    Edge *left_sink = graph.CreateEdge("left_sink");
+    Edge *right_sink = graph.CreateEdge("right_sink");
+    graph.CreateNode<EmptyNode>("src", std::vector<Edge *>{&input},
+                                std::vector<Edge *>{src_left, src_right});
+    graph.CreateNode<EmptyNode>("left", src_left, left_sink);
+    graph.CreateNode<EmptyNode>("right", src_right, right_sink);
+    graph.CreateNode<EmptyNode>("sink", std::vector<Edge *>{left_sink, right_sink},
+                                std::vector<Edge *>{&output});
+    graph.SetParallelType(PARALLEL_TYPE_TASK);
+    if (graph.Init() != RS_SUCCESS) {
+        return false;
+    }
+
+    std::vector<double> latencies;
+    for (int i = 0; i < args.iterations; ++i) {
+        Clock::time_point start = Clock::now();
+        if (graph.Run() != RS_SUCCESS) {
+            return false;
+        }
+        latencies.push_back(
+            std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+    }
+    std::sort(latencies.begin(), latencies.end());
+    *p50_us = latencies[latencies.size() / 2];
+    *p99_us = latencies[std::min(latencies.size() - 1, latencies.size() * 99 / 100)];
+    graph.Deinit();
+    return true;
+}
+
+std::string CounterText(int64_t value, int rounds) {
+    return value < 0 ? std::string("n/a") : std::to_string(value / rounds);
+}
+
+/**
+ * @brief Print error message
+ */
+void PrintError(const std::string &message) {
+    std::cerr << "[ERROR] " << message << std::endl;
+}
+
+/**
+ * @brief Show help information
+ */
+void ShowHelp() {
+    std::cout << "task_bench - round-robin vs local successor submission on the thread pool\n\n";
+    std::cout << "USAGE:\n";
+    std::cout << "  task_bench [options]\n\n";
+    std::cout << "OPTIONS:\n";
+    std::cout << "  --threads <num>           Thread pool size (default: 4)\n";
+    std::cout << "  --chains <num>            Task chains running in parallel (default: 8)\n";
+    std::cout << "  --length <num>            Tasks per chain (default: 64)\n";
+    std::cout << "  --kb <num>                Buffer size per chain in KB (default: 256)\n";
+    std::cout << "  --rounds <num>            Measured rounds per mode (default: 20)\n";
+    std::cout << "  --warmup <num>            Rounds not counted (default: 2)\n";
+    std::cout << "  --iterations <num>        Small graph Run latency samples (default: 20000)\n";
+    std::cout << "  -h, --help                Show this help\n";
+}
+
+/**
+ * @brief Parse command line arguments
+ */
+bool ParseArgs(int argc, char *argv[], BenchArgs &args) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        try {
+            if (arg == "-h" || arg == "--help") {
+                return false;
+            } else if (arg == "--threads" && has_value) {
+                args.threads = std::stoi(argv[++i]);
+            } else if (arg == "--chains" && has_value) {
+                args.chains = std::stoi(argv[++i]);
+            } else if (arg == "--length" && has_value) {
+                args.length = std::stoi(argv[++i]);
+            } else if (arg == "--kb" && has_value) {
+                args.kb = std::stoi(argv[++i]);
+            } else if (arg == "--rounds" && has_value) {
+                args.rounds = std::stoi(argv[++i]);
+            } else if (arg == "--warmup" && has_value) {
+                args.warmup = std::stoi(argv[++i]);
+            } else if (arg == "--iterations" && has_value) {
+                args.iterations = std::stoi(argv[++i]);
+            } else {
+                PrintError("Unknown or incomplete argument: " + arg);
+                return false;
+            }
+        } catch (const std::exception &e) {
+            PrintError("Invalid value for " + arg + ": " + e.what());
+            return false;
+        }
+    }
+    if (args.threads <= 0 || args.chains <= 0 || args.length <= 0 || args.kb <= 0
+        || args.rounds <= 0 || args.warmup < 0 || args.iterations <= 0) {
+        PrintError("threads, chains, length, kb, rounds and iterations must be > 0");
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    BenchArgs args;
+    if (!ParseArgs(argc, argv, args)) {
+        ShowHelp();
+        return 1;
+    }
+
+    std::cout << "[INFO] threads: " << args.threads << ", chains: " << args.chains
+              << ", length: " << args.length << ", buffer: " << args.kb << "KB"
+              << ", hardware threads: " << std::thread::hardware_concurrency() << std::endl;
+
+    const std::vector<std::pair<std::string, SubmitMode>> modes = {
+        {"roundrobin", SubmitMode::ROUND_ROBIN},
+        {"local", SubmitMode::LOCAL},
+        {"continuation", SubmitMode::CONTINUATION},
+    };
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << std::left << std::setw(14) << "mode" << std::setw(16) << "ms/round"
+              << std::setw(20) << "cache-misses/round" << std::setw(20) << "L1D-misses/round"
+              << std::endl;
+    for (const auto &mode : modes) {
+        BenchResult result = RunMode(args, mode.second);
+        std::cout << std::left << std::setw(14) << mode.first << std::setw(16)
+                  << result.ms_per_round << std::setw(20)
+                  << CounterText(result.cache_misses, args.rounds) << std::setw(20)
+                  << CounterText(result.l1d_misses, args.rounds) << std::endl;
+    }
+
+    double p50_us = 0.0;
+    double p99_us = 0.0;
+    if (!RunGraphLatency(args, &p50_us, &p99_us)) {
+        PrintError("small graph run failed");
+        return 1;
+    }
+    std::cout << "graph Run latency(us): p50 " << p50_us << ", p99 " << p99_us << std::endl;
+    return 0;
+}